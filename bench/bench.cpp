@@ -0,0 +1,536 @@
+/**
+ * @file bench.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Benchmarks every line and circle variant over randomized workloads
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Usage: RendererBench [--csv path] [--json path] [--filter text] [--count n] [--time seconds] [--layout name]
+ *
+ * Every variant runs over every workload of its kind. A workload is a fixed,
+ * seeded set of primitives, so results are comparable between runs and
+ * releases. Each measurement repeats the whole workload until the time budget
+ * is used up and keeps the fastest pass.
+ *
+ * Pixels are the distinct pixels a primitive covers inside the pixmap, found
+ * by drawing a sample of the workload one primitive at a time. Pixels that an
+ * algorithm writes several times, or that are clipped away, are not counted.
+ *
+ * `--layout` draws into a pixmap with another pixel order (linear, tiled8,
+ * tiled16, morton8 or morton16). Comparing runs shows how much the tiles save
+ * on the steep lines and circles, which step through a new row per pixel.
+ */
+
+#include <renderer.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define BENCH_HAS_TSC 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define BENCH_HAS_TSC 1
+#else
+    #define BENCH_HAS_TSC 0
+#endif
+
+enum
+{
+    BENCH_WIDTH = 1920,
+    BENCH_HEIGHT = 1080,
+    BENCH_COUNT = 4096,  // Primitives per workload
+    BENCH_SAMPLES = 128, // Primitives drawn one by one to count their pixels
+};
+
+#pragma region Workloads
+typedef enum PrimitiveKind
+{
+    KIND_LINE,
+    KIND_CIRCLE,
+} PrimitiveKind;
+
+/**
+ * @brief A line from (a, b) to (c, d), or a circle around (a, b) with radius c
+ *
+ */
+typedef struct Primitive
+{
+    int32_t a, b, c, d;
+} Primitive;
+
+typedef struct Workload
+{
+    const char *name;
+    PrimitiveKind kind;
+    Primitive *primitives;
+    size_t count;
+    int32_t *columns[4]; // a, b, c and d of every primitive as separate arrays, for the batched variants
+} Workload;
+
+/**
+ * @brief xorshift64*, seeded per workload so every run draws the same primitives
+ *
+ */
+static uint64_t random_next(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+static int32_t random_range(uint64_t *state, int32_t lo, int32_t hi)
+{
+    return lo + (int32_t)(random_next(state) % (uint64_t)(hi - lo + 1));
+}
+
+/**
+ * @brief Returns an offset of the given length in a random direction
+ *
+ */
+static void random_offset(uint64_t *state, int32_t length, int32_t *dx, int32_t *dy)
+{
+    double angle = (double)(random_next(state) >> 11) / (double)(1ull << 53) * 2.0 * M_PI;
+    *dx = (int32_t)lround(cos(angle) * length);
+    *dy = (int32_t)lround(sin(angle) * length);
+}
+
+typedef enum WorkloadShape
+{
+    SHAPE_SHORT,   // Lines up to 16 pixels or radii up to 8 pixels, on screen
+    SHAPE_LONG,    // Lines of 200 to 2000 pixels or radii of 50 to 400 pixels, on screen
+    SHAPE_CLIPPED, // Long lines or large circles that mostly lie outside the pixmap
+    SHAPE_STEEP,   // Long lines within 15 degrees of the vertical, on screen
+} WorkloadShape;
+
+static Workload workload_create(const char *name, PrimitiveKind kind, WorkloadShape shape, size_t count, uint64_t seed)
+{
+    Workload workload = {name, kind, (Primitive *)malloc(count * sizeof(Primitive)), count, {NULL, NULL, NULL, NULL}};
+    int32_t *columns = (int32_t *)malloc(4 * count * sizeof(int32_t));
+    if (workload.primitives == NULL || columns == NULL)
+    {
+        free(columns);
+        workload.count = 0;
+        return workload;
+    }
+    for (size_t k = 0; k < 4; k++)
+        workload.columns[k] = columns + k * count;
+
+    uint64_t state = seed;
+    for (size_t i = 0; i < count; i++)
+    {
+        Primitive *p = &workload.primitives[i];
+        int32_t x = random_range(&state, 0, BENCH_WIDTH - 1);
+        int32_t y = random_range(&state, 0, BENCH_HEIGHT - 1);
+        if (shape == SHAPE_CLIPPED)
+        {
+            // Move the anchor up to a screen size beyond one of the edges
+            int32_t side = random_range(&state, 0, 3);
+            if (side == 0)
+                x = -random_range(&state, 1, BENCH_WIDTH);
+            else if (side == 1)
+                x = BENCH_WIDTH + random_range(&state, 0, BENCH_WIDTH);
+            else if (side == 2)
+                y = -random_range(&state, 1, BENCH_HEIGHT);
+            else
+                y = BENCH_HEIGHT + random_range(&state, 0, BENCH_HEIGHT);
+        }
+
+        if (kind == KIND_LINE)
+        {
+            int32_t length = shape == SHAPE_SHORT ? random_range(&state, 1, 16) : random_range(&state, 200, 2000);
+            int32_t dx, dy;
+            random_offset(&state, length, &dx, &dy);
+            if (shape == SHAPE_STEEP)
+            {
+                // Rotate the direction into the vertical quarter, within tan(15) = 0.268 of dy
+                int32_t dv = random_range(&state, 200, BENCH_HEIGHT - 1);
+                dx = (int32_t)((double)dv * 0.268 * ((double)(random_next(&state) >> 11) / (double)(1ull << 52) - 1.0));
+                dy = random_next(&state) & 1 ? dv : -dv;
+            }
+            if (shape != SHAPE_CLIPPED)
+            {
+                // Keep the whole line on screen by reflecting the end point
+                if (x + dx < 0 || x + dx >= BENCH_WIDTH)
+                    dx = -dx;
+                if (y + dy < 0 || y + dy >= BENCH_HEIGHT)
+                    dy = -dy;
+                if (x + dx < 0 || x + dx >= BENCH_WIDTH)
+                    dx = (BENCH_WIDTH - 1) / 2 - x;
+                if (y + dy < 0 || y + dy >= BENCH_HEIGHT)
+                    dy = (BENCH_HEIGHT - 1) / 2 - y;
+            }
+            *p = Primitive{x, y, x + dx, y + dy};
+        }
+        else
+        {
+            int32_t r = shape == SHAPE_SHORT ? random_range(&state, 1, 8) : random_range(&state, 50, 400);
+            if (shape != SHAPE_CLIPPED)
+            {
+                // Keep the whole circle on screen
+                int32_t limit = BENCH_HEIGHT / 2 - 1;
+                r = r < limit ? r : limit;
+                x = x < r ? r : (x >= BENCH_WIDTH - r ? BENCH_WIDTH - 1 - r : x);
+                y = y < r ? r : (y >= BENCH_HEIGHT - r ? BENCH_HEIGHT - 1 - r : y);
+            }
+            *p = Primitive{x, y, r, 0};
+        }
+        workload.columns[0][i] = p->a;
+        workload.columns[1][i] = p->b;
+        workload.columns[2][i] = p->c;
+        workload.columns[3][i] = p->d;
+    }
+    return workload;
+}
+#pragma endregion Workloads
+
+#pragma region Variants
+typedef void (*LineFn)(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+typedef void (*CircleFn)(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
+typedef void (*BatchFn)(Pixmap *pixmap, const Workload *workload, uint32_t color);
+
+static void draw_line_thick4(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    draw_line(pixmap, x0, y0, x1, y1, 4, color);
+}
+
+static void fill_circle_aa4(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    fill_circle_aa(pixmap, cx, cy, r, AA_SAMPLES_4, color);
+}
+
+static void fill_circle_aa16(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    fill_circle_aa(pixmap, cx, cy, r, AA_SAMPLES_16, color);
+}
+
+static void draw_lines_batch(Pixmap *pixmap, const Workload *workload, uint32_t color)
+{
+    draw_lines(pixmap, workload->columns[0], workload->columns[1], workload->columns[2], workload->columns[3],
+               workload->count, color);
+}
+
+typedef struct Variant
+{
+    const char *name;
+    PrimitiveKind kind;
+    LineFn line;
+    CircleFn circle;
+    BatchFn batch; // Draws the whole workload in one call if set, `line` or `circle` then only count pixels
+} Variant;
+
+static const Variant variants[] = {
+    {"line_equation", KIND_LINE, draw_line_equation, NULL, NULL},
+    {"line_incremental", KIND_LINE, draw_line_incremental, NULL, NULL},
+    {"line_dda", KIND_LINE, draw_line_dda, NULL, NULL},
+    {"line_midpoint", KIND_LINE, draw_line_midpoint, NULL, NULL},
+    {"line_bresenham", KIND_LINE, draw_line_bresenham, NULL, NULL},
+    {"line_batch", KIND_LINE, draw_line_bresenham, NULL, draw_lines_batch},
+    {"line_xiaolin", KIND_LINE, draw_line_xiaolin, NULL, NULL},
+    {"line_thick4", KIND_LINE, draw_line_thick4, NULL, NULL},
+    {"circle_equation1", KIND_CIRCLE, NULL, draw_circle_equation1, NULL},
+    {"circle_equation2", KIND_CIRCLE, NULL, draw_circle_equation2, NULL},
+    {"circle_equation3", KIND_CIRCLE, NULL, draw_circle_equation3, NULL},
+    {"circle_midpoint", KIND_CIRCLE, NULL, draw_circle_midpoint, NULL},
+    {"circle_bresenham", KIND_CIRCLE, NULL, draw_circle_bresenham, NULL},
+    {"circle_fill", KIND_CIRCLE, NULL, fill_circle, NULL},
+    {"circle_fill_aa4", KIND_CIRCLE, NULL, fill_circle_aa4, NULL},
+    {"circle_fill_aa16", KIND_CIRCLE, NULL, fill_circle_aa16, NULL},
+};
+
+static void variant_draw(const Variant *variant, Pixmap *pixmap, const Primitive *p, uint32_t color)
+{
+    if (variant->kind == KIND_LINE)
+        variant->line(pixmap, p->a, p->b, p->c, p->d, color);
+    else
+        variant->circle(pixmap, p->a, p->b, p->c, color);
+}
+
+/**
+ * @brief Returns the bounding box of a primitive, clipped to the pixmap
+ *
+ * Anti-aliased and thick lines reach a few pixels past their end points.
+ */
+static Rect primitive_bounds(const Pixmap *pixmap, PrimitiveKind kind, const Primitive *p)
+{
+    int64_t x0, y0, x1, y1;
+    if (kind == KIND_LINE)
+    {
+        x0 = (p->a < p->c ? p->a : p->c) - 4;
+        x1 = (p->a < p->c ? p->c : p->a) + 5;
+        y0 = (p->b < p->d ? p->b : p->d) - 4;
+        y1 = (p->b < p->d ? p->d : p->b) + 5;
+    }
+    else
+    {
+        x0 = (int64_t)p->a - p->c - 1;
+        x1 = (int64_t)p->a + p->c + 2;
+        y0 = (int64_t)p->b - p->c - 1;
+        y1 = (int64_t)p->b + p->c + 2;
+    }
+    Rect rect;
+    rect.x0 = (int32_t)(x0 < 0 ? 0 : (x0 > pixmap->width ? pixmap->width : x0));
+    rect.y0 = (int32_t)(y0 < 0 ? 0 : (y0 > pixmap->height ? pixmap->height : y0));
+    rect.x1 = (int32_t)(x1 < rect.x0 ? rect.x0 : (x1 > pixmap->width ? pixmap->width : x1));
+    rect.y1 = (int32_t)(y1 < rect.y0 ? rect.y0 : (y1 > pixmap->height ? pixmap->height : y1));
+    return rect;
+}
+
+/**
+ * @brief Returns the average number of pixels a variant covers per primitive
+ *
+ * The sample primitives are drawn one at a time into a cleared pixmap. The
+ * covered pixels inside the bounding box are counted and cleared again, so
+ * the cost follows the size of the primitives rather than of the pixmap.
+ */
+static double variant_pixels(const Variant *variant, Pixmap *pixmap, const Workload *workload)
+{
+    size_t samples = workload->count < (size_t)BENCH_SAMPLES ? workload->count : (size_t)BENCH_SAMPLES;
+    if (samples == 0)
+        return 0.0;
+
+    pixmap_clear(pixmap, 0);
+    uint64_t pixels = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        const Primitive *p = &workload->primitives[i];
+        variant_draw(variant, pixmap, p, WHITE);
+
+        Rect bounds = primitive_bounds(pixmap, variant->kind, p);
+        for (int32_t y = bounds.y0; y < bounds.y1; y++)
+            for (int32_t x = bounds.x0; x < bounds.x1; x++)
+                pixels += pixmap_get_pixel(pixmap, x, y) != 0;
+        fill_rect(pixmap, bounds.x0, bounds.y0, bounds.x1 - bounds.x0, bounds.y1 - bounds.y0, 0);
+    }
+    return (double)pixels / (double)samples;
+}
+#pragma endregion Variants
+
+#pragma region Measurement
+typedef struct Result
+{
+    const char *variant;
+    const char *workload;
+    size_t primitives;
+    double pixels;            // Average pixels covered per primitive
+    double ns_per_primitive;  // Fastest pass
+    double mpixels_per_s;     // Covered pixels per second, in millions
+    double cycles_per_pixel;  // Time stamp counter cycles, 0 where it is not available
+} Result;
+
+static uint64_t cycles_now(void)
+{
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static Result measure(const Variant *variant, Pixmap *pixmap, const Workload *workload, double seconds)
+{
+    Result result = {};
+    result.variant = variant->name;
+    result.workload = workload->name;
+    result.primitives = workload->count;
+    result.pixels = variant_pixels(variant, pixmap, workload);
+
+    pixmap_clear(pixmap, BLACK);
+    double best_ns = 0.0;
+    uint64_t best_cycles = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0;; pass++)
+    {
+        // Alternate two colors so that no pass writes pixels that already hold the color
+        uint32_t color = pass & 1 ? RED : BLUE;
+        uint64_t start_cycles = cycles_now();
+        auto start = std::chrono::steady_clock::now();
+        if (variant->batch != NULL)
+            variant->batch(pixmap, workload, color);
+        else
+            for (size_t i = 0; i < workload->count; i++)
+                variant_draw(variant, pixmap, &workload->primitives[i], color);
+        auto end = std::chrono::steady_clock::now();
+        uint64_t cycles = cycles_now() - start_cycles;
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (pass == 0 || ns < best_ns)
+        {
+            best_ns = ns;
+            best_cycles = cycles;
+        }
+        if (pass >= 2 && std::chrono::duration<double>(end - begin).count() >= seconds)
+            break;
+    }
+
+    double pixels = result.pixels * (double)workload->count;
+    result.ns_per_primitive = workload->count > 0 ? best_ns / (double)workload->count : 0.0;
+    result.mpixels_per_s = best_ns > 0.0 ? pixels / best_ns * 1e3 : 0.0;
+    result.cycles_per_pixel = pixels > 0.0 ? (double)best_cycles / pixels : 0.0;
+    return result;
+}
+#pragma endregion Measurement
+
+#pragma region Reports
+static bool write_csv(const char *path, const Result *results, size_t count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+    fprintf(file, "variant,workload,primitives,pixels_per_primitive,ns_per_primitive,mpixels_per_s,cycles_per_pixel\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        const Result *r = &results[i];
+        fprintf(file, "%s,%s,%zu,%.2f,%.2f,%.2f,%.3f\n", r->variant, r->workload, r->primitives, r->pixels,
+                r->ns_per_primitive, r->mpixels_per_s, r->cycles_per_pixel);
+    }
+    return fclose(file) == 0;
+}
+
+static bool write_json(const char *path, const char *layout, const Result *results, size_t count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+    fprintf(file, "{\n  \"width\": %d,\n  \"height\": %d,\n  \"layout\": \"%s\",\n  \"results\": [\n", BENCH_WIDTH,
+            BENCH_HEIGHT, layout);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Result *r = &results[i];
+        fprintf(file,
+                "    {\"variant\": \"%s\", \"workload\": \"%s\", \"primitives\": %zu, \"pixels_per_primitive\": %.2f, "
+                "\"ns_per_primitive\": %.2f, \"mpixels_per_s\": %.2f, \"cycles_per_pixel\": %.3f}%s\n",
+                r->variant, r->workload, r->primitives, r->pixels, r->ns_per_primitive, r->mpixels_per_s,
+                r->cycles_per_pixel, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+#pragma endregion Reports
+
+typedef struct LayoutName
+{
+    const char *name;
+    PixmapLayout layout;
+} LayoutName;
+
+static const LayoutName layouts[] = {
+    {"linear", LAYOUT_LINEAR},
+    {"tiled8", LAYOUT_TILED8},
+    {"tiled16", LAYOUT_TILED16},
+    {"morton8", LAYOUT_MORTON8},
+    {"morton16", LAYOUT_MORTON16},
+};
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--csv path] [--json path] [--filter text] [--count n] [--time seconds] [--layout name]\n",
+            program);
+}
+
+int main(int argc, char **argv)
+{
+    const char *csv = NULL;
+    const char *json = NULL;
+    const char *filter = NULL;
+    size_t count = BENCH_COUNT;
+    double seconds = 0.25;
+    const LayoutName *layout = &layouts[0];
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--csv") == 0 && has_value)
+            csv = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && has_value)
+            json = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && has_value)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && has_value)
+            count = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--time") == 0 && has_value)
+            seconds = strtod(argv[++i], NULL);
+        else if (strcmp(argv[i], "--layout") == 0 && has_value)
+        {
+            const char *name = argv[++i];
+            layout = NULL;
+            for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]) && layout == NULL; l++)
+                if (strcmp(layouts[l].name, name) == 0)
+                    layout = &layouts[l];
+            if (layout == NULL)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Pixmap *pixmap = pixmap_create_layout(BENCH_WIDTH, BENCH_HEIGHT, layout->layout);
+    if (pixmap == NULL)
+        return 1;
+
+    Workload workloads[] = {
+        workload_create("lines_short", KIND_LINE, SHAPE_SHORT, count, 1),
+        workload_create("lines_long", KIND_LINE, SHAPE_LONG, count, 2),
+        workload_create("lines_clipped", KIND_LINE, SHAPE_CLIPPED, count, 3),
+        workload_create("lines_steep", KIND_LINE, SHAPE_STEEP, count, 7),
+        workload_create("circles_small", KIND_CIRCLE, SHAPE_SHORT, count, 4),
+        workload_create("circles_large", KIND_CIRCLE, SHAPE_LONG, count, 5),
+        workload_create("circles_clipped", KIND_CIRCLE, SHAPE_CLIPPED, count, 6),
+    };
+    const size_t workload_count = sizeof(workloads) / sizeof(workloads[0]);
+    const size_t variant_count = sizeof(variants) / sizeof(variants[0]);
+
+    Result *results = (Result *)malloc(variant_count * workload_count * sizeof(Result));
+    if (results == NULL)
+        return 1;
+    size_t result_count = 0;
+
+    printf("layout %s\n", layout->name);
+    printf("%-18s %-16s %12s %12s %12s %12s\n", "variant", "workload", "px/prim", "ns/prim", "Mpx/s", "cycles/px");
+    for (size_t v = 0; v < variant_count; v++)
+    {
+        if (filter != NULL && strstr(variants[v].name, filter) == NULL)
+            continue;
+        for (size_t w = 0; w < workload_count; w++)
+        {
+            if (workloads[w].kind != variants[v].kind)
+                continue;
+            Result r = measure(&variants[v], pixmap, &workloads[w], seconds);
+            results[result_count++] = r;
+            printf("%-18s %-16s %12.1f %12.1f %12.1f %12.2f\n", r.variant, r.workload, r.pixels, r.ns_per_primitive,
+                   r.mpixels_per_s, r.cycles_per_pixel);
+            fflush(stdout);
+        }
+    }
+
+    int status = 0;
+    if (csv != NULL && !write_csv(csv, results, result_count))
+    {
+        fprintf(stderr, "could not write %s\n", csv);
+        status = 1;
+    }
+    if (json != NULL && !write_json(json, layout->name, results, result_count))
+    {
+        fprintf(stderr, "could not write %s\n", json);
+        status = 1;
+    }
+
+    for (size_t w = 0; w < workload_count; w++)
+    {
+        free(workloads[w].primitives);
+        free(workloads[w].columns[0]);
+    }
+    free(results);
+    pixmap_destroy(pixmap);
+    return status;
+}
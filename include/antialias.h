@@ -0,0 +1,75 @@
+/**
+ * @file antialias.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Anti-aliased fills resolved from per-pixel sample coverage
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+#include "polygon.h"
+
+/**
+ * @brief Samples taken per pixel by the anti-aliased fills
+ *
+ * The samples follow the standard 4x, 8x and 16x MSAA patterns: every sample
+ * lies on a row and a column of its own inside the pixel, so edges of any
+ * direction get as many coverage levels as there are samples.
+ */
+typedef enum AASamples
+{
+    AA_SAMPLES_4 = 4,
+    AA_SAMPLES_8 = 8,
+    AA_SAMPLES_16 = 16,
+} AASamples;
+
+/**
+ * @brief Vertices of anti-aliased fills are clamped to +-AA_COORD_MAX
+ *
+ */
+enum
+{
+    AA_COORD_MAX = 1 << 26,
+};
+
+/**
+ * @brief Fills a polygon with anti-aliased edges
+ *
+ * Covers the same shape as `fill_polygon`, a pixel center on the outline
+ * being half covered, so the filled area equals the polygon's area. Every
+ * sample row of the pixel is scan converted like a scanline of `fill_polygon`,
+ * and each span only records where the coverage changes, so the work per row
+ * follows the number of edges instead of the width times the samples, and the
+ * memory is one counter per column of the bounding box for any sample count.
+ * Pixels covered by every sample are written as plain spans, the partly
+ * covered ones are blended with their coverage like `blend_point`.
+ *
+ * @param pixmap Target pixmap
+ * @param points Vertices in drawing order, the polygon is closed implicitly
+ * @param count Number of vertices, fewer than three fill nothing
+ * @param rule Fill rule for overlapping regions
+ * @param samples Samples per pixel
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_polygon_aa(Pixmap *pixmap, const Point *points, size_t count, FillRule rule, AASamples samples, uint32_t color);
+
+/**
+ * @brief Fills a disc with anti-aliased edges
+ *
+ * The disc has a radius of r + 1/2 pixels around the center of pixel
+ * (cx, cy), which matches the area of `fill_circle`. Rows are resolved as in
+ * `fill_polygon_aa`.
+ *
+ * @param pixmap Target pixmap
+ * @param cx x-coordinate of the center
+ * @param cy y-coordinate of the center
+ * @param r Radius of the disc
+ * @param samples Samples per pixel
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_circle_aa(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, AASamples samples, uint32_t color);
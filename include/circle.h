@@ -6,8 +6,13 @@
  * @date 2025-05-04
  * 
  */
+#pragma once
+
+#include <stddef.h>
 #include <stdint.h>
 
+#include "pixmap.h"
+
 /**
  * @brief Draws a circle using the naive parametric equation method
  *
@@ -16,12 +21,13 @@
  *
  * @note This method is computationally expensive due to trigonometric and float operations.
  *
+ * @param pixmap Target pixmap
  * @param cx x-coordinate of the center
  * @param cy y-coordinate of the center
  * @param r Radius of the circle
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_circle_equation1(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle_equation1(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
 /**
  * @brief Draws a full circle by symmetry from 1/8th parametric arc
@@ -35,12 +41,13 @@ void draw_circle_equation1(int32_t cx, int32_t cy, int32_t r, uint32_t color);
  * The function expects the radius as a float for consistency with other functions,
  * but internally it is cast to integer for optimized computation.
  *
+ * @param pixmap Target pixmap
  * @param cx x-coordinate of the center
  * @param cy y-coordinate of the center
  * @param r Radius of the circle
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_circle_equation2(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle_equation2(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
 /**
  * @brief Draws a circle using the Pythagorean theorem (x² + y² = r²)
@@ -54,15 +61,16 @@ void draw_circle_equation2(int32_t cx, int32_t cy, int32_t r, uint32_t color);
  * The function expects the radius as a float for consistency with other functions,
  * but internally it is cast to integer for optimized computation.
  *
+ * @param pixmap Target pixmap
  * @param cx x-coordinate of the center
  * @param cy y-coordinate of the center
  * @param r Radius of the circle
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_circle_equation3(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle_equation3(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
 // TODO: Add description
-void draw_circle_midpoint(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle_midpoint(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
 /**
  * @brief Draws a circle using Bresenham's midpoint circle algorithm.
@@ -77,6 +85,7 @@ void draw_circle_midpoint(int32_t cx, int32_t cy, int32_t r, uint32_t color);
  * Performance-wise, this algorithm is significantly faster than naive trigonometric
  * or parametric approaches, making it ideal for low-level pixel manipulation.
  *
+ * @param pixmap Target pixmap
  * @param cx x-coordinate of the circle center
  * @param cy Y-coordinate of the circle center
  * @param r Radius of the circle
@@ -86,10 +95,38 @@ void draw_circle_midpoint(int32_t cx, int32_t cy, int32_t r, uint32_t color);
  * The function expects the radius as a float for consistency with other functions,
  * but internally it is cast to integer for optimized computation.
  */
-void draw_circle_bresenham(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle_bresenham(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
 // TODO: Add description
-void draw_circle(int32_t cx, int32_t cy, int32_t r, uint32_t color);
+void draw_circle(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
 
-// TODO: Add description
-void fill_circle(int32_t cx, int32_t cy, int32_t r, uint32_t color);
\ No newline at end of file
+/**
+ * @brief Fills a disc with horizontal spans
+ *
+ * Every covered pixel is written exactly once: each row of the disc becomes
+ * one span, clipped against the clip rectangle. Rows outside of it are skipped
+ * without being walked, so huge discs cost only their visible rows.
+ *
+ * @param pixmap Target pixmap
+ * @param cx x-coordinate of the center
+ * @param cy y-coordinate of the center
+ * @param r Radius of the disc
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_circle(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color);
+
+/**
+ * @brief Fills many discs of one color
+ *
+ * Equivalent to calling `fill_circle` for every entry, but rejects offscreen
+ * discs by their bounding box, reuses the row table while consecutive discs
+ * share a radius and skips clipping for discs which are fully inside.
+ *
+ * @param pixmap Target pixmap
+ * @param cx x-coordinates of the centers
+ * @param cy y-coordinates of the centers
+ * @param r Radii of the discs
+ * @param count Number of discs
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_circles(Pixmap *pixmap, const int32_t *cx, const int32_t *cy, const int32_t *r, size_t count, uint32_t color);
\ No newline at end of file
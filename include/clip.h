@@ -0,0 +1,120 @@
+/**
+ * @file clip.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Line and bounding box clipping against rectangles
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Cohen-Sutherland region codes
+ *
+ */
+typedef enum OutCode
+{
+    CLIP_INSIDE = 0,
+    CLIP_LEFT = 1 << 0,
+    CLIP_RIGHT = 1 << 1,
+    CLIP_TOP = 1 << 2,
+    CLIP_BOTTOM = 1 << 3,
+} OutCode;
+
+/**
+ * @brief Result of testing a bounding box against a clip rectangle
+ *
+ */
+typedef enum ClipResult
+{
+    CLIP_REJECT,  // Completely outside, nothing to draw
+    CLIP_ACCEPT,  // Completely inside, no clipping needed
+    CLIP_PARTIAL, // Crosses the boundary
+} ClipResult;
+
+/**
+ * @brief Computes the region code of a pixel
+ *
+ * @param rect Clip rectangle
+ * @param x x-coordinate of the pixel
+ * @param y y-coordinate of the pixel
+ * @return Combination of `OutCode` flags, CLIP_INSIDE if the pixel lies in the rectangle
+ */
+uint32_t clip_outcode(const Rect *rect, int32_t x, int32_t y);
+
+/**
+ * @brief Classifies the bounding box [x0, x1] x [y0, y1] (inclusive)
+ *
+ * Used by circles, polygons and other primitives to skip everything offscreen
+ * and to drop per-pixel checks for everything fully visible.
+ *
+ * @param rect Clip rectangle
+ * @param x0 Smallest x-coordinate of the box
+ * @param y0 Smallest y-coordinate of the box
+ * @param x1 Largest x-coordinate of the box
+ * @param y1 Largest y-coordinate of the box
+ * @return CLIP_REJECT, CLIP_ACCEPT or CLIP_PARTIAL
+ */
+ClipResult clip_bounds(const Rect *rect, int64_t x0, int64_t y0, int64_t x1, int64_t y1);
+
+/**
+ * @brief Clips a line with the Cohen-Sutherland algorithm
+ *
+ * The endpoints are moved onto the border of the rectangle and rounded to the
+ * nearest pixel. Lines drawn from the clipped endpoints can therefore differ
+ * by a pixel from the unclipped line, the line rasterizers in line.h clip
+ * exactly on their own.
+ *
+ * @param rect Clip rectangle
+ * @param x0 Starting x-coordinate, updated in place
+ * @param y0 Starting y-coordinate, updated in place
+ * @param x1 Ending x-coordinate, updated in place
+ * @param y1 Ending y-coordinate, updated in place
+ * @return false if the line lies completely outside the rectangle
+ */
+bool clip_line(const Rect *rect, int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1);
+
+/**
+ * @brief Clips the parameter range of a line with the Liang-Barsky algorithm
+ *
+ * The line is P(t) = (x0, y0) + t * (x1 - x0, y1 - y0). Pixel (x, y) covers
+ * the area [x - 1/2, x + 1/2) x [y - 1/2, y + 1/2), so the rectangle covers
+ * [rect.x0 - 1/2, rect.x1 - 1/2] x [rect.y0 - 1/2, rect.y1 - 1/2].
+ *
+ * @param rect Clip rectangle
+ * @param x0 Starting x-coordinate
+ * @param y0 Starting y-coordinate
+ * @param x1 Ending x-coordinate
+ * @param y1 Ending y-coordinate
+ * @param t0 Receives the first parameter inside the rectangle, within [0, 1]
+ * @param t1 Receives the last parameter inside the rectangle, within [0, 1]
+ * @return false if no part of the line lies inside the rectangle
+ */
+bool clip_line_liang_barsky(const Rect *rect, double x0, double y0, double x1, double y1, double *t0, double *t1);
+
+/**
+ * @brief Finds the steps of a Bresenham line that fall inside a clip rectangle
+ *
+ * The line is normalized to run along its major axis u with u0 <= u1 and
+ * 0 <= dv <= du, the minor coordinate moving by `sv` per increment. After k
+ * steps the minor offset is e(k) = floor((2 dv k + du) / (2 du)), which is
+ * exactly what the error term accumulates, so the walk can start at any step
+ * with the same pixels as a walk from the first endpoint.
+ *
+ * @param clip Clip rectangle, already transposed for steep lines
+ * @param u0 Major coordinate of the start
+ * @param v0 Minor coordinate of the start
+ * @param du Major length, positive
+ * @param dv Minor length, between 0 and du
+ * @param sv Direction of the minor axis, 1 or -1
+ * @param first Receives the first visible step
+ * @param last Receives the last visible step
+ * @return false if no step is visible
+ */
+bool clip_bresenham(const Rect *clip, int64_t u0, int64_t v0, int64_t du, int64_t dv, int64_t sv,
+                    int64_t *first, int64_t *last);
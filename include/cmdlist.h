@@ -0,0 +1,191 @@
+/**
+ * @file cmdlist.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Recorded command lists that are replayed against pixmaps
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+#include "pool.h"
+
+/**
+ * @brief A list of recorded primitives
+ *
+ * Primitives are packed into large arena blocks, so recording costs a few
+ * bytes per primitive and no allocation in the common case. A list is built
+ * once and can be replayed any number of times against any pixmap, which
+ * suits static layers such as grids, axes and backgrounds.
+ *
+ * Replay produces exactly the same pixels as issuing the calls directly in the
+ * order they were recorded. Lines are drawn with `draw_line_bresenham` and
+ * circles with `draw_circle`.
+ *
+ * Replays only read the list, so one list may be replayed from several threads
+ * at once as long as every thread passes its own `CmdBins`. A list must not be
+ * modified while it is replayed, and `cmdlist_replay_parallel` spreads a single
+ * replay over many threads.
+ */
+typedef struct CmdList CmdList;
+
+/**
+ * @brief The commands of a list sorted by the area of the pixmap they overlap
+ *
+ * Replays build the bins before drawing. Passing the same bins again skips this
+ * step as long as the list is unchanged and the pixmap has the same size. Bins
+ * are written by every replay that uses them, so they belong to one thread at
+ * a time, but they can be used with any number of lists.
+ */
+typedef struct CmdBins CmdBins;
+
+/**
+ * @brief Creates an empty command list
+ *
+ * @return The new list, or NULL if the allocation failed
+ */
+CmdList *cmdlist_create(void);
+
+/**
+ * @brief Releases a command list and all of its memory
+ *
+ * @param list List to destroy, may be NULL
+ */
+void cmdlist_destroy(CmdList *list);
+
+/**
+ * @brief Removes all commands but keeps the memory for recording again
+ *
+ * @param list List to reset
+ */
+void cmdlist_reset(CmdList *list);
+
+/**
+ * @brief Returns the number of recorded commands
+ *
+ * @param list List to inspect
+ */
+size_t cmdlist_size(const CmdList *list);
+
+/**
+ * @brief Creates empty bins
+ *
+ * @return The new bins, or NULL if the allocation failed
+ */
+CmdBins *cmdlist_bins_create(void);
+
+/**
+ * @brief Releases bins and all of their memory
+ *
+ * @param bins Bins to destroy, may be NULL
+ */
+void cmdlist_bins_destroy(CmdBins *bins);
+
+/**
+ * @brief Records `pixmap_clear`
+ *
+ * Commands recorded before a clear are skipped on replay, since the clear
+ * overwrites everything they drew.
+ *
+ * @param list Target list
+ * @param color 4 byte integer representing the color in RGBA format
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_clear(CmdList *list, uint32_t color);
+
+/**
+ * @brief Records `draw_point`
+ *
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_draw_point(CmdList *list, int32_t x, int32_t y, uint32_t color);
+
+/**
+ * @brief Records a line drawn with `draw_line_bresenham`
+ *
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_draw_line(CmdList *list, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+
+/**
+ * @brief Records `draw_circle`
+ *
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_draw_circle(CmdList *list, int32_t cx, int32_t cy, int32_t r, uint32_t color);
+
+/**
+ * @brief Records `fill_circle`
+ *
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_fill_circle(CmdList *list, int32_t cx, int32_t cy, int32_t r, uint32_t color);
+
+/**
+ * @brief Records `fill_rect`
+ *
+ * @return false if the command could not be allocated
+ */
+bool cmdlist_fill_rect(CmdList *list, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color);
+
+/**
+ * @brief Draws every recorded command into a pixmap
+ *
+ * The pixmap is processed in horizontal bands small enough to stay in the
+ * cache. Each band replays, in recording order, only the commands whose
+ * bounding box overlaps it, with the clip rectangle narrowed to the band.
+ * The assignment of commands to bands is kept in `bins` and rebuilt when the
+ * list changes or it is replayed against a pixmap of another size.
+ *
+ * Commands are clipped against the clip rectangle of the pixmap at replay time.
+ * A recorded clear fills the whole pixmap, just like `pixmap_clear`.
+ *
+ * @param list Commands to replay
+ * @param pixmap Target pixmap
+ * @param bins Bins owned by the caller, or NULL to build temporary ones for this replay
+ */
+void cmdlist_replay(const CmdList *list, Pixmap *pixmap, CmdBins *bins);
+
+/**
+ * @brief Draws every recorded command into a pixmap using a thread pool
+ *
+ * The pixmap is split into 64x64 tiles and each command is binned into the
+ * tiles its bounding box overlaps. The workers replay whole tiles with the
+ * clip rectangle narrowed to the tile, so every worker only writes its own
+ * pixels and no locking is needed. The result is identical to `cmdlist_replay`.
+ *
+ * The bins are kept like those of `cmdlist_replay`, but the two use different
+ * layouts, so alternating between them with the same bins rebuilds them every
+ * time. The workers only read the bins, which are built before they start.
+ *
+ * @param list Commands to replay
+ * @param pixmap Target pixmap
+ * @param pool Pool whose workers rasterize the tiles
+ * @param bins Bins owned by the caller, or NULL to build temporary ones for this replay
+ */
+void cmdlist_replay_parallel(const CmdList *list, Pixmap *pixmap, RenderPool *pool, CmdBins *bins);
+
+/**
+ * @brief Draws every recorded command into a pixmap, hiding opaque fills first
+ *
+ * Replays in bands like `cmdlist_replay`, but consecutive opaque fills, that
+ * is filled rectangles and discs drawn as stores, are rasterized from the last
+ * one to the first against a per-band mask of the pixels already written.
+ * Spans only write the pixels that are still uncovered, fills whose bounding
+ * box lies entirely over covered pixels are skipped, and once a band is fully
+ * covered the fills further back and the clear below them are not drawn at
+ * all, so each pixel is written at most once. This pays off for stacked
+ * layers with heavy overdraw. Other commands keep their place in the order and
+ * split the fills around them into separate runs. The result is identical to
+ * `cmdlist_replay`.
+ *
+ * @param list Commands to replay
+ * @param pixmap Target pixmap
+ * @param bins Bins owned by the caller, or NULL to build temporary ones for this replay
+ */
+void cmdlist_replay_front_to_back(const CmdList *list, Pixmap *pixmap, CmdBins *bins);
@@ -6,6 +6,7 @@
  * @date 2025-05-04
  * 
  */
+#pragma once
 
 /**
  * @brief Predefined basic colors
@@ -29,4 +30,5 @@ enum CONST
     WIDTH = 800,
     HEIGHT = 600,
     RES = (WIDTH * HEIGHT),
+    PIXMAP_ALIGNMENT = 64, // Alignment of pixmap storage and rows in bytes
 };
\ No newline at end of file
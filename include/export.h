@@ -0,0 +1,89 @@
+/**
+ * @file export.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Binary image export to files, file descriptors and memory
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Output formats supported by the exporters
+ *
+ */
+typedef enum ImageFormat
+{
+    IMAGE_PPM,   // Binary PPM (P6), 3 bytes per pixel, alpha is dropped
+    IMAGE_RGBA,  // Headerless bytes in R, G, B, A order, 4 bytes per pixel
+    IMAGE_PNG,   // 8-bit RGB PNG compressed with a fast fixed-Huffman deflate
+    IMAGE_DELTA, // The regions changed since the last `pixmap_dirty_reset`, see below
+    IMAGE_RAW,   // Headerless pixels exactly as stored in a pixmap: premultiplied 0xRRGGBBAA words in host byte order
+} ImageFormat;
+
+/*
+ * IMAGE_DELTA layout, all integers are 32-bit big-endian:
+ *
+ *   "RDLT" width height count
+ *   count times: x y w h, followed by w * h pixels as in IMAGE_RGBA, row by row
+ *
+ * The rectangles are disjoint. Copying each of them into the previous frame
+ * reproduces the current one, and a pixmap without dirty tracking sends a
+ * single rectangle covering everything. Exporting does not reset the changes,
+ * call `pixmap_dirty_reset` once the consumer has received them.
+ */
+
+/**
+ * @brief Writes the pixmap to a file
+ *
+ * The file is created or truncated.
+ *
+ * @param pixmap Source pixmap
+ * @param path Path of the output file
+ * @param format Output format
+ * @return true on success, false if the file could not be opened or written
+ */
+bool pixmap_export_file(const Pixmap *pixmap, const char *path, ImageFormat format);
+
+/**
+ * @brief Writes the pixmap to an already open file descriptor
+ *
+ * The descriptor is written sequentially with large writes and is not closed,
+ * so pipes and sockets work as well as regular files.
+ *
+ * @param pixmap Source pixmap
+ * @param fd Writable file descriptor
+ * @param format Output format
+ * @return true on success, false if a write failed
+ */
+bool pixmap_export_fd(const Pixmap *pixmap, int fd, ImageFormat format);
+
+/**
+ * @brief Writes the pixmap into a caller-supplied buffer
+ *
+ * If the image does not fit, the first `capacity` bytes are written and the
+ * full size is still returned, so the caller can retry with a larger buffer.
+ * `pixmap_export_bound` gives a capacity which is always sufficient.
+ *
+ * @param pixmap Source pixmap
+ * @param buffer Destination buffer, may be NULL if `capacity` is 0
+ * @param capacity Size of the destination buffer in bytes
+ * @param format Output format
+ * @return Size of the encoded image in bytes
+ */
+size_t pixmap_export_memory(const Pixmap *pixmap, uint8_t *buffer, size_t capacity, ImageFormat format);
+
+/**
+ * @brief Returns an upper bound for the encoded size of the pixmap
+ *
+ * @param pixmap Source pixmap
+ * @param format Output format
+ * @return Maximum size of the encoded image in bytes
+ */
+size_t pixmap_export_bound(const Pixmap *pixmap, ImageFormat format);
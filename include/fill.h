@@ -0,0 +1,84 @@
+/**
+ * @file fill.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Seed fills of connected pixel regions
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+#include "pool.h"
+
+/**
+ * @brief Replaces the region of equal pixels around a seed
+ *
+ * The region contains the seed and every pixel of the same value that is
+ * 4-connected to it within the clip rectangle. It is found as horizontal spans
+ * with an explicit span stack instead of recursion, recorded in a bit mask of
+ * the clip rectangle, and painted afterwards as spans with the blend mode of
+ * the pixmap. Memory stays bounded by the mask and a stack sized to the clip
+ * height: spans that do not fit onto the stack are picked up again by
+ * sweeping the mask, which is slower but never fails.
+ *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the seed
+ * @param y y-coordinate of the seed
+ * @param color 4 byte integer representing the color in RGBA format
+ * @return false if the mask or the stack could not be allocated, true otherwise
+ *         (also if the seed lies outside the clip rectangle)
+ */
+bool flood_fill(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color);
+
+/**
+ * @brief Fills the region around a seed up to pixels of a boundary color
+ *
+ * The region contains every pixel 4-connected to the seed that does not hold
+ * the boundary color, within the clip rectangle. Nothing is filled if the seed
+ * itself has the boundary color. The region is found and painted as in
+ * `flood_fill`.
+ *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the seed
+ * @param y y-coordinate of the seed
+ * @param boundary 4 byte integer representing the boundary color in RGBA format
+ * @param color 4 byte integer representing the color in RGBA format
+ * @return false if the mask or the stack could not be allocated
+ */
+bool boundary_fill(Pixmap *pixmap, int32_t x, int32_t y, uint32_t boundary, uint32_t color);
+
+/**
+ * @brief `flood_fill` spread over a thread pool
+ *
+ * The clip rectangle is split into one horizontal band per worker. Each worker
+ * fills its band from the seeds it has, then the spans crossing the band
+ * borders become seeds of the neighbouring bands for the next round, until no
+ * band has seeds left. Painting runs in parallel as well. Regions winding
+ * between the bands many times take many rounds, so this pays off for large
+ * regions on large pixmaps. The result is identical to `flood_fill`.
+ *
+ * @param pixmap Target pixmap
+ * @param pool Pool whose workers fill the bands
+ * @param x x-coordinate of the seed
+ * @param y y-coordinate of the seed
+ * @param color 4 byte integer representing the color in RGBA format
+ * @return false if the mask or the stacks could not be allocated
+ */
+bool flood_fill_parallel(Pixmap *pixmap, RenderPool *pool, int32_t x, int32_t y, uint32_t color);
+
+/**
+ * @brief `boundary_fill` spread over a thread pool, see `flood_fill_parallel`
+ *
+ * @param pixmap Target pixmap
+ * @param pool Pool whose workers fill the bands
+ * @param x x-coordinate of the seed
+ * @param y y-coordinate of the seed
+ * @param boundary 4 byte integer representing the boundary color in RGBA format
+ * @param color 4 byte integer representing the color in RGBA format
+ * @return false if the mask or the stacks could not be allocated
+ */
+bool boundary_fill_parallel(Pixmap *pixmap, RenderPool *pool, int32_t x, int32_t y, uint32_t boundary, uint32_t color);
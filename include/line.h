@@ -7,8 +7,14 @@
  * 
  */
 
+#pragma once
+
+#include <stddef.h>
 #include <stdint.h>
 
+#include "pixmap.h"
+#include "rmath.h"
+
 /**
  * @brief Draws a straight line using the slope-intercept method (y = mx + b)
  *
@@ -17,13 +23,14 @@
  *
  * @note This is a basic implementation and not optimal for performance or steep lines.
  *
+ * @param pixmap Target pixmap
  * @param x0 Starting x-coordinate
  * @param y0 Starting y-coordinate
  * @param x1 Ending x-coordinate
  * @param y1 Ending y-coordinate
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_line_equation(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+void draw_line_equation(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
 
 /**
  * @brief Draws a straight line using the incremental (floating-point) method.
@@ -31,13 +38,14 @@ void draw_line_equation(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t
  * Uses the slope `m` to incrementally compute y from x in floating point.
  * Suitable for all slopes but slower than integer-based methods.
  *
+ * @param pixmap Target pixmap
  * @param x0 Starting x-coordinate.
  * @param y0 Starting y-coordinate.
  * @param x1 Ending x-coordinate.
  * @param y1 Ending y-coordinate.
  * @param color 4-byte integer representing the color in RGBA format.
  */
-void draw_line_incremental(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+void draw_line_incremental(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
 
 /**
  * @brief Draws a line using the Digital Differential Analyzer (DDA) algorithm
@@ -45,13 +53,14 @@ void draw_line_incremental(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint3
  * Converts the line into evenly spaced points between the two endpoints by
  * incrementing both x and y in small steps. Works well for all slopes.
  *
+ * @param pixmap Target pixmap
  * @param x0 Starting x-coordinate
  * @param y0 Starting y-coordinate
  * @param x1 Ending x-coordinate
  * @param y1 Ending y-coordinate
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_line_dda(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+void draw_line_dda(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
 
 /**
  * @brief Draws a straight line using a floating-point decision method.
@@ -74,32 +83,140 @@ void draw_line_dda(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t colo
  * @note This method is slower than integer-only methods, but is useful for
  * understanding how decision-based line drawing works.
  *
+ * @param pixmap Target pixmap
  * @param x0 Starting x-coordinate.
  * @param y0 Starting y-coordinate.
  * @param x1 Ending x-coordinate.
  * @param y1 Ending y-coordinate.
  * @param color 4-byte integer representing the color in RGBA format.
  */
-void draw_line_midpoint(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+void draw_line_midpoint(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
 
 /**
  * @brief Draws a line using Bresenham’s line drawing algorithm
  *
- * Efficiently draws lines using integer math only. Currently handles lines with
- * slope between 0 and 1 in the positive direction.
+ * Draws lines of any direction using integer math only. The line is clipped to
+ * the steps inside the clip rectangle up front, then walked by a kernel
+ * specialized for its octant that steps a pixel pointer by one pixel or one
+ * row, so no pixel is bounds-checked. Axis-aligned lines draw [x0, x1) or
+ * [y0, y1) like spans, all other lines include both end points.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 Starting x-coordinate
+ * @param y0 Starting y-coordinate
+ * @param x1 Ending x-coordinate
+ * @param y1 Ending y-coordinate
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_line_bresenham(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+
+/**
+ * @brief Draws many lines of the same color
+ *
+ * Equivalent to calling `draw_line_bresenham` for the line from (x0[i], y0[i])
+ * to (x1[i], y1[i]) for every i, in order. The end points are passed as
+ * separate arrays, as wireframe and polyline meshes usually keep them, and
+ * lines beyond one edge of the clip rectangle are skipped before any setup.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 Starting x-coordinates
+ * @param y0 Starting y-coordinates
+ * @param x1 Ending x-coordinates
+ * @param y1 Ending y-coordinates
+ * @param count Number of lines
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_lines(Pixmap *pixmap, const int32_t *x0, const int32_t *y0, const int32_t *x1, const int32_t *y1, size_t count,
+                uint32_t color);
+
+/**
+ * @brief Draws an anti-aliased line using Xiaolin Wu's algorithm
  *
- * @todo Extend support for all octants and negative slopes
+ * The line is stepped along its major axis in 16.16 fixed point. Each step
+ * covers the two pixels nearest to the line and splits the color between them
+ * by distance, blending it over the existing pixels like `blend_point`. The
+ * position is kept exact with an integer remainder, so long lines do not
+ * drift and both endpoints get full coverage.
  *
+ * @param pixmap Target pixmap
  * @param x0 Starting x-coordinate
  * @param y0 Starting y-coordinate
  * @param x1 Ending x-coordinate
  * @param y1 Ending y-coordinate
+ * @param color 4 byte integer representing the color in RGBA format, alpha scales the coverage
+ */
+void draw_line_xiaolin(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+
+/**
+ * @brief Draws many anti-aliased lines of the same color
+ *
+ * Equivalent to calling `draw_line_xiaolin` for the line from points[2 * i]
+ * to points[2 * i + 1] for every i, in order.
+ *
+ * @param pixmap Target pixmap
+ * @param points End points of all lines, two per line
+ * @param count Number of lines
  * @param color 4 byte integer representing the color in RGBA format
  */
-void draw_line_bresenham(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+void draw_lines_xiaolin(Pixmap *pixmap, const Point *points, size_t count, uint32_t color);
 
-// TODO: Add description
-void draw_line_xiaolin(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+/**
+ * @brief Shape of the open ends of a thick line
+ *
+ */
+typedef enum LineCap
+{
+    CAP_BUTT,   // Ends exactly at the end points
+    CAP_SQUARE, // Extends past the end points by half the thickness
+    CAP_ROUND,  // Ends in a half circle around the end points
+} LineCap;
+
+/**
+ * @brief Shape of the corners where two segments of a thick polyline meet
+ *
+ */
+typedef enum LineJoin
+{
+    JOIN_MITER, // Extends the outer edges until they meet, sharp corners are cut off (bevelled)
+    JOIN_ROUND, // Rounds the corner with a circle around the vertex
+} LineJoin;
+
+/**
+ * @brief Draws a thick line
+ *
+ * The line is drawn like `draw_polyline` with two points and square caps, so
+ * its ends reach half the thickness past the end points. A thickness of one
+ * or less draws the line with `draw_line_bresenham`.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 Starting x-coordinate
+ * @param y0 Starting y-coordinate
+ * @param x1 Ending x-coordinate
+ * @param y1 Ending y-coordinate
+ * @param thickness Width of the line in pixels
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_line(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t thickness, uint32_t color);
 
-// TODO: Add description
-void draw_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t thickness, uint32_t color);
+/**
+ * @brief Draws a thick open polyline
+ *
+ * Every segment is turned into a rectangle of the given width, and caps and
+ * joins are added as further polygons. The outline is filled in one pass by the
+ * scan converter with the non-zero rule, so the cost follows the covered area
+ * and every pixel is written once, even where the pieces overlap. Pixels are
+ * covered if their center lies inside the stroke, following `fill_polygon`.
+ *
+ * Miter joins whose tip would reach further than 4 half widths from the vertex
+ * are bevelled, round caps and joins stay within a quarter pixel of a circle.
+ *
+ * @param pixmap Target pixmap
+ * @param points Vertices in drawing order, repeated vertices are ignored
+ * @param count Number of vertices, a single vertex draws only its caps
+ * @param thickness Width of the line in pixels
+ * @param cap Shape of both ends
+ * @param join Shape of the corners
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_polyline(Pixmap *pixmap, const Point *points, size_t count, int32_t thickness, LineCap cap, LineJoin join,
+                   uint32_t color);
@@ -0,0 +1,102 @@
+/**
+ * @file mapped.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Image files rendered in place through a memory mapping
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "export.h"
+#include "pixmap.h"
+
+/**
+ * @brief An image file whose pixels are rendered through a memory mapping
+ *
+ * The file is created at its final size and mapped into memory, so images far
+ * larger than the main memory can be rendered: the operating system pages the
+ * pixels in and writes them back as needed, and there is no separate export.
+ *
+ * With IMAGE_RAW the pixels of the pixmap are the file itself, so drawing
+ * writes straight into the page cache. IMAGE_PPM and IMAGE_RGBA store the
+ * pixels in another layout: the pixmap then draws into scratch memory that is
+ * only reserved, not allocated, and rows are converted into the file once they
+ * are finished.
+ *
+ * Memory mapped files are not supported on Windows, `mapped_image_create`
+ * fails there.
+ */
+typedef struct MappedImage MappedImage;
+
+/**
+ * @brief Draws the scene into one band of a mapped image
+ *
+ * @param context Pointer passed to `mapped_image_render`
+ * @param pixmap Pixmap covering the whole image, with the clip rectangle narrowed to the band
+ */
+typedef void (*RenderBand)(void *context, Pixmap *pixmap);
+
+/**
+ * @brief Creates an image file and maps it into memory
+ *
+ * The file is created or truncated and allocated at its full size up front, so
+ * a full disk is reported here instead of failing a later write.
+ *
+ * @param path Path of the output file
+ * @param width Width of the image in pixels
+ * @param height Height of the image in pixels
+ * @param format IMAGE_RAW, IMAGE_PPM or IMAGE_RGBA
+ * @return The image, or NULL if the format is not supported or the file could not be created
+ */
+MappedImage *mapped_image_create(const char *path, int32_t width, int32_t height, ImageFormat format);
+
+/**
+ * @brief Returns the pixmap covering the whole image
+ *
+ * The pixmap belongs to the image and must not be destroyed. Its stride equals
+ * its width for IMAGE_RAW, so its rows are only 64-byte aligned if the width
+ * is a multiple of 16. With IMAGE_PPM and IMAGE_RGBA every row drawn stays in
+ * memory until the image is closed, `mapped_image_render` keeps the memory
+ * bounded instead.
+ *
+ * @param image Mapped image
+ */
+Pixmap *mapped_image_pixmap(MappedImage *image);
+
+/**
+ * @brief Renders the image in horizontal bands with bounded memory
+ *
+ * For every band from top to bottom, the rows of the band are cleared to the
+ * background, the clip rectangle of the pixmap is narrowed to the band and
+ * `render` draws the scene with the usual primitives in image coordinates.
+ * The finished band is converted into the file if needed and released, so only
+ * about one band of pixels stays resident, while the operating system writes
+ * the finished ones back to disk. Drawing with `pixmap_clear` ignores the clip
+ * rectangle and must not be used inside `render`.
+ *
+ * Rows rendered this way are final: drawing into them afterwards through the
+ * pixmap may be lost. The clip rectangle is reset afterwards.
+ *
+ * @param image Mapped image
+ * @param band_height Rows per band, 0 renders the whole image as one band
+ * @param background 4 byte integer representing the color in RGBA format
+ * @param render Draws the scene, once per band
+ * @param context Passed to `render`
+ * @return false if writing back a band failed
+ */
+bool mapped_image_render(MappedImage *image, int32_t band_height, uint32_t background, RenderBand render, void *context);
+
+/**
+ * @brief Finishes the file and releases the image
+ *
+ * Rows drawn through the pixmap that have not been rendered in bands are
+ * converted, then everything is written back to disk and unmapped.
+ *
+ * @param image Image created by `mapped_image_create`, may be NULL
+ * @return false if writing the file failed
+ */
+bool mapped_image_close(MappedImage *image);
@@ -0,0 +1,288 @@
+/**
+ * @file pixmap.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Render surfaces that every primitive draws into
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Axis-aligned rectangle of pixels covering [x0, x1) x [y0, y1)
+ *
+ */
+typedef struct Rect
+{
+    int32_t x0, y0;
+    int32_t x1, y1;
+} Rect;
+
+/**
+ * @brief Granularity and size limits of the dirty tracking
+ *
+ */
+enum
+{
+    PIXMAP_DIRTY_TILE = 16, // Side length of the squares changes are tracked in, in pixels
+    PIXMAP_DIRTY_MAX = 64,  // Most rectangles a delta export or `pixmap_clear_dirty` works on
+};
+
+/**
+ * @brief How primitives combine their color with the pixels already in a pixmap
+ *
+ * Pixels hold premultiplied colors: red, green and blue are already scaled by
+ * alpha. Colors passed to primitives are not premultiplied, they are converted
+ * on the way in. Opaque colors are identical in both forms.
+ */
+typedef enum BlendMode
+{
+    BLEND_NONE,     // Replaces the pixel
+    BLEND_SRC_OVER, // Composites the color over the pixel: src + dst * (1 - src_alpha)
+    BLEND_ADD,      // Adds the color to the pixel, saturating every channel
+    BLEND_MULTIPLY, // Multiplies the channels: src * dst + src * (1 - dst_alpha) + dst * (1 - src_alpha)
+} BlendMode;
+
+/**
+ * @brief Order of the pixels in the storage of a pixmap
+ *
+ * Linear pixmaps store one row after another, so vertically neighbouring
+ * pixels are a whole row apart: vertical and steep lines and the steep octants
+ * of circles touch a new cache line, and on large pixmaps a new page, on every
+ * pixel. Tiled pixmaps store square tiles one after another, row of tiles by
+ * row of tiles, so a tile of 16x16 pixels spans 1 KiB and stays in a few cache
+ * lines and a single page. Horizontal spans are split at every tile border
+ * instead. Morton order inside the tiles interleaves the bits of x and y, so
+ * that every 2x2, 4x4 and 8x8 block is contiguous as well, at the cost of spans
+ * only being contiguous in pairs of pixels.
+ *
+ * The low four bits of the tiled layouts hold log2 of the tile size.
+ */
+typedef enum PixmapLayout
+{
+    LAYOUT_LINEAR = 0,      // Row by row, `stride` pixels apart
+    LAYOUT_TILED8 = 3,      // 8x8 tiles, row by row inside each tile
+    LAYOUT_TILED16 = 4,     // 16x16 tiles, row by row inside each tile
+    LAYOUT_MORTON8 = 0x13,  // 8x8 tiles in Morton order
+    LAYOUT_MORTON16 = 0x14, // 16x16 tiles in Morton order
+} PixmapLayout;
+
+/**
+ * @brief A render target with its own dimensions and storage
+ *
+ * Pixels are stored row by row, `stride` pixels apart, unless `layout` selects
+ * tiles. The storage is 64-byte aligned and every row and every tile starts on
+ * a 64-byte boundary, so kernels can use aligned vector stores. Every
+ * primitive and export works with any layout, code reading `pixels` directly
+ * must check for LAYOUT_LINEAR or go through `pixmap_read_rows`. Independent
+ * pixmaps share no state, which allows several images to be rendered at the
+ * same time from different threads.
+ *
+ * Primitives only touch pixels inside `clip`, which always lies within the
+ * pixmap. Clipping happens once per primitive, so inner loops store pixels
+ * without per-pixel bounds checks.
+ *
+ * Primitives combine their color with the existing pixels according to
+ * `blend`. Opaque colors drawn with BLEND_NONE or BLEND_SRC_OVER are plain
+ * stores, every other combination runs through the vectorized blend kernels.
+ *
+ * With dirty tracking enabled, every write marks the PIXMAP_DIRTY_TILE square
+ * it falls into, so that clears and exports can skip the unchanged parts.
+ */
+typedef struct Pixmap
+{
+    uint32_t *pixels;    // Pixel storage in the order given by `layout`
+    int32_t width;       // Visible width in pixels
+    int32_t height;      // Visible height in pixels
+    int32_t stride;      // Distance between two rows in pixels (>= width), for tiled layouts the padded width
+    Rect clip;           // Pixels that primitives may write
+    BlendMode blend;     // Applied by every primitive drawn into the pixmap
+    uint8_t *dirty;      // Flags per PIXMAP_DIRTY_TILE square, NULL unless tracking is enabled
+    PixmapLayout layout; // Order of the pixels in `pixels`
+} Pixmap;
+
+/**
+ * @brief Creates a pixmap with the given dimensions
+ *
+ * The pixel contents are undefined until the pixmap is cleared. The blend
+ * mode starts as BLEND_NONE and dirty tracking is disabled.
+ *
+ * @param width Width in pixels, must be positive
+ * @param height Height in pixels, must be positive
+ * @return The new pixmap, or NULL if the dimensions are invalid or the allocation failed
+ */
+Pixmap *pixmap_create(int32_t width, int32_t height);
+
+/**
+ * @brief Creates a pixmap with the given dimensions and pixel order
+ *
+ * Tiled pixmaps are padded to whole tiles. Otherwise they behave exactly like
+ * `pixmap_create`, and draw the same pixels.
+ *
+ * @param width Width in pixels, must be positive
+ * @param height Height in pixels, must be positive
+ * @param layout Order of the pixels in memory
+ * @return The new pixmap, or NULL if the dimensions are invalid or the allocation failed
+ */
+Pixmap *pixmap_create_layout(int32_t width, int32_t height, PixmapLayout layout);
+
+/**
+ * @brief Copies rows of a pixmap into row-major memory
+ *
+ * Tiled pixmaps are detiled a row of tiles at a time with vector shuffles.
+ *
+ * @param pixmap Source pixmap
+ * @param y First row to copy
+ * @param count Number of rows, y + count must not exceed the height
+ * @param dst Receives `width` pixels per row
+ * @param dst_stride Distance between two rows of `dst` in pixels
+ */
+void pixmap_read_rows(const Pixmap *pixmap, int32_t y, int32_t count, uint32_t *dst, size_t dst_stride);
+
+/**
+ * @brief Copies rows of straight-alpha colors from row-major memory into a pixmap
+ *
+ * The counterpart of `pixmap_read_rows` for pixels produced outside the
+ * primitives. Every color is premultiplied the way the primitives store it,
+ * and the rows are marked as changed and drawn for the dirty tracking. The
+ * clip rectangle and the blend mode are ignored.
+ *
+ * @param pixmap Target pixmap
+ * @param y First row to write
+ * @param count Number of rows, y + count must not exceed the height
+ * @param src `width` colors per row in RGBA format
+ * @param src_stride Distance between two rows of `src` in pixels
+ */
+void pixmap_write_rows(Pixmap *pixmap, int32_t y, int32_t count, const uint32_t *src, size_t src_stride);
+
+/**
+ * @brief Returns the premultiplied value of one pixel inside the pixmap, for any layout
+ *
+ */
+uint32_t pixmap_get_pixel(const Pixmap *pixmap, int32_t x, int32_t y);
+
+/**
+ * @brief Converts a premultiplied pixel back to a straight-alpha color
+ *
+ * Opaque pixels are returned unchanged, fully transparent ones as 0.
+ *
+ * @param pixel Premultiplied pixel as read from a pixmap
+ * @return The color in RGBA format, rounded to the nearest value
+ */
+uint32_t color_unpremultiply(uint32_t pixel);
+
+/**
+ * @brief Releases a pixmap and its pixel storage
+ *
+ * @param pixmap Pixmap created by `pixmap_create` or `pixmap_create_layout`, may be NULL
+ */
+void pixmap_destroy(Pixmap *pixmap);
+
+/**
+ * @brief Restricts all following primitives to a rectangle
+ *
+ * The rectangle is intersected with the pixmap bounds. Rasterization does not
+ * depend on the clip rectangle: a primitive drawn under several disjoint clip
+ * rectangles produces the same pixels as when drawn once without one.
+ *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the top-left corner
+ * @param y y-coordinate of the top-left corner
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+void pixmap_set_clip(Pixmap *pixmap, int32_t x, int32_t y, int32_t width, int32_t height);
+
+/**
+ * @brief Resets the clip rectangle to the whole pixmap
+ *
+ * @param pixmap Target pixmap
+ */
+void pixmap_reset_clip(Pixmap *pixmap);
+
+/**
+ * @brief Selects how all following primitives combine with the pixmap
+ *
+ * Primitives whose pieces overlap, such as filled polygons and thick lines,
+ * still blend every pixel once. Thin outlines may blend the few pixels they
+ * visit twice, such as the shared vertices of a polygon outline.
+ *
+ * @param pixmap Target pixmap
+ * @param mode New blend mode
+ */
+void pixmap_set_blend(Pixmap *pixmap, BlendMode mode);
+
+/**
+ * @brief Clears the entire pixmap to a specified color
+ *
+ * The clip rectangle and the blend mode are ignored, the premultiplied color
+ * replaces every pixel.
+ *
+ * @param pixmap Target pixmap
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void pixmap_clear(Pixmap *pixmap, uint32_t color);
+
+/**
+ * @brief Enables or disables tracking of the regions primitives change
+ *
+ * Two things are tracked per square: whether it changed since the last
+ * `pixmap_dirty_reset`, which a delta export sends to the consumer, and
+ * whether something was drawn since the last clear, which `pixmap_clear_dirty`
+ * resets. Enabling marks the whole pixmap as changed, since its previous
+ * contents are unknown.
+ *
+ * @param pixmap Target pixmap
+ * @param enable true to start tracking, false to stop and release the flags
+ * @return false if the flags could not be allocated
+ */
+bool pixmap_track_dirty(Pixmap *pixmap, bool enable);
+
+/**
+ * @brief Returns the regions that changed since the last `pixmap_dirty_reset`
+ *
+ * Changed squares are merged into at most `capacity` disjoint rectangles,
+ * which may include some unchanged pixels when there are more regions than
+ * that. Without tracking, the whole pixmap is returned as a single rectangle.
+ *
+ * @param pixmap Source pixmap
+ * @param rects Receives the rectangles, sorted from top to bottom
+ * @param capacity Size of `rects`
+ * @return Number of rectangles written
+ */
+size_t pixmap_dirty_rects(const Pixmap *pixmap, Rect *rects, size_t capacity);
+
+/**
+ * @brief Marks every region as unchanged, typically after a delta export
+ *
+ * @param pixmap Target pixmap
+ */
+void pixmap_dirty_reset(Pixmap *pixmap);
+
+/**
+ * @brief Clears only what was drawn since the last clear
+ *
+ * Equivalent to `pixmap_clear` when everything outside the drawn regions
+ * still holds the same color from an earlier clear, which is the case for a
+ * background that is redrawn every frame. The cost follows the drawn area
+ * rather than the size of the pixmap. Without tracking the whole pixmap is cleared.
+ *
+ * @param pixmap Target pixmap
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void pixmap_clear_dirty(Pixmap *pixmap, uint32_t color);
+
+/**
+ * @brief Exports the current state of the pixmap to a file
+ *
+ * Saves the pixmap to a file named "pixmap.ppm" in binary PPM (P6) format.
+ * `pixmap_export_file` and its variants in export.h offer other formats and targets.
+ * This can be used to visualize the frame buffer or debug the rendering output.
+ *
+ * @param pixmap Source pixmap
+ */
+void pixmap_export(const Pixmap *pixmap);
@@ -9,18 +9,39 @@
 
 //TODO: Migrate to C++ for function overloadind?
 
+#pragma once
+
 #include <stdint.h>
 
+#include "pixmap.h"
+
 /**
  * @brief Draws a single pixel on the display
  *
  * If the coordinates are outside the display boundaries, no action is taken.
  *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the pixel
+ * @param y y-coordinate of the pixel
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_point(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color);
+
+/**
+ * @brief Blends a color over a single pixel
+ *
+ * The alpha of `color` is multiplied by `coverage`, and the color is then
+ * composited over the pixel. Anti-aliased primitives use this to weight their
+ * color by the fraction of each pixel they cover. Pixels outside the clip
+ * rectangle are ignored.
+ *
+ * @param pixmap Target pixmap
  * @param x x-coordinate of the pixel
  * @param y y-coordinate of the pixel
  * @param color 4 byte integer representing the color in RGBA format
+ * @param coverage Fraction of the pixel covered, from 0 (none) to 255 (all)
  */
-void draw_point(int32_t x, int32_t y, uint32_t color);
+void blend_point(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color, uint8_t coverage);
 
 // TODO: Add description
-void draw_point_thick(int32_t x, int32_t y, int32_t thickness, uint32_t color);
\ No newline at end of file
+void draw_point_thick(Pixmap *pixmap, int32_t x, int32_t y, int32_t thickness, uint32_t color);
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * @file polygon.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Polygon outlines and scanline polygon fills
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+#include "rmath.h"
+
+/**
+ * @brief Decides which regions of a self-intersecting or nested polygon are inside
+ *
+ */
+typedef enum FillRule
+{
+    FILL_EVEN_ODD, // Inside if a ray to infinity crosses an odd number of edges
+    FILL_NON_ZERO, // Inside if the edges wind around the point a non-zero number of times
+} FillRule;
+
+/**
+ * @brief Draws the closed outline of a polygon
+ *
+ * Consecutive vertices, and the last and the first vertex, are connected with
+ * `draw_line_bresenham`.
+ *
+ * @param pixmap Target pixmap
+ * @param points Vertices in drawing order
+ * @param count Number of vertices, a single vertex draws a point
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_polygon(Pixmap *pixmap, const Point *points, size_t count, uint32_t color);
+
+/**
+ * @brief Fills an arbitrary polygon, which may be concave or self-intersecting
+ *
+ * Vertices lie on pixel centers and a pixel is filled if its center is inside
+ * the polygon. Centers exactly on a left or top edge are inside, those on a
+ * right or bottom edge are not, so polygons sharing an edge neither overlap nor
+ * leave gaps. The rectangle (0, 0), (w, 0), (w, h), (0, h) covers the same
+ * pixels as `fill_rect(pixmap, 0, 0, w, h, color)`.
+ *
+ * Edges are stepped with exact integer arithmetic and every scanline is written
+ * as horizontal spans. Convex polygons skip the edge sorting entirely.
+ *
+ * @param pixmap Target pixmap
+ * @param points Vertices in drawing order, the polygon is closed implicitly
+ * @param count Number of vertices, fewer than three fill nothing
+ * @param rule Fill rule for overlapping regions
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_polygon(Pixmap *pixmap, const Point *points, size_t count, FillRule rule, uint32_t color);
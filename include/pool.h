@@ -0,0 +1,67 @@
+/**
+ * @file pool.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Work-stealing thread pool for parallel rasterization
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A fixed set of worker threads
+ *
+ * Jobs are split into independent tasks which are dealt out to the workers in
+ * contiguous ranges. A worker that runs out of tasks steals half of the
+ * remaining range of another worker, so uneven tasks still keep every thread
+ * busy. The calling thread takes part as one of the workers.
+ */
+typedef struct RenderPool RenderPool;
+
+/**
+ * @brief Task callback
+ *
+ * @param context Pointer passed to `render_pool_run`
+ * @param index Index of the task in [0, count)
+ * @param worker Index of the worker running the task in [0, threads)
+ */
+typedef void (*RenderTask)(void *context, size_t index, int32_t worker);
+
+/**
+ * @brief Creates a thread pool
+ *
+ * @param threads Number of workers including the calling thread, 0 or less
+ *                selects the number of hardware threads
+ * @return The new pool, or NULL if the threads could not be started
+ */
+RenderPool *render_pool_create(int32_t threads);
+
+/**
+ * @brief Stops the workers and releases the pool
+ *
+ * @param pool Pool to destroy, may be NULL
+ */
+void render_pool_destroy(RenderPool *pool);
+
+/**
+ * @brief Returns the number of workers including the calling thread
+ *
+ * @param pool Pool to inspect
+ */
+int32_t render_pool_threads(const RenderPool *pool);
+
+/**
+ * @brief Runs `task` for every index in [0, count) and waits for all of them
+ *
+ * Tasks may run in any order and on any worker. Calls from several threads
+ * are serialized.
+ *
+ * @param pool Pool to run on
+ * @param count Number of tasks
+ * @param task Callback for every task
+ * @param context Pointer handed to every task
+ */
+void render_pool_run(RenderPool *pool, size_t count, RenderTask task, void *context);
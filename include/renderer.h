@@ -14,28 +14,30 @@
  *   - Bits 8–15 : Blue
  *   - Bits 0–7  : Alpha
  */
+#pragma once
 
 #include <stdint.h>
 
 #include "defs.h"
+#include "pixmap.h"
+#include "export.h"
+#include "mapped.h"
+#include "stream.h"
+#include "scene.h"
+#include "clip.h"
 #include "point.h"
+#include "span.h"
 #include "line.h"
 #include "circle.h"
+#include "polygon.h"
+#include "antialias.h"
+#include "triangle.h"
+#include "fill.h"
+#include "text.h"
+#include "pool.h"
+#include "cmdlist.h"
+#include "stats.h"
 
-/**
- * @brief Clears the entire display to a specified color
- *
- * Fills the entire pixmap with the given color value.
- *
- * @param color 4 byte integer representing the color in RGBA format
- */
-void pixmap_clear(uint32_t color);
-
-/**
- * @brief Exports the current state of the pixmap to a file
- *
- * Saves the `pixmap` array to a file named "pixmap.data" in binary format.
- * This can be used to visualize the frame buffer or debug the rendering output.
- */
-void pixmap_export(void);
-
+#ifdef __cplusplus
+    #include "surface.h"
+#endif
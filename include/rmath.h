@@ -4,16 +4,79 @@
  * @version 0.1
  * @date 2025-04-12
  */
+#pragma once
 
 #include <math.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifndef M_PI
     #define M_PI 3.141592653589793f
 #endif
 
+#if defined(_MSC_VER) && !defined(__SIZEOF_INT128__)
+    #include <intrin.h>
+#endif
+
+/**
+ * @brief A pixel position, negative coordinates lie left of or above the pixmap
+ *
+ */
 typedef struct Point
 {
-    uint32_t x, y;
+    int32_t x, y;
 } Point;
-typedef Point Vec2;
\ No newline at end of file
+typedef Point Vec2;
+
+/**
+ * @brief Computes floor((a * b + c) / d) and its remainder without overflow
+ *
+ * The product may exceed 64 bits, which happens for lines spanning most of the
+ * 32-bit coordinate range. The quotient itself must fit into 64 bits.
+ *
+ * @param a First factor
+ * @param b Second factor
+ * @param c Addend
+ * @param d Divisor, must be positive
+ * @param remainder Receives the remainder, may be NULL
+ * @return The quotient
+ */
+static inline uint64_t mul_div_u64(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t *remainder)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 n = (unsigned __int128)a * b + c;
+    if (remainder != NULL)
+        *remainder = (uint64_t)(n % d);
+    return (uint64_t)(n / d);
+#else
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    low += c;
+    high += low < c;
+    uint64_t rem;
+    uint64_t quotient = _udiv128(high, low, d, &rem);
+    if (remainder != NULL)
+        *remainder = rem;
+    return quotient;
+#endif
+}
+/**
+ * @brief Returns the sign of a * b - c * d without overflow
+ *
+ * @return -1, 0 or 1
+ */
+static inline int32_t mul_compare_i64(int64_t a, int64_t b, int64_t c, int64_t d)
+{
+#if defined(__SIZEOF_INT128__)
+    __int128 left = (__int128)a * b;
+    __int128 right = (__int128)c * d;
+#else
+    int64_t left_high, right_high;
+    uint64_t left_low = (uint64_t)_mul128(a, b, &left_high);
+    uint64_t right_low = (uint64_t)_mul128(c, d, &right_high);
+    if (left_high != right_high)
+        return left_high < right_high ? -1 : 1;
+    uint64_t left = left_low, right = right_low;
+#endif
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
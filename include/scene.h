@@ -0,0 +1,158 @@
+/**
+ * @file scene.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Scene files rendered with the primitives, as text or as memory-mapped binary
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief A list of drawing commands together with the size of the image
+ *
+ * Scenes are stored in a compact binary form: a header followed by records
+ * of 32-bit words, see below. Binary scene files are memory mapped and the
+ * primitives are drawn straight from the mapping, consecutive lines, points
+ * and circles of one color in batches with the batched primitives, so loading
+ * costs one pass over the record headers, independent of the number of
+ * primitives. Text scenes are parsed into the same form once.
+ *
+ * Text scenes have one command per line, lines starting with `#` are comments
+ * and colors are written as #RRGGBB, #RRGGBBAA or as black, white, red, green
+ * or blue:
+ *
+ *   size width height                      must come first
+ *   clear color
+ *   blend none|over|add|multiply
+ *   clip x y width height | clip reset
+ *   point x y color
+ *   line x0 y0 x1 y1 color [thickness]
+ *   circle cx cy r color
+ *   fill_circle cx cy r color
+ *   rect x y width height color
+ *   triangle x0 y0 x1 y1 x2 y2 color
+ *   polygon color x0 y0 x1 y1 ...
+ *   fill_polygon evenodd|nonzero color x0 y0 x1 y1 ...
+ *   text x y size color "UTF-8 text"
+ *   flood x y color
+ *   boundary x y boundary_color color
+ */
+typedef struct Scene Scene;
+
+/*
+ * Binary scene layout, all integers are 32-bit little-endian:
+ *
+ *   "RSCN" version(1) width height words_low words_high 0 0
+ *   records, `words` 32-bit words in total
+ *
+ * Every record starts with its opcode and its length in words, including
+ * these two. Columns hold `count` values each:
+ *
+ *   SCENE_CLEAR         color
+ *   SCENE_BLEND         mode
+ *   SCENE_CLIP          x y width height
+ *   SCENE_RESET_CLIP
+ *   SCENE_POINTS        color count, columns x y
+ *   SCENE_LINES         color thickness count, columns x0 y0 x1 y1
+ *   SCENE_CIRCLES       color count, columns cx cy r
+ *   SCENE_FILL_CIRCLES  color count, columns cx cy r
+ *   SCENE_RECTS         color count, columns x y width height
+ *   SCENE_TRIANGLES     color count, count times x0 y0 x1 y1 x2 y2
+ *   SCENE_POLYGON       color count, count times x y
+ *   SCENE_FILL_POLYGON  color rule count, count times x y
+ *   SCENE_TEXT          x y size color, UTF-8 bytes up to a NUL, padded to whole words
+ *   SCENE_FLOOD         x y color
+ *   SCENE_BOUNDARY      x y boundary color
+ */
+typedef enum SceneOp
+{
+    SCENE_CLEAR = 1,
+    SCENE_BLEND,
+    SCENE_CLIP,
+    SCENE_RESET_CLIP,
+    SCENE_POINTS,
+    SCENE_LINES,
+    SCENE_CIRCLES,
+    SCENE_FILL_CIRCLES,
+    SCENE_RECTS,
+    SCENE_TRIANGLES,
+    SCENE_POLYGON,
+    SCENE_FILL_POLYGON,
+    SCENE_TEXT,
+    SCENE_FLOOD,
+    SCENE_BOUNDARY,
+} SceneOp;
+
+/**
+ * @brief Loads a scene file, binary or text
+ *
+ * Files starting with "RSCN" are mapped into memory and checked record by
+ * record, everything else is parsed as text.
+ *
+ * @param path Path of the scene file
+ * @param message Receives a description of the first error, may be NULL
+ * @param message_size Size of `message` in bytes
+ * @return The scene, or NULL if the file could not be read or is invalid
+ */
+Scene *scene_load(const char *path, char *message, size_t message_size);
+
+/**
+ * @brief Parses a scene in the text format from memory
+ *
+ * @param text Scene text, need not be NUL-terminated
+ * @param size Length of `text` in bytes
+ * @param message Receives a description of the first error with its line number, may be NULL
+ * @param message_size Size of `message` in bytes
+ * @return The scene, or NULL if the text is invalid or the allocation failed
+ */
+Scene *scene_parse(const char *text, size_t size, char *message, size_t message_size);
+
+/**
+ * @brief Releases a scene and unmaps its file
+ *
+ * @param scene Scene, may be NULL
+ */
+void scene_destroy(Scene *scene);
+
+/**
+ * @brief Returns the width of the image of the scene in pixels
+ *
+ */
+int32_t scene_width(const Scene *scene);
+
+/**
+ * @brief Returns the height of the image of the scene in pixels
+ *
+ */
+int32_t scene_height(const Scene *scene);
+
+/**
+ * @brief Draws the scene into a pixmap
+ *
+ * The pixmap starts with its current contents, clip rectangle and blend
+ * mode, which the scene's commands change as they go. Text is drawn with the
+ * built-in font.
+ *
+ * @param scene Scene
+ * @param pixmap Target pixmap, usually of the scene's size
+ * @return false if the font for text commands could not be created
+ */
+bool scene_render(const Scene *scene, Pixmap *pixmap);
+
+/**
+ * @brief Writes the scene in the binary format
+ *
+ * Text scenes are compiled this way once, to be mapped on every later load.
+ *
+ * @param scene Scene
+ * @param path Path of the output file, created or truncated
+ * @return false if the file could not be written
+ */
+bool scene_save(const Scene *scene, const char *path);
@@ -0,0 +1,43 @@
+/**
+ * @file span.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Horizontal span and rectangle fills
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Fills a horizontal run of pixels
+ *
+ * The run covers [x0, x1) on row y and is clipped against the clip rectangle, so
+ * every pixel is written exactly once without a per-pixel bounds check.
+ * If x0 > x1 the endpoints are swapped.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 First x-coordinate of the run
+ * @param x1 x-coordinate one past the end of the run
+ * @param y y-coordinate of the run
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_span(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color);
+
+/**
+ * @brief Fills an axis-aligned rectangle
+ *
+ * The rectangle is clipped against the clip rectangle. Rectangles with a
+ * non-positive width or height draw nothing.
+ *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the top-left corner
+ * @param y y-coordinate of the top-left corner
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_rect(Pixmap *pixmap, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color);
@@ -0,0 +1,131 @@
+/**
+ * @file stats.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Optional counters, timers and overdraw heatmaps for the rasterizers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Instrumentation is compiled in only when the library is built with
+ * RENDERER_STATS defined to 1 (the CMake option of the same name). Otherwise
+ * the hooks in the rasterizers compile to nothing, the counters stay zero and
+ * the exports report failure.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Primitive types the counters are kept for
+ *
+ * A call is attributed to the outermost public function, so the lines of
+ * `draw_polygon` count as polygon work. A replayed command list counts every
+ * command it draws once and a parallel fill counts once, however many bands or
+ * tiles they are split into.
+ */
+typedef enum StatPrimitive
+{
+    STAT_CLEAR,    // pixmap_clear and recorded clears
+    STAT_POINT,    // draw_point, blend_point, draw_point_thick
+    STAT_LINE,     // Every draw_line variant and draw_polyline
+    STAT_CIRCLE,   // Every draw_circle variant
+    STAT_DISC,     // fill_circle, fill_circles, fill_circle_aa
+    STAT_RECT,     // fill_span, fill_rect
+    STAT_POLYGON,  // draw_polygon, fill_polygon, fill_polygon_aa
+    STAT_TRIANGLE, // fill_triangle
+    STAT_FILL,     // flood_fill, boundary_fill and their parallel variants
+    STAT_TEXT,     // draw_text, draw_text_naive
+    STAT_PRIMITIVE_COUNT,
+} StatPrimitive;
+
+/**
+ * @brief Counters of one primitive type
+ *
+ */
+typedef struct PrimitiveStats
+{
+    uint64_t calls;     // Calls of the public functions
+    uint64_t written;   // Pixels stored or blended
+    uint64_t rejected;  // Pixels dropped by a per-pixel bounds check
+    uint64_t overdrawn; // Pixels written again since the last clear, only counted with a heatmap attached
+    uint64_t time_ns;   // Time spent inside the calls
+} PrimitiveStats;
+
+/**
+ * @brief Snapshot of all counters
+ *
+ */
+typedef struct RenderStats
+{
+    PrimitiveStats primitives[STAT_PRIMITIVE_COUNT];
+    uint64_t events;  // Trace events recorded
+    uint64_t dropped; // Trace events dropped because the buffer was full
+} RenderStats;
+
+/**
+ * @brief Returns true if the library was built with instrumentation
+ *
+ */
+bool stats_enabled(void);
+
+/**
+ * @brief Returns the name of a primitive type, such as "line"
+ *
+ */
+const char *stats_primitive_name(StatPrimitive primitive);
+
+/**
+ * @brief Sets all counters to zero and discards the recorded trace events
+ *
+ * Must not be called while other threads are drawing.
+ */
+void stats_reset(void);
+
+/**
+ * @brief Copies the counters of all threads
+ *
+ * Counters are published when a public function returns, so calls still in
+ * progress on other threads are not included.
+ *
+ * @param stats Receives the counters, all zero without instrumentation
+ */
+void stats_snapshot(RenderStats *stats);
+
+/**
+ * @brief Writes the recorded events as a Chrome trace-event JSON file
+ *
+ * Every top-level primitive call becomes a complete event in the "rasterize"
+ * category, next to "clear", "export" and "replay" events, one track per
+ * thread. The file loads in chrome://tracing and Perfetto, and also carries the
+ * counters under "otherData".
+ *
+ * @param path Output file
+ * @return false without instrumentation or if the file could not be written
+ */
+bool stats_export_trace(const char *path);
+
+/**
+ * @brief Starts counting the writes of every pixel of a pixmap
+ *
+ * Writes are counted per pixel until the pixmap is cleared, which also enables
+ * the overdraw counters. Only one pixmap can be watched at a time, attaching
+ * another one replaces it.
+ *
+ * @param pixmap Pixmap to watch, NULL to stop watching
+ * @return false without instrumentation or if the counts could not be allocated
+ */
+bool stats_heatmap_attach(const Pixmap *pixmap);
+
+/**
+ * @brief Renders the write counts of the watched pixmap as colors
+ *
+ * Pixels never written are black, pixels written once are blue, and more
+ * writes shift the color over green and yellow to red at 8 writes and more.
+ * The whole target is marked as changed for the dirty tracking.
+ *
+ * @param target Pixmap of the same size as the watched one, the clip rectangle is ignored
+ * @return false without instrumentation, without a watched pixmap or if the sizes differ
+ */
+bool stats_heatmap_render(Pixmap *target);
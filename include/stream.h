@@ -0,0 +1,99 @@
+/**
+ * @file stream.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Frame sequences written by a background thread while the next frame renders
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Output formats of a frame stream
+ *
+ */
+typedef enum StreamFormat
+{
+    STREAM_Y4M,  // YUV4MPEG2 with 4:2:0 BT.601 studio range planes, read by ffmpeg, x264 and most encoders
+    STREAM_RGBA, // Headerless frames of bytes in R, G, B, A order, as IMAGE_RGBA
+} StreamFormat;
+
+/**
+ * @brief A sequence of frames converted and written by a background thread
+ *
+ * The stream owns `depth + 1` pixmaps. While the caller renders frame N into
+ * one of them, the writer thread converts and writes the frames submitted
+ * before, so rendering and output overlap instead of taking turns. While the
+ * writer is busy with one frame, at most `depth` more wait in its queue: once
+ * all pixmaps are queued or being written, `frame_stream_begin` blocks until
+ * the writer has finished one, so a slow consumer throttles the renderer
+ * instead of memory growing without bound.
+ *
+ * As with IMAGE_PPM, alpha is dropped from Y4M frames, so translucent pixels
+ * appear composited over black. A stream is used from one thread at a time.
+ */
+typedef struct FrameStream FrameStream;
+
+/**
+ * @brief Starts a stream writing to an already open file descriptor
+ *
+ * The descriptor is written sequentially and is not closed, so stdout, pipes
+ * into an encoder and sockets work as well as regular files.
+ *
+ * @param fd Writable file descriptor
+ * @param width Width of every frame in pixels, must be positive
+ * @param height Height of every frame in pixels, must be positive
+ * @param format Output format
+ * @param fps Frames per second recorded in the Y4M header, ignored by STREAM_RGBA
+ * @param depth Frames that may wait for the writer, 1 for plain double buffering
+ * @return The stream, or NULL if the arguments are invalid or the frames could not be allocated
+ */
+FrameStream *frame_stream_open_fd(int fd, int32_t width, int32_t height, StreamFormat format, int32_t fps, int32_t depth);
+
+/**
+ * @brief Starts a stream writing to a file, which is created or truncated
+ *
+ * @return The stream, or NULL if the file could not be opened, see `frame_stream_open_fd`
+ */
+FrameStream *frame_stream_open_file(const char *path, int32_t width, int32_t height, StreamFormat format, int32_t fps,
+                                    int32_t depth);
+
+/**
+ * @brief Returns a pixmap to render the next frame into
+ *
+ * Blocks while every pixmap of the stream is queued or being written. The
+ * pixmap still holds the frame it carried `depth + 1` frames ago, so the
+ * caller clears it or draws every pixel. Its clip rectangle, blend mode and
+ * dirty tracking are left as the caller set them.
+ *
+ * @param stream Stream
+ * @return Pixmap to pass to `frame_stream_submit`
+ */
+Pixmap *frame_stream_begin(FrameStream *stream);
+
+/**
+ * @brief Queues a rendered frame for writing and returns immediately
+ *
+ * The pixmap belongs to the stream again and must not be drawn into anymore.
+ *
+ * @param stream Stream
+ * @param frame Pixmap returned by the last `frame_stream_begin`
+ * @return false if writing an earlier frame failed, the frame is then dropped
+ */
+bool frame_stream_submit(FrameStream *stream, Pixmap *frame);
+
+/**
+ * @brief Writes the queued frames, stops the writer thread and releases the stream
+ *
+ * A file opened by `frame_stream_open_file` is closed, a descriptor passed to
+ * `frame_stream_open_fd` is not.
+ *
+ * @param stream Stream, may be NULL
+ * @return false if any write failed
+ */
+bool frame_stream_close(FrameStream *stream);
@@ -0,0 +1,542 @@
+/**
+ * @file surface.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Render surfaces specialized at compile time on pixel format and dimensions
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * A Pixmap always stores 32-bit RGBA pixels and carries its size at runtime. A
+ * `Surface<Format, Width, Height>` stores pixels in the native size of its
+ * format instead, so masks and thumbnails in 8- or 16-bit formats need a
+ * quarter or half of the memory and bandwidth. Given non-zero dimensions the
+ * stride becomes a compile-time constant and every address computation folds.
+ *
+ * Surfaces are C++ only and header-only: each primitive is a template
+ * instantiated per surface type. Primitives take a pixel already in the
+ * surface's format (see the `encode` functions of the format traits) and store
+ * it without blending. Their rasterization is identical to the Pixmap
+ * functions of the same name, so a scene renders to the same pixels in every
+ * format. `surface_to_pixmap` converts the result for export.
+ */
+#pragma once
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clip.h"
+#include "defs.h"
+#include "pixmap.h"
+#include "rmath.h"
+
+/**
+ * @brief 32-bit pixels in 0xRRGGBBAA order, the format of Pixmap
+ *
+ */
+struct FormatRGBA8888
+{
+    typedef uint32_t Pixel;
+    static constexpr bool INDEXED = false;
+
+    static constexpr Pixel encode(uint32_t color)
+    {
+        return color;
+    }
+
+    static constexpr uint32_t decode(Pixel pixel, const uint32_t *palette)
+    {
+        return (void)palette, pixel;
+    }
+};
+
+/**
+ * @brief 32-bit pixels in 0xBBGGRRAA order, as expected by most display servers
+ *
+ */
+struct FormatBGRA8888
+{
+    typedef uint32_t Pixel;
+    static constexpr bool INDEXED = false;
+
+    static constexpr Pixel encode(uint32_t color)
+    {
+        return (color & 0x00FF00FFu) | ((color >> 16) & 0x0000FF00u) | ((color << 16) & 0xFF000000u);
+    }
+
+    static constexpr uint32_t decode(Pixel pixel, const uint32_t *palette)
+    {
+        return (void)palette, encode(pixel); // Swapping red and blue is its own inverse
+    }
+};
+
+/**
+ * @brief 16-bit pixels with 5 bits red, 6 bits green and 5 bits blue, without alpha
+ *
+ */
+struct FormatRGB565
+{
+    typedef uint16_t Pixel;
+    static constexpr bool INDEXED = false;
+
+    static constexpr Pixel encode(uint32_t color)
+    {
+        return (Pixel)(((color >> 16) & 0xF800u) | ((color >> 13) & 0x07E0u) | ((color >> 11) & 0x001Fu));
+    }
+
+    static constexpr uint32_t decode(Pixel pixel, const uint32_t *palette)
+    {
+        // Channels are widened by repeating their top bits, so 0 and full intensity map exactly
+        return (void)palette, ((uint32_t)(((pixel >> 11) << 3) | (pixel >> 13)) << 24) |
+                                  ((uint32_t)(((pixel >> 5 & 0x3F) << 2) | (pixel >> 9 & 0x03)) << 16) |
+                                  ((uint32_t)(((pixel & 0x1F) << 3) | (pixel >> 2 & 0x07)) << 8) | 0xFFu;
+    }
+};
+
+/**
+ * @brief 8-bit gray levels, used for coverage masks
+ *
+ * Colors are reduced to their luma with the Rec. 601 weights, alpha is dropped.
+ */
+struct FormatGray8
+{
+    typedef uint8_t Pixel;
+    static constexpr bool INDEXED = false;
+
+    static constexpr Pixel encode(uint32_t color)
+    {
+        return (Pixel)((77 * (color >> 24) + 150 * (color >> 16 & 0xFF) + 29 * (color >> 8 & 0xFF) + 128) >> 8);
+    }
+
+    static constexpr uint32_t decode(Pixel pixel, const uint32_t *palette)
+    {
+        return (void)palette, (uint32_t)pixel * 0x01010100u | 0xFFu;
+    }
+};
+
+/**
+ * @brief 8-bit indices into a palette of up to 256 RGBA colors
+ *
+ * Primitives take the index itself, the palette is only needed for conversion.
+ */
+struct FormatIndex8
+{
+    typedef uint8_t Pixel;
+    static constexpr bool INDEXED = true;
+
+    static uint32_t decode(Pixel pixel, const uint32_t *palette)
+    {
+        return palette[pixel];
+    }
+};
+
+/**
+ * @brief A render target whose pixel format, and optionally size, are fixed at compile time
+ *
+ * With `Width` and `Height` of 0 the dimensions are chosen by `surface_create`.
+ * Otherwise they are constants and `surface_create` only accepts exactly them.
+ * Rows start on PIXMAP_ALIGNMENT boundaries as in a Pixmap.
+ */
+template <typename Format, int32_t Width = 0, int32_t Height = 0>
+struct Surface
+{
+    typedef Format PixelFormat;
+    typedef typename Format::Pixel Pixel;
+
+    static_assert(Width >= 0 && Height >= 0 && (Width > 0) == (Height > 0),
+                  "Surface dimensions must be both positive or both 0");
+
+    static constexpr int32_t ROW_ALIGNMENT = (int32_t)(PIXMAP_ALIGNMENT / sizeof(Pixel)); // In pixels
+    static constexpr int32_t STATIC_WIDTH = Width;
+    static constexpr int32_t STATIC_HEIGHT = Height;
+    static constexpr int32_t STATIC_STRIDE = (int32_t)(((int64_t)Width + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT);
+
+    Pixel *pixels;          // First pixel of row 0
+    int32_t dynamic_width;  // Visible width, only read when `Width` is 0
+    int32_t dynamic_height; // Visible height, only read when `Height` is 0
+    int32_t dynamic_stride; // Distance between two rows in pixels, only read when `Width` is 0
+    Rect clip;              // Pixels that primitives may write
+
+    constexpr int32_t width() const
+    {
+        return Width > 0 ? Width : dynamic_width;
+    }
+
+    constexpr int32_t height() const
+    {
+        return Height > 0 ? Height : dynamic_height;
+    }
+
+    constexpr size_t stride() const
+    {
+        return (size_t)(Width > 0 ? STATIC_STRIDE : dynamic_stride);
+    }
+
+    Pixel *row(int32_t y) const
+    {
+        return pixels + (size_t)y * stride();
+    }
+};
+
+/**
+ * @brief Allocates memory aligned to `PIXMAP_ALIGNMENT` bytes
+ *
+ * @param size Number of bytes, must be a multiple of `PIXMAP_ALIGNMENT`
+ * @return Pointer to the memory or NULL on failure
+ */
+static inline void *surface_aligned_malloc(size_t size)
+{
+#ifdef _MSC_VER
+    return _aligned_malloc(size, PIXMAP_ALIGNMENT);
+#else
+    return aligned_alloc(PIXMAP_ALIGNMENT, size);
+#endif
+}
+
+/**
+ * @brief Releases memory obtained from `surface_aligned_malloc`
+ *
+ * @param ptr Pointer to the memory, may be NULL
+ */
+static inline void surface_aligned_free(void *ptr)
+{
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+/**
+ * @brief Creates a surface
+ *
+ * The pixel contents are undefined until the surface is cleared.
+ *
+ * @tparam S Surface type
+ * @param width Width in pixels, defaults to and must equal the static width if there is one
+ * @param height Height in pixels, defaults to and must equal the static height if there is one
+ * @return The new surface, or NULL if the dimensions are invalid or the allocation failed
+ */
+template <typename S>
+S *surface_create(int32_t width = S::STATIC_WIDTH, int32_t height = S::STATIC_HEIGHT)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+    if (S::STATIC_WIDTH > 0 && (width != S::STATIC_WIDTH || height != S::STATIC_HEIGHT))
+        return NULL;
+
+    int64_t stride = ((int64_t)width + S::ROW_ALIGNMENT - 1) / S::ROW_ALIGNMENT * S::ROW_ALIGNMENT;
+    size_t row_bytes = (size_t)stride * sizeof(typename S::Pixel);
+    if (stride > INT32_MAX || (size_t)height > SIZE_MAX / row_bytes)
+        return NULL;
+
+    S *surface = (S *)malloc(sizeof(S));
+    if (surface == NULL)
+        return NULL;
+
+    surface->pixels = (typename S::Pixel *)surface_aligned_malloc(row_bytes * (size_t)height);
+    if (surface->pixels == NULL)
+    {
+        free(surface);
+        return NULL;
+    }
+
+    surface->dynamic_width = width;
+    surface->dynamic_height = height;
+    surface->dynamic_stride = (int32_t)stride;
+    surface->clip = Rect{0, 0, width, height};
+    return surface;
+}
+
+/**
+ * @brief Releases a surface and its pixel storage
+ *
+ * @param surface Surface created by `surface_create`, may be NULL
+ */
+template <typename S>
+void surface_destroy(S *surface)
+{
+    if (surface == NULL)
+        return;
+    surface_aligned_free(surface->pixels);
+    free(surface);
+}
+
+/**
+ * @brief Restricts all following primitives to a rectangle, see `pixmap_set_clip`
+ *
+ */
+template <typename S>
+void surface_set_clip(S *surface, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    int64_t w = surface->width(), h = surface->height();
+    int64_t x0 = x < 0 ? 0 : (x > w ? w : x);
+    int64_t y0 = y < 0 ? 0 : (y > h ? h : y);
+    int64_t x1 = (int64_t)x + (width > 0 ? width : 0);
+    int64_t y1 = (int64_t)y + (height > 0 ? height : 0);
+    x1 = x1 < x0 ? x0 : (x1 > w ? w : x1);
+    y1 = y1 < y0 ? y0 : (y1 > h ? h : y1);
+    surface->clip = Rect{(int32_t)x0, (int32_t)y0, (int32_t)x1, (int32_t)y1};
+}
+
+/**
+ * @brief Resets the clip rectangle to the whole surface
+ *
+ */
+template <typename S>
+void surface_reset_clip(S *surface)
+{
+    surface->clip = Rect{0, 0, surface->width(), surface->height()};
+}
+
+/**
+ * @brief Stores `count` copies of a pixel, the inner loop of every primitive
+ *
+ * 8-bit formats use memset, wider ones a loop the compiler vectorizes.
+ */
+template <typename Pixel>
+static inline void surface_store_run(Pixel *dst, size_t count, Pixel value)
+{
+    if (sizeof(Pixel) == 1)
+    {
+        memset(dst, (int)value, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+        dst[i] = value;
+}
+
+/**
+ * @brief Sets every pixel, including the row padding, ignoring the clip rectangle
+ *
+ */
+template <typename S>
+void surface_clear(S *surface, typename S::Pixel value)
+{
+    surface_store_run(surface->pixels, surface->stride() * (size_t)surface->height(), value);
+}
+
+/**
+ * @brief Sets a single pixel if it lies inside the clip rectangle
+ *
+ */
+template <typename S>
+void surface_draw_point(S *surface, int32_t x, int32_t y, typename S::Pixel value)
+{
+    const Rect *clip = &surface->clip;
+    if (x >= clip->x0 && x < clip->x1 && y >= clip->y0 && y < clip->y1)
+        surface->row(y)[x] = value;
+}
+
+/**
+ * @brief Fills [x0, x1) on row y, see `fill_span`
+ *
+ */
+template <typename S>
+void surface_fill_span(S *surface, int32_t x0, int32_t x1, int32_t y, typename S::Pixel value)
+{
+    const Rect *clip = &surface->clip;
+    if (x0 > x1)
+    {
+        int32_t t = x0;
+        x0 = x1;
+        x1 = t;
+    }
+    if (y < clip->y0 || y >= clip->y1)
+        return;
+    x0 = x0 < clip->x0 ? clip->x0 : x0;
+    x1 = x1 > clip->x1 ? clip->x1 : x1;
+    if (x0 < x1)
+        surface_store_run(surface->row(y) + x0, (size_t)(x1 - x0), value);
+}
+
+/**
+ * @brief Fills an axis-aligned rectangle, see `fill_rect`
+ *
+ */
+template <typename S>
+void surface_fill_rect(S *surface, int32_t x, int32_t y, int32_t width, int32_t height, typename S::Pixel value)
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    const Rect *clip = &surface->clip;
+    int64_t x0 = x > clip->x0 ? x : clip->x0;
+    int64_t y0 = y > clip->y0 ? y : clip->y0;
+    int64_t x1 = (int64_t)x + width < clip->x1 ? (int64_t)x + width : clip->x1;
+    int64_t y1 = (int64_t)y + height < clip->y1 ? (int64_t)y + height : clip->y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int64_t row = y0; row < y1; row++)
+        surface_store_run(surface->row((int32_t)row) + x0, (size_t)(x1 - x0), value);
+}
+
+/**
+ * @brief Draws a line with Bresenham's algorithm, see `draw_line_bresenham`
+ *
+ * Only the steps inside the clip rectangle are walked, found with
+ * `clip_bresenham`, so long lines that are mostly offscreen stay cheap.
+ */
+template <typename S>
+void surface_draw_line(S *surface, int32_t x0, int32_t y0, int32_t x1, int32_t y1, typename S::Pixel value)
+{
+    const Rect *clip = &surface->clip;
+    if (y0 == y1)
+    {
+        surface_fill_span(surface, x0, x1, y0, value);
+        surface_draw_point(surface, x0 > x1 ? x0 : x1, y0, value);
+        return;
+    }
+    if ((clip_outcode(clip, x0, y0) & clip_outcode(clip, x1, y1)) != 0)
+        return;
+
+    bool steep = llabs((int64_t)y1 - y0) > llabs((int64_t)x1 - x0);
+    int64_t u0 = steep ? y0 : x0, v0 = steep ? x0 : y0;
+    int64_t u1 = steep ? y1 : x1, v1 = steep ? x1 : y1;
+    if (u0 > u1)
+    {
+        int64_t t = u0;
+        u0 = u1;
+        u1 = t;
+        t = v0;
+        v0 = v1;
+        v1 = t;
+    }
+
+    int64_t du = u1 - u0;
+    int64_t dv = llabs(v1 - v0);
+    int64_t sv = v1 >= v0 ? 1 : -1;
+    Rect bounds = steep ? Rect{clip->y0, clip->x0, clip->y1, clip->x1} : *clip;
+    int64_t first, last;
+    if (!clip_bresenham(&bounds, u0, v0, du, dv, sv, &first, &last))
+        return;
+
+    uint64_t remainder;
+    int64_t e = (int64_t)mul_div_u64((uint64_t)(2 * dv), (uint64_t)first, (uint64_t)du, (uint64_t)(2 * du), &remainder);
+    int64_t D = (int64_t)remainder + 2 * dv - 2 * du;
+
+    // Steps along the major axis and the minor axis as pointer offsets
+    ptrdiff_t row = (ptrdiff_t)surface->stride();
+    ptrdiff_t major = steep ? row : 1;
+    ptrdiff_t minor = steep ? (ptrdiff_t)sv : (ptrdiff_t)sv * row;
+    int64_t u = u0 + first, v = v0 + sv * e;
+    typename S::Pixel *p = steep ? surface->row((int32_t)u) + v : surface->row((int32_t)v) + u;
+    for (int64_t k = first; k <= last; k++)
+    {
+        *p = value;
+        p += major;
+        if (D < 0)
+            D += 2 * dv;
+        else
+        {
+            p += minor;
+            D += 2 * (dv - du);
+        }
+    }
+}
+
+/**
+ * @brief Fills a disc, see `fill_circle`
+ *
+ * Pixel (x, y) is covered if (x - cx)² + (y - cy)² <= r² + r.
+ */
+template <typename S>
+void surface_fill_circle(S *surface, int32_t cx, int32_t cy, int32_t r, typename S::Pixel value)
+{
+    if (r < 0)
+        return;
+
+    const Rect *clip = &surface->clip;
+    if (clip_bounds(clip, (int64_t)cx - r, (int64_t)cy - r, (int64_t)cx + r, (int64_t)cy + r) == CLIP_REJECT)
+        return;
+
+    int64_t limit = (int64_t)r * r + r;
+    int64_t top = (int64_t)cy - r > clip->y0 ? (int64_t)cy - r : clip->y0;
+    int64_t bottom = (int64_t)cy + r < clip->y1 - 1 ? (int64_t)cy + r : clip->y1 - 1;
+    for (int64_t y = top; y <= bottom; y++)
+    {
+        int64_t dy = y - cy;
+        int64_t remaining = limit - dy * dy;
+        int64_t hw = (int64_t)sqrt((double)remaining);
+        while (hw * hw > remaining)
+            hw--;
+        while ((hw + 1) * (hw + 1) <= remaining)
+            hw++;
+
+        int64_t x0 = (int64_t)cx - hw > clip->x0 ? (int64_t)cx - hw : clip->x0;
+        int64_t x1 = (int64_t)cx + hw + 1 < clip->x1 ? (int64_t)cx + hw + 1 : clip->x1;
+        if (x0 < x1)
+            surface_store_run(surface->row((int32_t)y) + x0, (size_t)(x1 - x0), value);
+    }
+}
+
+/**
+ * @brief Converts a surface to RGBA, for example to export it
+ *
+ * Pixels are decoded to straight colors and stored premultiplied, like the
+ * pixmap primitives store them, and the whole pixmap is marked as changed for
+ * the dirty tracking. The clip rectangle and blend mode are ignored.
+ *
+ * @param surface Source surface
+ * @param pixmap Target pixmap of the same size, in any layout
+ * @param palette 256 colors for FormatIndex8, ignored by every other format
+ * @return false if the sizes differ, an indexed surface has no palette or the row buffer could not be allocated
+ */
+template <typename S>
+bool surface_to_pixmap(const S *surface, Pixmap *pixmap, const uint32_t *palette = NULL)
+{
+    if (pixmap->width != surface->width() || pixmap->height != surface->height())
+        return false;
+    if (S::PixelFormat::INDEXED && palette == NULL)
+        return false;
+
+    uint32_t *colors = (uint32_t *)malloc((size_t)pixmap->width * sizeof(uint32_t));
+    if (colors == NULL)
+        return false;
+    for (int32_t y = 0; y < pixmap->height; y++)
+    {
+        const typename S::Pixel *src = surface->row(y);
+        for (int32_t x = 0; x < pixmap->width; x++)
+            colors[x] = S::PixelFormat::decode(src[x], palette);
+        pixmap_write_rows(pixmap, y, 1, colors, (size_t)pixmap->width);
+    }
+    free(colors);
+    return true;
+}
+
+/**
+ * @brief Converts an RGBA pixmap to the format of a surface, for example to keep a thumbnail
+ *
+ * The premultiplied pixels are converted back to straight colors before they
+ * are encoded. Not available for indexed formats, which would need a palette
+ * search.
+ *
+ * @param surface Target surface of the same size
+ * @param pixmap Source pixmap
+ * @return false if the sizes differ
+ */
+template <typename S>
+bool surface_from_pixmap(S *surface, const Pixmap *pixmap)
+{
+    static_assert(!S::PixelFormat::INDEXED, "Indexed surfaces cannot be converted from RGBA");
+    if (pixmap->width != surface->width() || pixmap->height != surface->height())
+        return false;
+
+    for (int32_t y = 0; y < pixmap->height; y++)
+    {
+        typename S::Pixel *dst = surface->row(y);
+        if (pixmap->layout != LAYOUT_LINEAR)
+        {
+            for (int32_t x = 0; x < pixmap->width; x++)
+                dst[x] = S::PixelFormat::encode(color_unpremultiply(pixmap_get_pixel(pixmap, x, y)));
+            continue;
+        }
+        const uint32_t *src = pixmap->pixels + (size_t)y * (size_t)pixmap->stride;
+        for (int32_t x = 0; x < pixmap->width; x++)
+            dst[x] = S::PixelFormat::encode(color_unpremultiply(src[x]));
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file text.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Bitmap fonts and text drawn from a pre-converted glyph atlas
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief A bitmap font together with its glyph atlas and cache
+ *
+ * When a font is created, every glyph is converted once into an 8-bit coverage
+ * mask in the font's atlas. Text drawn at another size uses glyphs resampled
+ * from the atlas with a box filter, which are kept in a least-recently-used
+ * cache of (glyph, size) pairs, so every glyph and size is converted only once
+ * as long as it is used regularly.
+ *
+ * Fonts cover the code points 0 to 255 (ASCII and Latin-1). Text is UTF-8, and
+ * code points without a glyph are drawn with the font's default glyph. A font
+ * may be used by several threads at once, the cache is locked while a line
+ * of text is drawn.
+ */
+typedef struct Font Font;
+
+/**
+ * @brief Creates the built-in font
+ *
+ * The font has 5x7 pixel capitals with two rows for descenders on a 6x10
+ * pixel cell and covers the printable ASCII characters.
+ *
+ * @return The font, or NULL if the allocation failed
+ */
+Font *font_create(void);
+
+/**
+ * @brief Loads a bitmap font rasterized offline from a BDF file
+ *
+ * BDF (Glyph Bitmap Distribution Format) is the plain text format most bitmap
+ * fonts are distributed in, and also what tools such as otf2bdf produce from
+ * outline fonts at a given size. Glyphs with an encoding above 255 are skipped,
+ * as are glyphs whose bounding box is larger or further from the origin than
+ * 1024 pixels. Scaled glyphs that need more than 1 MiB of coverage are not drawn.
+ *
+ * @param path Path of the .bdf file
+ * @return The font, or NULL if the file could not be read or parsed
+ */
+Font *font_load_bdf(const char *path);
+
+/**
+ * @brief Releases a font, its atlas and its cache
+ *
+ * @param font Font created by `font_create` or `font_load_bdf`, may be NULL
+ */
+void font_destroy(Font *font);
+
+/**
+ * @brief Returns the line height of the font at its native size in pixels
+ *
+ * Text drawn at this size is copied from the atlas without resampling.
+ */
+int32_t font_height(const Font *font);
+
+/**
+ * @brief Measures the width of text in pixels
+ *
+ * @param font Font of the text
+ * @param size Line height in pixels
+ * @param text UTF-8 text, lines are separated by '\n'
+ * @return Advance width of the longest line
+ */
+int32_t text_width(const Font *font, int32_t size, const char *text);
+
+/**
+ * @brief Draws text with glyphs from the font's atlas
+ *
+ * Each line is composed into a coverage mask from the cached glyphs first,
+ * then blended into the pixmap row by row with one vectorized coverage kernel
+ * call per row, so the cost per glyph is a copy and not a rasterization.
+ * Partly covered pixels are blended according to the blend mode of the
+ * pixmap, BLEND_NONE composites like BLEND_SRC_OVER.
+ *
+ * @param pixmap Target pixmap
+ * @param font Font of the text
+ * @param x x-coordinate of the left edge of the first character
+ * @param y y-coordinate of the top of the first line
+ * @param size Line height in pixels, from 1 to 1024
+ * @param text UTF-8 text, lines are separated by '\n' and start `size` pixels apart
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_text(Pixmap *pixmap, Font *font, int32_t x, int32_t y, int32_t size, const char *text, uint32_t color);
+
+/**
+ * @brief Draws text by resampling every glyph pixel by pixel, without atlas or cache
+ *
+ * The naive counterpart of `draw_text`: every call samples the glyph bitmaps
+ * again and blends one pixel at a time. It produces the same pixels as
+ * `draw_text` as long as the glyphs do not overlap, and is mainly useful as a
+ * reference and for comparison.
+ *
+ * @param pixmap Target pixmap
+ * @param font Font of the text
+ * @param x x-coordinate of the left edge of the first character
+ * @param y y-coordinate of the top of the first line
+ * @param size Line height in pixels, from 1 to 1024
+ * @param text UTF-8 text, lines are separated by '\n' and start `size` pixels apart
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void draw_text_naive(Pixmap *pixmap, const Font *font, int32_t x, int32_t y, int32_t size, const char *text, uint32_t color);
@@ -0,0 +1,35 @@
+/**
+ * @file triangle.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Filled triangles
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "pixmap.h"
+
+/**
+ * @brief Fills a triangle
+ *
+ * Pixels are tested against the three edge functions of the triangle, in
+ * 8x8 blocks which are rejected or accepted as a whole where possible.
+ * Partially covered blocks are evaluated 8 pixels at a time with SIMD.
+ *
+ * The covered pixels follow the top-left rule and are exactly those of
+ * `fill_polygon` with the same three vertices, so triangles sharing an edge
+ * neither overlap nor leave gaps. The winding order does not matter.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 x-coordinate of the first vertex
+ * @param y0 y-coordinate of the first vertex
+ * @param x1 x-coordinate of the second vertex
+ * @param y1 y-coordinate of the second vertex
+ * @param x2 x-coordinate of the third vertex
+ * @param y2 y-coordinate of the third vertex
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+void fill_triangle(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
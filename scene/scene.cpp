@@ -0,0 +1,158 @@
+/**
+ * @file scene.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Renders scene files into images from the command line
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Usage: RendererScene scene [-o image] [--compile path] [--layout name] [--time]
+ *
+ * The scene is a text or binary scene file (see include/scene.h). The image
+ * format follows the extension of the output path: .png, .ppm, .rgba or .raw,
+ * PPM otherwise. --compile writes the scene in the binary format, to be
+ * mapped instead of parsed on later runs, and renders only if -o is given as
+ * well. --time prints the load, render and export times to stderr.
+ */
+
+#include <renderer.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Picks the image format from the extension of the output path
+ *
+ */
+static ImageFormat output_format(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    if (dot == NULL)
+        return IMAGE_PPM;
+    if (strcmp(dot, ".png") == 0)
+        return IMAGE_PNG;
+    if (strcmp(dot, ".rgba") == 0)
+        return IMAGE_RGBA;
+    if (strcmp(dot, ".raw") == 0)
+        return IMAGE_RAW;
+    return IMAGE_PPM;
+}
+
+static bool layout_parse(const char *name, PixmapLayout *layout)
+{
+    static const struct
+    {
+        const char *name;
+        PixmapLayout layout;
+    } layouts[] = {
+        {"linear", LAYOUT_LINEAR},
+        {"tiled8", LAYOUT_TILED8},
+        {"tiled16", LAYOUT_TILED16},
+        {"morton8", LAYOUT_MORTON8},
+        {"morton16", LAYOUT_MORTON16},
+    };
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++)
+        if (strcmp(layouts[i].name, name) == 0)
+        {
+            *layout = layouts[i].layout;
+            return true;
+        }
+    return false;
+}
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s scene [-o image] [--compile path] [--layout name] [--time]\n", program);
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *compile = NULL;
+    PixmapLayout layout = LAYOUT_LINEAR;
+    bool timing = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && has_value)
+            output = argv[++i];
+        else if (strcmp(argv[i], "--compile") == 0 && has_value)
+            compile = argv[++i];
+        else if (strcmp(argv[i], "--layout") == 0 && has_value && layout_parse(argv[i + 1], &layout))
+            i++;
+        else if (strcmp(argv[i], "--time") == 0)
+            timing = true;
+        else if (argv[i][0] != '-' && input == NULL)
+            input = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (input == NULL)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (output == NULL && compile == NULL)
+        output = "scene.ppm";
+
+    auto start = std::chrono::steady_clock::now();
+    char message[256] = "";
+    Scene *scene = scene_load(input, message, sizeof(message));
+    if (scene == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", input, message);
+        return 1;
+    }
+    if (timing)
+        fprintf(stderr, "load     %10.2f ms\n", milliseconds_since(start));
+
+    int status = 0;
+    if (compile != NULL && !scene_save(scene, compile))
+    {
+        fprintf(stderr, "could not write %s\n", compile);
+        status = 1;
+    }
+
+    if (output != NULL && status == 0)
+    {
+        Pixmap *pixmap = pixmap_create_layout(scene_width(scene), scene_height(scene), layout);
+        if (pixmap == NULL)
+        {
+            fprintf(stderr, "could not allocate a %dx%d image\n", scene_width(scene), scene_height(scene));
+            scene_destroy(scene);
+            return 1;
+        }
+
+        // Scenes draw onto transparent black unless they clear first
+        pixmap_clear(pixmap, 0);
+        start = std::chrono::steady_clock::now();
+        if (!scene_render(scene, pixmap))
+            status = 1;
+        if (timing)
+            fprintf(stderr, "render   %10.2f ms\n", milliseconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        if (!pixmap_export_file(pixmap, output, output_format(output)))
+        {
+            fprintf(stderr, "could not write %s\n", output);
+            status = 1;
+        }
+        if (timing)
+            fprintf(stderr, "export   %10.2f ms\n", milliseconds_since(start));
+        pixmap_destroy(pixmap);
+    }
+
+    scene_destroy(scene);
+    return status;
+}
@@ -0,0 +1,355 @@
+/**
+ * @file antialias.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <antialias.h>
+
+#include "raster.h"
+#include "scan.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+    AA_LOCAL_COLUMNS = 256, // Bounding boxes up to this wide need no allocation
+    AA_INSERTION_SORT = 32, // Rows with up to this many changes are sorted by insertion
+};
+
+/**
+ * @brief Column of the sample on every sample row, from the standard MSAA patterns
+ *
+ * Sample k of an n-sample pixel lies at ((column + 1/2) / n, (k + 1/2) / n)
+ * inside the pixel.
+ */
+static const uint8_t aa_pattern_4[4] = {1, 3, 0, 2};
+static const uint8_t aa_pattern_8[8] = {7, 2, 4, 0, 6, 3, 1, 5};
+static const uint8_t aa_pattern_16[16] = {1, 8, 4, 11, 15, 7, 3, 12, 0, 9, 5, 13, 2, 10, 6, 14};
+
+/**
+ * @brief Sample coverage of the pixel row being resolved
+ *
+ * With one sample per sample row, a sample row's span adds one sample to a
+ * run of pixels, so the coverage is stored as its change at the two ends of
+ * every span instead of as a mask per pixel. Between two columns with a
+ * change the coverage is constant: fully covered runs become plain spans,
+ * and only the pixels around the edges are blended with a coverage.
+ */
+typedef struct Coverage
+{
+    Pixmap *pixmap;
+    uint32_t color;         // As passed, for the fully covered runs
+    uint32_t premultiplied; // For the partly covered runs
+    uint32_t shift;         // log2 of the samples per pixel
+    const uint8_t *pattern;
+    int32_t x0, x1;    // Columns of the bounding box
+    int32_t row;       // Pixel row being accumulated
+    int32_t *delta;    // Change of the covered samples at every column of the box and one past it
+    int32_t *touched;  // Columns with a change, relative to x0, unsorted
+    size_t changes;    // Entries in `touched`
+    uint8_t *marked;   // Set for the columns in `touched`
+    uint8_t *mask;     // Coverage bytes of the partly covered runs
+    uint8_t levels[AA_SAMPLES_16 + 1]; // Coverage byte for every number of covered samples
+} Coverage;
+
+/**
+ * @brief Bytes of per-column storage a coverage needs
+ *
+ */
+static const size_t aa_column_bytes = 2 * sizeof(int32_t) + 2 * sizeof(uint8_t);
+
+/**
+ * @brief Returns log2 of the samples per pixel, 0 if the count is not supported
+ *
+ */
+static uint32_t aa_shift(AASamples samples)
+{
+    switch (samples)
+    {
+    case AA_SAMPLES_4:
+        return 2;
+    case AA_SAMPLES_8:
+        return 3;
+    case AA_SAMPLES_16:
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prepares an empty coverage for the columns [x0, x1)
+ *
+ * @param storage At least `(x1 - x0 + 1) * aa_column_bytes` bytes, 4-byte aligned
+ */
+static void coverage_init(Coverage *coverage, Pixmap *pixmap, uint32_t shift, uint32_t color, int32_t x0, int32_t x1,
+                          void *storage)
+{
+    size_t columns = (size_t)(x1 - x0) + 1;
+    coverage->pixmap = pixmap;
+    coverage->color = color;
+    coverage->premultiplied = color_premultiply(color);
+    coverage->shift = shift;
+    coverage->pattern = shift == 2 ? aa_pattern_4 : (shift == 3 ? aa_pattern_8 : aa_pattern_16);
+    coverage->x0 = x0;
+    coverage->x1 = x1;
+    coverage->row = INT32_MIN;
+    coverage->delta = (int32_t *)storage;
+    coverage->touched = coverage->delta + columns;
+    coverage->changes = 0;
+    coverage->marked = (uint8_t *)(coverage->touched + columns);
+    coverage->mask = coverage->marked + columns;
+    memset(coverage->delta, 0, columns * sizeof(int32_t));
+    memset(coverage->marked, 0, columns);
+
+    uint32_t samples = 1u << shift;
+    for (uint32_t covered = 0; covered <= samples; covered++)
+        coverage->levels[covered] = (uint8_t)((covered * 255 + samples / 2) >> shift);
+}
+
+static inline void coverage_change(Coverage *coverage, int32_t column, int32_t amount)
+{
+    if (!coverage->marked[column])
+    {
+        coverage->marked[column] = 1;
+        coverage->touched[coverage->changes++] = column;
+    }
+    coverage->delta[column] += amount;
+}
+
+/**
+ * @brief Adds one sample to every pixel of [x0, x1), clamped to the bounding box
+ *
+ */
+static inline void coverage_span(Coverage *coverage, int64_t x0, int64_t x1)
+{
+    x0 = x0 > coverage->x0 ? x0 : coverage->x0;
+    x1 = x1 < coverage->x1 ? x1 : coverage->x1;
+    if (x0 >= x1)
+        return;
+    coverage_change(coverage, (int32_t)(x0 - coverage->x0), 1);
+    coverage_change(coverage, (int32_t)(x1 - coverage->x0), -1);
+}
+
+static int compare_columns(const void *a, const void *b)
+{
+    int32_t ca = *(const int32_t *)a;
+    int32_t cb = *(const int32_t *)b;
+    return ca < cb ? -1 : (ca > cb ? 1 : 0);
+}
+
+/**
+ * @brief Writes the accumulated row into the pixmap and empties the coverage
+ *
+ */
+static void coverage_resolve(Coverage *coverage)
+{
+    size_t count = coverage->changes;
+    if (count == 0)
+        return;
+
+    int32_t *touched = coverage->touched;
+    if (count <= AA_INSERTION_SORT)
+    {
+        for (size_t i = 1; i < count; i++)
+        {
+            int32_t column = touched[i];
+            size_t j = i;
+            for (; j > 0 && touched[j - 1] > column; j--)
+                touched[j] = touched[j - 1];
+            touched[j] = column;
+        }
+    }
+    else
+        qsort(touched, count, sizeof(int32_t), compare_columns);
+
+    Pixmap *pixmap = coverage->pixmap;
+    int32_t samples = 1 << coverage->shift;
+    int32_t x0 = coverage->x0, row = coverage->row;
+    int32_t covered = 0;
+    int32_t pending = -1; // Start of the partly covered run not yet written
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t column = touched[i];
+        covered += coverage->delta[column];
+        coverage->delta[column] = 0;
+        coverage->marked[column] = 0;
+
+        // The coverage stays the same up to the next change
+        int32_t end = i + 1 < count ? touched[i + 1] : column;
+        if (covered > 0 && covered < samples)
+        {
+            if (pending < 0)
+                pending = column;
+            memset(coverage->mask + column, coverage->levels[covered], (size_t)(end - column));
+            continue;
+        }
+        if (pending >= 0)
+        {
+            mask_store(pixmap, x0 + pending, x0 + column, row, coverage->mask + pending, coverage->premultiplied);
+            pending = -1;
+        }
+        if (covered == samples && column < end)
+            span_store(pixmap, x0 + column, x0 + end, row, coverage->color);
+    }
+    coverage->changes = 0;
+}
+
+/**
+ * @brief Receives the spans of one sample row from the scan converter
+ *
+ * Sample row y belongs to pixel row y / n. Its sample sits in column
+ * `pattern[y % n]` of the n sample columns of every pixel, so the span
+ * [x0, x1) of sample columns covers the samples of the pixels whose sample
+ * column falls inside it.
+ */
+static void coverage_emit(void *context, int32_t x0, int32_t x1, int32_t y)
+{
+    Coverage *coverage = (Coverage *)context;
+    uint32_t shift = coverage->shift;
+    int32_t row = y >> shift;
+    if (row != coverage->row)
+    {
+        coverage_resolve(coverage);
+        coverage->row = row;
+    }
+    int32_t round = (1 << shift) - 1 - coverage->pattern[y & ((1 << shift) - 1)];
+    coverage_span(coverage, (x0 + round) >> shift, (x1 + round) >> shift);
+}
+
+/**
+ * @brief Allocates the per-column storage of a coverage, unless the local buffer suffices
+ *
+ */
+static void *coverage_storage(int32_t x0, int32_t x1, void *local, size_t local_size)
+{
+    size_t size = ((size_t)(x1 - x0) + 1) * aa_column_bytes;
+    return size <= local_size ? local : malloc(size);
+}
+
+/**
+ * @brief Rounds down, without the library call of floor
+ *
+ */
+static inline int64_t aa_floor(double value)
+{
+    int64_t truncated = (int64_t)value;
+    return truncated - (value < (double)truncated);
+}
+
+static inline int32_t aa_clamp(int32_t value)
+{
+    return value < -AA_COORD_MAX ? -AA_COORD_MAX : (value > AA_COORD_MAX ? AA_COORD_MAX : value);
+}
+
+void fill_polygon_aa(Pixmap *pixmap, const Point *points, size_t count, FillRule rule, AASamples samples, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_POLYGON);
+    uint32_t shift = aa_shift(samples);
+    if (count < 3 || shift == 0)
+        return;
+
+    // Pixels touched lie between the leftmost and the rightmost vertex, both included
+    const Rect *clip = &pixmap->clip;
+    Rect box = {aa_clamp(points[0].x), aa_clamp(points[0].y), aa_clamp(points[0].x), aa_clamp(points[0].y)};
+    for (size_t i = 1; i < count; i++)
+    {
+        int32_t x = aa_clamp(points[i].x), y = aa_clamp(points[i].y);
+        box.x0 = x < box.x0 ? x : box.x0;
+        box.y0 = y < box.y0 ? y : box.y0;
+        box.x1 = x > box.x1 ? x : box.x1;
+        box.y1 = y > box.y1 ? y : box.y1;
+    }
+    box.x0 = box.x0 > clip->x0 ? box.x0 : clip->x0;
+    box.y0 = box.y0 > clip->y0 ? box.y0 : clip->y0;
+    box.x1 = box.x1 + 1 < clip->x1 ? box.x1 + 1 : clip->x1;
+    box.y1 = box.y1 + 1 < clip->y1 ? box.y1 + 1 : clip->y1;
+    if (box.x0 >= box.x1 || box.y0 >= box.y1)
+        return;
+
+    ScanPoint local_points[64];
+    ScanPoint *vertices = count <= 64 ? local_points : (ScanPoint *)malloc(count * sizeof(ScanPoint));
+    uint32_t local[AA_LOCAL_COLUMNS * 3];
+    void *storage = coverage_storage(box.x0, box.x1, local, sizeof(local));
+    if (vertices != NULL && storage != NULL)
+    {
+        // Sample column and row c of pixel p lie at p - 1/2 + (c + 1/2) / n, so pixel
+        // coordinates map to the sample grid as v * n + (n - 1) / 2
+        int64_t scale = (int64_t)SCAN_SUBPIXEL_ONE << shift;
+        int64_t center = (scale - SCAN_SUBPIXEL_ONE) / 2;
+        for (size_t i = 0; i < count; i++)
+        {
+            vertices[i].x = aa_clamp(points[i].x) * scale + center;
+            vertices[i].y = aa_clamp(points[i].y) * scale + center;
+        }
+
+        Coverage coverage;
+        coverage_init(&coverage, pixmap, shift, color, box.x0, box.x1, storage);
+        Rect grid = {box.x0 << shift, box.y0 << shift, box.x1 << shift, box.y1 << shift};
+        scan_polygon(&grid, vertices, &count, 1, rule, coverage_emit, &coverage);
+        coverage_resolve(&coverage);
+    }
+
+    if (vertices != local_points)
+        free(vertices);
+    if (storage != local)
+        free(storage);
+}
+
+void fill_circle_aa(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, AASamples samples, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_DISC);
+    uint32_t shift = aa_shift(samples);
+    if (r < 0 || shift == 0)
+        return;
+
+    // Samples within r + 1/2 of the center lie in the pixels within r of it
+    const Rect *clip = &pixmap->clip;
+    int64_t x0 = (int64_t)cx - r, x1 = (int64_t)cx + r + 1;
+    int64_t y0 = (int64_t)cy - r, y1 = (int64_t)cy + r + 1;
+    x0 = x0 > clip->x0 ? x0 : clip->x0;
+    y0 = y0 > clip->y0 ? y0 : clip->y0;
+    x1 = x1 < clip->x1 ? x1 : clip->x1;
+    y1 = y1 < clip->y1 ? y1 : clip->y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    uint32_t local[AA_LOCAL_COLUMNS * 3];
+    void *storage = coverage_storage((int32_t)x0, (int32_t)x1, local, sizeof(local));
+    if (storage == NULL)
+        return;
+    Coverage coverage;
+    coverage_init(&coverage, pixmap, shift, color, (int32_t)x0, (int32_t)x1, storage);
+
+    int32_t n = 1 << shift;
+    double radius = (double)r + 0.5;
+    // Offsets of the sample of every sample row from the pixel center
+    double dx[AA_SAMPLES_16], dy[AA_SAMPLES_16];
+    for (int32_t k = 0; k < n; k++)
+    {
+        dx[k] = ((double)coverage.pattern[k] + 0.5) / n - 0.5;
+        dy[k] = ((double)k + 0.5) / n - 0.5;
+    }
+
+    for (int64_t y = y0; y < y1; y++)
+    {
+        coverage.row = (int32_t)y;
+        for (int32_t k = 0; k < n; k++)
+        {
+            double v = (double)(y - cy) + dy[k];
+            double remaining = radius * radius - v * v;
+            if (remaining < 0)
+                continue;
+            // Pixel cx + u is covered if |u + dx| <= half-width
+            double hw = sqrt(remaining);
+            coverage_span(&coverage, (int64_t)cx - aa_floor(hw + dx[k]), (int64_t)cx + aa_floor(hw - dx[k]) + 1);
+        }
+        coverage_resolve(&coverage);
+    }
+
+    if (storage != local)
+        free(storage);
+}
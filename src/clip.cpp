@@ -0,0 +1,183 @@
+/**
+ * @file clip.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <clip.h>
+
+#include <rmath.h>
+
+#include <math.h>
+
+uint32_t clip_outcode(const Rect *rect, int32_t x, int32_t y)
+{
+    uint32_t code = CLIP_INSIDE;
+    if (x < rect->x0)
+        code |= CLIP_LEFT;
+    else if (x >= rect->x1)
+        code |= CLIP_RIGHT;
+    if (y < rect->y0)
+        code |= CLIP_TOP;
+    else if (y >= rect->y1)
+        code |= CLIP_BOTTOM;
+    return code;
+}
+
+ClipResult clip_bounds(const Rect *rect, int64_t x0, int64_t y0, int64_t x1, int64_t y1)
+{
+    if (x1 < rect->x0 || x0 >= rect->x1 || y1 < rect->y0 || y0 >= rect->y1 || x0 > x1 || y0 > y1)
+        return CLIP_REJECT;
+    if (x0 >= rect->x0 && x1 < rect->x1 && y0 >= rect->y0 && y1 < rect->y1)
+        return CLIP_ACCEPT;
+    return CLIP_PARTIAL;
+}
+
+bool clip_line(const Rect *rect, int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1)
+{
+    if (rect->x0 >= rect->x1 || rect->y0 >= rect->y1)
+        return false;
+
+    double ax = *x0, ay = *y0, bx = *x1, by = *y1;
+    double xmin = rect->x0, ymin = rect->y0;
+    double xmax = rect->x1 - 1, ymax = rect->y1 - 1;
+
+    uint32_t code_a = clip_outcode(rect, *x0, *y0);
+    uint32_t code_b = clip_outcode(rect, *x1, *y1);
+
+    // Rounding onto a corner can bounce between two edges, which only happens
+    // for lines that barely touch the rectangle
+    for (int iteration = 0;; iteration++)
+    {
+        if ((code_a | code_b) == CLIP_INSIDE) // Trivial accept
+            break;
+        if (iteration == 8)
+            return false;
+        if (code_a & code_b) // Trivial reject, both ends beyond the same edge
+            return false;
+
+        // Move the endpoint that is outside onto the edge it crosses
+        uint32_t code = code_a != CLIP_INSIDE ? code_a : code_b;
+        double x, y;
+        if (code & CLIP_TOP)
+        {
+            x = ax + (bx - ax) * (ymin - ay) / (by - ay);
+            y = ymin;
+        }
+        else if (code & CLIP_BOTTOM)
+        {
+            x = ax + (bx - ax) * (ymax - ay) / (by - ay);
+            y = ymax;
+        }
+        else if (code & CLIP_LEFT)
+        {
+            y = ay + (by - ay) * (xmin - ax) / (bx - ax);
+            x = xmin;
+        }
+        else
+        {
+            y = ay + (by - ay) * (xmax - ax) / (bx - ax);
+            x = xmax;
+        }
+
+        // Rounding can land just outside, so the outcode is recomputed on the rounded point
+        int32_t px = (int32_t)lround(fmin(fmax(x, xmin - 1), xmax + 1));
+        int32_t py = (int32_t)lround(fmin(fmax(y, ymin - 1), ymax + 1));
+        if (code == code_a)
+        {
+            ax = px, ay = py;
+            code_a = clip_outcode(rect, px, py);
+        }
+        else
+        {
+            bx = px, by = py;
+            code_b = clip_outcode(rect, px, py);
+        }
+    }
+
+    *x0 = (int32_t)ax;
+    *y0 = (int32_t)ay;
+    *x1 = (int32_t)bx;
+    *y1 = (int32_t)by;
+    return true;
+}
+
+/**
+ * @brief Narrows [t0, t1] by one boundary of the Liang-Barsky test
+ *
+ * @param p Negated direction component along the boundary normal
+ * @param q Distance of the start point from the boundary
+ * @param t0 Current start of the parameter range
+ * @param t1 Current end of the parameter range
+ * @return false if the range became empty
+ */
+static bool clip_test(double p, double q, double *t0, double *t1)
+{
+    if (p == 0)
+        return q >= 0; // Parallel to the boundary, inside or outside entirely
+
+    double t = q / p;
+    if (p < 0)
+    {
+        if (t > *t1)
+            return false;
+        if (t > *t0)
+            *t0 = t;
+    }
+    else
+    {
+        if (t < *t0)
+            return false;
+        if (t < *t1)
+            *t1 = t;
+    }
+    return true;
+}
+
+bool clip_line_liang_barsky(const Rect *rect, double x0, double y0, double x1, double y1, double *t0, double *t1)
+{
+    double xmin = rect->x0 - 0.5, ymin = rect->y0 - 0.5;
+    double xmax = rect->x1 - 0.5, ymax = rect->y1 - 0.5;
+    double dx = x1 - x0, dy = y1 - y0;
+
+    *t0 = 0.0;
+    *t1 = 1.0;
+    return clip_test(-dx, x0 - xmin, t0, t1) &&
+           clip_test(dx, xmax - x0, t0, t1) &&
+           clip_test(-dy, y0 - ymin, t0, t1) &&
+           clip_test(dy, ymax - y0, t0, t1);
+}
+
+bool clip_bresenham(const Rect *clip, int64_t u0, int64_t v0, int64_t du, int64_t dv, int64_t sv,
+                    int64_t *first, int64_t *last)
+{
+    int64_t k0 = clip->x0 - u0 > 0 ? clip->x0 - u0 : 0;
+    int64_t k1 = clip->x1 - 1 - u0 < du ? clip->x1 - 1 - u0 : du;
+
+    // Range of minor offsets e(k) that lie inside the clip rectangle
+    int64_t lo = sv > 0 ? clip->y0 - v0 : v0 - (clip->y1 - 1);
+    int64_t hi = sv > 0 ? clip->y1 - 1 - v0 : v0 - clip->y0;
+    if (hi < 0 || lo > dv || lo > hi)
+        return false;
+
+    if (dv > 0)
+    {
+        // e(k) >= lo  <=>  k >= du (2 lo - 1) / (2 dv)
+        if (lo > 0)
+        {
+            int64_t k = (int64_t)mul_div_u64((uint64_t)du, (uint64_t)(2 * lo - 1), (uint64_t)(2 * dv - 1), (uint64_t)(2 * dv), NULL);
+            k0 = k > k0 ? k : k0;
+        }
+        // e(k) <= hi  <=>  k < du (2 hi + 1) / (2 dv)
+        if (hi < dv)
+        {
+            int64_t k = (int64_t)mul_div_u64((uint64_t)du, (uint64_t)(2 * hi + 1), (uint64_t)(2 * dv - 1), (uint64_t)(2 * dv), NULL) - 1;
+            k1 = k < k1 ? k : k1;
+        }
+    }
+
+    *first = k0;
+    *last = k1;
+    return k0 <= k1;
+}
@@ -0,0 +1,1089 @@
+/**
+ * @file cmdlist.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <cmdlist.h>
+#include <span.h>
+#include <line.h>
+#include <circle.h>
+#include <point.h>
+#include <pool.h>
+
+#include "cpu.h"
+#include "raster.h"
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Sizes used by the arena and the replay
+ *
+ */
+enum
+{
+    CMD_BLOCK_SIZE = 1 << 16,  // Bytes per arena block
+    CMD_BAND_BYTES = 1 << 17,  // Target size of one band during replay
+    CMD_TILE_SIZE = 64,        // Width and height of the tiles of a parallel replay
+};
+
+/**
+ * @brief Recorded primitive types
+ *
+ */
+typedef enum CmdType
+{
+    CMD_CLEAR,
+    CMD_POINT,
+    CMD_LINE,
+    CMD_CIRCLE,
+    CMD_FILL_CIRCLE,
+    CMD_FILL_RECT,
+} CmdType;
+
+/**
+ * @brief Common prefix of every recorded command
+ *
+ * Commands are packed back to back inside a block, `size` bytes apart.
+ */
+typedef struct Cmd
+{
+    uint16_t type;  // CmdType
+    uint16_t size;  // Size of the whole command in bytes
+    uint32_t color;
+} Cmd;
+
+typedef struct CmdPoint
+{
+    Cmd cmd;
+    int32_t x, y;
+} CmdPoint;
+
+typedef struct CmdLine
+{
+    Cmd cmd;
+    int32_t x0, y0, x1, y1;
+} CmdLine;
+
+typedef struct CmdCircle // Outlined and filled circles
+{
+    Cmd cmd;
+    int32_t cx, cy, r;
+} CmdCircle;
+
+typedef struct CmdRect
+{
+    Cmd cmd;
+    int32_t x, y, width, height;
+} CmdRect;
+
+/**
+ * @brief One arena block, the commands follow the header directly
+ *
+ */
+typedef struct CmdBlock
+{
+    struct CmdBlock *next;
+    size_t used; // Bytes of commands in the block
+} CmdBlock;
+
+/**
+ * @brief Commands sorted into a grid of tiles
+ *
+ * Tile t replays commands[offsets[t]] to commands[offsets[t + 1] - 1].
+ */
+struct CmdBins
+{
+    uint64_t list;                    // Id of the list the bins were built from, 0 if never built
+    uint64_t revision;                // Revision of that list
+    int32_t width, height;            // Pixmap size the bins were built for
+    int32_t tile_width, tile_height;
+    int32_t columns, rows;
+    size_t *offsets;                  // columns * rows + 1 entries
+    size_t offsets_capacity;
+    const Cmd **commands;
+    size_t commands_capacity;
+};
+
+struct CmdList
+{
+    CmdBlock *first;
+    CmdBlock *current; // Block being recorded into
+    size_t count;      // Number of commands
+    uint64_t id;       // Unique for the lifetime of the process, so bins never match a list that reuses the address
+    uint64_t revision; // Bumped on every change, so bins can tell that they are stale
+};
+
+static std::atomic<uint64_t> next_list;
+
+static unsigned char *block_data(CmdBlock *block)
+{
+    return (unsigned char *)(block + 1);
+}
+
+#pragma region Recording
+CmdList *cmdlist_create(void)
+{
+    CmdList *list = (CmdList *)calloc(1, sizeof(CmdList));
+    if (list == NULL)
+        return NULL;
+
+    list->first = (CmdBlock *)malloc(CMD_BLOCK_SIZE);
+    if (list->first == NULL)
+    {
+        free(list);
+        return NULL;
+    }
+    list->first->next = NULL;
+    list->first->used = 0;
+    list->current = list->first;
+    list->id = next_list.fetch_add(1, std::memory_order_relaxed) + 1;
+    return list;
+}
+
+void cmdlist_destroy(CmdList *list)
+{
+    if (list == NULL)
+        return;
+
+    CmdBlock *block = list->first;
+    while (block != NULL)
+    {
+        CmdBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(list);
+}
+
+void cmdlist_reset(CmdList *list)
+{
+    for (CmdBlock *block = list->first; block != NULL; block = block->next)
+        block->used = 0;
+    list->current = list->first;
+    list->count = 0;
+    list->revision++;
+}
+
+size_t cmdlist_size(const CmdList *list)
+{
+    return list->count;
+}
+
+/**
+ * @brief Reserves space for one command at the end of the list
+ *
+ * Blocks left over from a reset are reused before new ones are allocated.
+ *
+ * @param list Target list
+ * @param type Command type
+ * @param size Size of the command in bytes
+ * @param color Color of the command
+ * @return The new command, or NULL if no block could be allocated
+ */
+static Cmd *cmdlist_push(CmdList *list, CmdType type, size_t size, uint32_t color)
+{
+    const size_t capacity = CMD_BLOCK_SIZE - sizeof(CmdBlock);
+    CmdBlock *block = list->current;
+    if (block->used + size > capacity)
+    {
+        if (block->next == NULL)
+        {
+            CmdBlock *next = (CmdBlock *)malloc(CMD_BLOCK_SIZE);
+            if (next == NULL)
+                return NULL;
+            next->next = NULL;
+            block->next = next;
+        }
+        block = block->next;
+        block->used = 0;
+        list->current = block;
+    }
+
+    Cmd *cmd = (Cmd *)(block_data(block) + block->used);
+    cmd->type = (uint16_t)type;
+    cmd->size = (uint16_t)size;
+    cmd->color = color;
+    block->used += size;
+    list->count++;
+    list->revision++;
+    return cmd;
+}
+
+bool cmdlist_clear(CmdList *list, uint32_t color)
+{
+    return cmdlist_push(list, CMD_CLEAR, sizeof(Cmd), color) != NULL;
+}
+
+bool cmdlist_draw_point(CmdList *list, int32_t x, int32_t y, uint32_t color)
+{
+    CmdPoint *cmd = (CmdPoint *)cmdlist_push(list, CMD_POINT, sizeof(CmdPoint), color);
+    if (cmd == NULL)
+        return false;
+    cmd->x = x;
+    cmd->y = y;
+    return true;
+}
+
+bool cmdlist_draw_line(CmdList *list, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    CmdLine *cmd = (CmdLine *)cmdlist_push(list, CMD_LINE, sizeof(CmdLine), color);
+    if (cmd == NULL)
+        return false;
+    cmd->x0 = x0;
+    cmd->y0 = y0;
+    cmd->x1 = x1;
+    cmd->y1 = y1;
+    return true;
+}
+
+/**
+ * @brief Records an outlined or filled circle
+ *
+ */
+static bool cmdlist_circle(CmdList *list, CmdType type, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    CmdCircle *cmd = (CmdCircle *)cmdlist_push(list, type, sizeof(CmdCircle), color);
+    if (cmd == NULL)
+        return false;
+    cmd->cx = cx;
+    cmd->cy = cy;
+    cmd->r = r;
+    return true;
+}
+
+bool cmdlist_draw_circle(CmdList *list, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    return cmdlist_circle(list, CMD_CIRCLE, cx, cy, r, color);
+}
+
+bool cmdlist_fill_circle(CmdList *list, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    return cmdlist_circle(list, CMD_FILL_CIRCLE, cx, cy, r, color);
+}
+
+bool cmdlist_fill_rect(CmdList *list, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color)
+{
+    CmdRect *cmd = (CmdRect *)cmdlist_push(list, CMD_FILL_RECT, sizeof(CmdRect), color);
+    if (cmd == NULL)
+        return false;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->width = width;
+    cmd->height = height;
+    return true;
+}
+#pragma endregion Recording
+
+#pragma region Bins
+CmdBins *cmdlist_bins_create(void)
+{
+    return (CmdBins *)calloc(1, sizeof(CmdBins));
+}
+
+/**
+ * @brief Releases the arrays of the bins but not the bins themselves
+ *
+ */
+static void bins_release(CmdBins *bins)
+{
+    free(bins->offsets);
+    free(bins->commands);
+}
+
+void cmdlist_bins_destroy(CmdBins *bins)
+{
+    if (bins == NULL)
+        return;
+
+    bins_release(bins);
+    free(bins);
+}
+#pragma endregion Bins
+
+#pragma region Binning
+/**
+ * @brief Iterates over every command of a list in recording order
+ *
+ * `continue` moves on to the next command.
+ */
+#define CMDLIST_FOREACH(list, cmd)                                                   \
+    for (CmdBlock *block_ = (list)->first; block_ != NULL; block_ = block_->next)    \
+        for (size_t offset_ = 0; offset_ < block_->used;)                            \
+            for (const Cmd *cmd = (const Cmd *)(block_data(block_) + offset_);       \
+                 cmd != NULL; offset_ += cmd->size, cmd = NULL)
+
+/**
+ * @brief Computes the inclusive bounding box of a command
+ *
+ * @param cmd Recorded command
+ * @param bounds Receives [x0, x1] x [y0, y1], 64-bit so that it cannot overflow
+ * @return false if the command draws nothing
+ */
+static bool cmd_bounds(const Cmd *cmd, int64_t bounds[4])
+{
+    switch ((CmdType)cmd->type)
+    {
+    case CMD_CLEAR:
+        bounds[0] = INT32_MIN, bounds[1] = INT32_MIN;
+        bounds[2] = INT32_MAX, bounds[3] = INT32_MAX;
+        return true;
+    case CMD_POINT:
+    {
+        const CmdPoint *point = (const CmdPoint *)cmd;
+        bounds[0] = bounds[2] = point->x;
+        bounds[1] = bounds[3] = point->y;
+        return true;
+    }
+    case CMD_LINE:
+    {
+        const CmdLine *line = (const CmdLine *)cmd;
+        bounds[0] = line->x0 < line->x1 ? line->x0 : line->x1;
+        bounds[1] = line->y0 < line->y1 ? line->y0 : line->y1;
+        bounds[2] = line->x0 < line->x1 ? line->x1 : line->x0;
+        bounds[3] = line->y0 < line->y1 ? line->y1 : line->y0;
+        return true;
+    }
+    case CMD_CIRCLE:
+    case CMD_FILL_CIRCLE:
+    {
+        const CmdCircle *circle = (const CmdCircle *)cmd;
+        bounds[0] = (int64_t)circle->cx - circle->r;
+        bounds[1] = (int64_t)circle->cy - circle->r;
+        bounds[2] = (int64_t)circle->cx + circle->r;
+        bounds[3] = (int64_t)circle->cy + circle->r;
+        return circle->r >= 0;
+    }
+    case CMD_FILL_RECT:
+    {
+        const CmdRect *rect = (const CmdRect *)cmd;
+        bounds[0] = rect->x;
+        bounds[1] = rect->y;
+        bounds[2] = (int64_t)rect->x + rect->width - 1;
+        bounds[3] = (int64_t)rect->y + rect->height - 1;
+        return rect->width > 0 && rect->height > 0;
+    }
+    }
+    return false;
+}
+
+/**
+ * @brief Converts a bounding box into the range of tiles it overlaps
+ *
+ * @param bins Tile grid
+ * @param bounds Inclusive bounding box from `cmd_bounds`
+ * @param tiles Receives the inclusive tile range [c0, r0, c1, r1]
+ * @return false if the box lies outside the grid
+ */
+static bool bins_range(const CmdBins *bins, const int64_t bounds[4], int32_t tiles[4])
+{
+    if (bounds[2] < 0 || bounds[3] < 0 || bounds[0] >= bins->width || bounds[1] >= bins->height)
+        return false;
+
+    int64_t x0 = bounds[0] < 0 ? 0 : bounds[0];
+    int64_t y0 = bounds[1] < 0 ? 0 : bounds[1];
+    int64_t x1 = bounds[2] >= bins->width ? bins->width - 1 : bounds[2];
+    int64_t y1 = bounds[3] >= bins->height ? bins->height - 1 : bounds[3];
+    tiles[0] = (int32_t)(x0 / bins->tile_width);
+    tiles[1] = (int32_t)(y0 / bins->tile_height);
+    tiles[2] = (int32_t)(x1 / bins->tile_width);
+    tiles[3] = (int32_t)(y1 / bins->tile_height);
+    return true;
+}
+
+/**
+ * @brief Sorts the commands of a list into a grid of tiles
+ *
+ * Every tile receives the commands overlapping it in recording order, starting
+ * at the last clear. The bins remember the list and its revision, so replaying
+ * an unchanged list against pixmaps of the same size skips this step. Only the
+ * bins are written, the list is only read.
+ *
+ * @param list Commands to sort
+ * @param bins Bins to fill, or to reuse if they already hold this layout
+ * @param width Width of the target pixmap
+ * @param height Height of the target pixmap
+ * @param tile_width Width of one tile
+ * @param tile_height Height of one tile
+ * @return The bins, or NULL if the allocation failed
+ */
+static const CmdBins *cmdlist_bin(const CmdList *list, CmdBins *bins, int32_t width, int32_t height, int32_t tile_width, int32_t tile_height)
+{
+    if (bins->list == list->id && bins->revision == list->revision && bins->width == width &&
+        bins->height == height && bins->tile_width == tile_width && bins->tile_height == tile_height)
+        return bins;
+
+    bins->list = 0;
+    bins->width = width;
+    bins->height = height;
+    bins->tile_width = tile_width;
+    bins->tile_height = tile_height;
+    bins->columns = (width + tile_width - 1) / tile_width;
+    bins->rows = (height + tile_height - 1) / tile_height;
+
+    size_t tiles = (size_t)bins->columns * (size_t)bins->rows;
+    if (tiles + 1 > bins->offsets_capacity)
+    {
+        size_t *offsets = (size_t *)realloc(bins->offsets, (tiles + 1) * sizeof(size_t));
+        if (offsets == NULL)
+            return NULL;
+        bins->offsets = offsets;
+        bins->offsets_capacity = tiles + 1;
+    }
+
+    // Everything before the last clear is overwritten by it
+    const Cmd *start = NULL;
+    CMDLIST_FOREACH(list, cmd)
+    {
+        if (cmd->type == CMD_CLEAR)
+            start = cmd;
+    }
+
+    // Count the commands of every tile, then turn the counts into offsets
+    for (size_t i = 0; i <= tiles; i++)
+        bins->offsets[i] = 0;
+    bool started = start == NULL;
+    CMDLIST_FOREACH(list, cmd)
+    {
+        started = started || cmd == start;
+        int64_t bounds[4];
+        int32_t range[4];
+        if (!started || !cmd_bounds(cmd, bounds) || !bins_range(bins, bounds, range))
+            continue;
+        for (int32_t row = range[1]; row <= range[3]; row++)
+            for (int32_t column = range[0]; column <= range[2]; column++)
+                bins->offsets[(size_t)row * bins->columns + column + 1]++;
+    }
+    for (size_t i = 0; i < tiles; i++)
+        bins->offsets[i + 1] += bins->offsets[i];
+
+    size_t total = bins->offsets[tiles];
+    if (total > bins->commands_capacity)
+    {
+        const Cmd **commands = (const Cmd **)realloc(bins->commands, total * sizeof(const Cmd *));
+        if (commands == NULL)
+            return NULL;
+        bins->commands = commands;
+        bins->commands_capacity = total;
+    }
+
+    // Fill the tiles, using the start offsets as cursors and shifting them back afterwards
+    started = start == NULL;
+    CMDLIST_FOREACH(list, cmd)
+    {
+        started = started || cmd == start;
+        int64_t bounds[4];
+        int32_t range[4];
+        if (!started || !cmd_bounds(cmd, bounds) || !bins_range(bins, bounds, range))
+            continue;
+        for (int32_t row = range[1]; row <= range[3]; row++)
+            for (int32_t column = range[0]; column <= range[2]; column++)
+                bins->commands[bins->offsets[(size_t)row * bins->columns + column]++] = cmd;
+    }
+    for (size_t i = tiles; i > 0; i--)
+        bins->offsets[i] = bins->offsets[i - 1];
+    bins->offsets[0] = 0;
+
+    bins->list = list->id;
+    bins->revision = list->revision;
+    return bins;
+}
+#pragma endregion Binning
+
+#pragma region Replay
+/**
+ * @brief Draws one command
+ *
+ * @param pixmap Target pixmap, clipped to the area being replayed
+ * @param cmd Recorded command
+ * @param area Pixels covered by the replayed area, a clear fills exactly these rows
+ */
+static void cmd_execute(Pixmap *pixmap, const Cmd *cmd, const Rect *area)
+{
+    switch ((CmdType)cmd->type)
+    {
+    case CMD_CLEAR:
+    {
+        // A clear ignores the clip rectangle and the blend mode, so it fills the whole area including row padding
+        PROBE_PRIMITIVE(STAT_CLEAR);
+        PROBE_CLEAR(pixmap, area);
+        dirty_clear(pixmap, area);
+        Rect fill = *area;
+        fill.x1 = area->x1 == pixmap->width ? pixmap->stride : area->x1;
+        area_fill(pixmap, &fill, color_premultiply(cmd->color));
+        break;
+    }
+    case CMD_POINT:
+    {
+        const CmdPoint *point = (const CmdPoint *)cmd;
+        draw_point(pixmap, point->x, point->y, cmd->color);
+        break;
+    }
+    case CMD_LINE:
+    {
+        const CmdLine *line = (const CmdLine *)cmd;
+        draw_line_bresenham(pixmap, line->x0, line->y0, line->x1, line->y1, cmd->color);
+        break;
+    }
+    case CMD_CIRCLE:
+    {
+        const CmdCircle *circle = (const CmdCircle *)cmd;
+        draw_circle(pixmap, circle->cx, circle->cy, circle->r, cmd->color);
+        break;
+    }
+    case CMD_FILL_CIRCLE:
+    {
+        const CmdCircle *circle = (const CmdCircle *)cmd;
+        fill_circle(pixmap, circle->cx, circle->cy, circle->r, cmd->color);
+        break;
+    }
+    case CMD_FILL_RECT:
+    {
+        const CmdRect *rect = (const CmdRect *)cmd;
+        fill_rect(pixmap, rect->x, rect->y, rect->width, rect->height, cmd->color);
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Replays the commands of one tile
+ *
+ * The commands are clipped against the intersection of the tile and the clip
+ * rectangle, while clears fill the whole tile. Every pixel belongs to exactly
+ * one tile and each tile keeps the recording order, so the result is the same
+ * as replaying the list in one piece.
+ *
+ * @param bins Binned commands
+ * @param pixmap Target pixmap, a copy whose clip rectangle may be modified
+ * @param column Column of the tile
+ * @param row Row of the tile
+ */
+static void cmdlist_replay_tile(const CmdBins *bins, Pixmap *pixmap, int32_t column, int32_t row)
+{
+    Rect clip = pixmap->clip;
+    Rect area;
+    area.x0 = column * bins->tile_width;
+    area.y0 = row * bins->tile_height;
+    area.x1 = area.x0 + bins->tile_width < bins->width ? area.x0 + bins->tile_width : bins->width;
+    area.y1 = area.y0 + bins->tile_height < bins->height ? area.y0 + bins->tile_height : bins->height;
+
+    pixmap->clip.x0 = clip.x0 > area.x0 ? clip.x0 : area.x0;
+    pixmap->clip.y0 = clip.y0 > area.y0 ? clip.y0 : area.y0;
+    pixmap->clip.x1 = clip.x1 < area.x1 ? clip.x1 : area.x1;
+    pixmap->clip.y1 = clip.y1 < area.y1 ? clip.y1 : area.y1;
+    bool visible = pixmap->clip.x0 < pixmap->clip.x1 && pixmap->clip.y0 < pixmap->clip.y1;
+
+    size_t tile = (size_t)row * bins->columns + column;
+    for (size_t i = bins->offsets[tile]; i < bins->offsets[tile + 1]; i++)
+    {
+        const Cmd *cmd = bins->commands[i];
+        if (visible || cmd->type == CMD_CLEAR)
+            cmd_execute(pixmap, cmd, &area);
+    }
+
+    pixmap->clip = clip;
+}
+
+/**
+ * @brief Replays everything in one pass, used when the bins cannot be allocated
+ *
+ */
+static void cmdlist_replay_serial(const CmdList *list, Pixmap *pixmap)
+{
+    Rect area = {0, 0, pixmap->width, pixmap->height};
+    CMDLIST_FOREACH(list, cmd)
+    {
+        cmd_execute(pixmap, cmd, &area);
+    }
+}
+
+/**
+ * @brief Returns the height of the bands of a serial replay
+ *
+ * Bands span whole rows, so that clears stay contiguous.
+ */
+static int32_t cmdlist_band_height(const Pixmap *pixmap)
+{
+    int32_t band_height = (int32_t)(CMD_BAND_BYTES / ((size_t)pixmap->stride * sizeof(uint32_t)));
+    return band_height < 8 ? 8 : band_height;
+}
+
+/**
+ * @brief Counts every command a replay draws as one call of its primitive
+ *
+ * The bands and tiles only add pixels and time, see `PROBE_PART`. Commands
+ * before the last clear are skipped by the replay and not counted.
+ */
+static void cmdlist_probe_calls(const CmdList *list)
+{
+#if RENDERER_STATS
+    static const StatPrimitive primitives[] = {STAT_CLEAR, STAT_POINT, STAT_LINE, STAT_CIRCLE, STAT_DISC, STAT_RECT};
+    uint64_t calls[STAT_PRIMITIVE_COUNT] = {};
+    CMDLIST_FOREACH(list, cmd)
+    {
+        if (cmd->type == CMD_CLEAR)
+            memset(calls, 0, sizeof(calls));
+        calls[primitives[cmd->type]]++;
+    }
+    for (size_t i = 0; i < STAT_PRIMITIVE_COUNT; i++)
+        if (calls[i] != 0)
+            PROBE_CALLS((StatPrimitive)i, calls[i]);
+#else
+    (void)list;
+#endif
+}
+
+/**
+ * @brief Replays in bands, or in one pass if the bins cannot be allocated
+ *
+ */
+static void cmdlist_replay_bands(const CmdList *list, Pixmap *pixmap, CmdBins *storage)
+{
+    int32_t band_height = cmdlist_band_height(pixmap);
+    const CmdBins *bins = cmdlist_bin(list, storage, pixmap->width, pixmap->height, pixmap->width, band_height);
+    if (bins != NULL)
+    {
+        for (int32_t row = 0; row < bins->rows; row++)
+            cmdlist_replay_tile(bins, pixmap, 0, row);
+        return;
+    }
+
+    cmdlist_replay_serial(list, pixmap);
+}
+
+void cmdlist_replay(const CmdList *list, Pixmap *pixmap, CmdBins *bins)
+{
+    PROBE_TIMER("replay");
+    cmdlist_probe_calls(list);
+    PROBE_PART();
+    CmdBins local = {};
+    cmdlist_replay_bands(list, pixmap, bins != NULL ? bins : &local);
+    bins_release(&local);
+}
+
+/**
+ * @brief Shared state of a parallel replay
+ *
+ */
+typedef struct TileJob
+{
+    const CmdBins *bins;
+    const Pixmap *pixmap;
+} TileJob;
+
+static void cmdlist_tile_task(void *context, size_t index, int32_t worker)
+{
+    (void)worker;
+    PROBE_PART();
+    const TileJob *job = (const TileJob *)context;
+
+    // Every task clips its own copy, the pixels are shared but the tiles are disjoint
+    Pixmap pixmap = *job->pixmap;
+    cmdlist_replay_tile(job->bins, &pixmap, (int32_t)(index % job->bins->columns), (int32_t)(index / job->bins->columns));
+}
+
+void cmdlist_replay_parallel(const CmdList *list, Pixmap *pixmap, RenderPool *pool, CmdBins *bins)
+{
+    PROBE_TIMER("replay");
+    cmdlist_probe_calls(list);
+    PROBE_PART();
+    CmdBins local = {};
+    CmdBins *storage = bins != NULL ? bins : &local;
+    const CmdBins *tiles = NULL;
+    if (render_pool_threads(pool) > 1)
+        tiles = cmdlist_bin(list, storage, pixmap->width, pixmap->height, CMD_TILE_SIZE, CMD_TILE_SIZE);
+    if (tiles == NULL)
+        cmdlist_replay_bands(list, pixmap, storage);
+    else
+    {
+        // The workers only read the bins, which are complete before the pool starts
+        TileJob job = {tiles, pixmap};
+        render_pool_run(pool, (size_t)tiles->columns * (size_t)tiles->rows, cmdlist_tile_task, &job);
+    }
+    bins_release(&local);
+}
+#pragma endregion Replay
+
+#pragma region Occlusion
+/**
+ * @brief Pixels already written by a front-to-back replay of one band
+ *
+ * The mask is hierarchical: one bit per pixel, packed into 64-bit words that
+ * each cover 64 pixels of a row, a count of full rows for every column of
+ * words and a count of full columns for the band. Primitives whose bounding
+ * box only overlaps full columns are skipped without touching the bits, and
+ * once every column is full nothing further back can show.
+ */
+typedef struct Occlusion
+{
+    Rect area;                      // Tracked pixels, the clip rectangle within the band
+    int32_t words;                  // Words per row of the area
+    uint64_t tail;                  // Bits of the last word of a row that lie inside the area
+    uint64_t *bits;                 // Set for every pixel that is already final
+    int32_t *full_rows;             // Rows with all bits set, per column of words
+    int32_t full_columns;           // Columns of words with all rows full
+    int32_t touched_y0, touched_y1; // Rows with bits set since the last reset
+} Occlusion;
+
+/**
+ * @brief Allocates the mask for areas of up to width x height pixels
+ *
+ * @return false if the allocation failed
+ */
+static bool occlusion_create(Occlusion *occlusion, int32_t width, int32_t height)
+{
+    size_t words = ((size_t)width + 63) / 64;
+    occlusion->bits = (uint64_t *)malloc(words * (size_t)height * sizeof(uint64_t) + words * sizeof(int32_t));
+    if (occlusion->bits == NULL)
+        return false;
+    memset(occlusion->bits, 0, words * (size_t)height * sizeof(uint64_t));
+    occlusion->full_rows = (int32_t *)(occlusion->bits + words * (size_t)height);
+    occlusion->touched_y0 = occlusion->touched_y1 = 0;
+    return true;
+}
+
+/**
+ * @brief Clears the mask and starts tracking a new area
+ *
+ * Only the rows touched since the last reset are cleared, so barriers that
+ * split a band into many short runs do not clear the whole band every time.
+ *
+ * @param occlusion Mask
+ * @param area Non-empty area to track, at most as large as the allocation
+ */
+static void occlusion_reset(Occlusion *occlusion, const Rect *area)
+{
+    if (occlusion->touched_y0 < occlusion->touched_y1)
+    {
+        size_t row = (size_t)occlusion->words;
+        memset(occlusion->bits + (size_t)(occlusion->touched_y0 - occlusion->area.y0) * row, 0,
+               (size_t)(occlusion->touched_y1 - occlusion->touched_y0) * row * sizeof(uint64_t));
+    }
+
+    int32_t width = area->x1 - area->x0;
+    occlusion->area = *area;
+    occlusion->words = (width + 63) / 64;
+    occlusion->tail = width % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (width % 64)) - 1;
+    memset(occlusion->full_rows, 0, (size_t)occlusion->words * sizeof(int32_t));
+    occlusion->full_columns = 0;
+    occlusion->touched_y0 = occlusion->touched_y1 = area->y0;
+}
+
+/**
+ * @brief Returns whether nothing more can be drawn into the area
+ *
+ */
+static bool occlusion_full(const Occlusion *occlusion)
+{
+    return occlusion->full_columns == occlusion->words;
+}
+
+/**
+ * @brief Returns whether every column of words overlapping [x0, x1) is full
+ *
+ * @param occlusion Mask
+ * @param x0 First column, inside the area
+ * @param x1 Column after the last one, inside the area and greater than x0
+ */
+static bool occlusion_covers(const Occlusion *occlusion, int32_t x0, int32_t x1)
+{
+    int32_t rows = occlusion->area.y1 - occlusion->area.y0;
+    for (int32_t w = (x0 - occlusion->area.x0) / 64; w <= (x1 - 1 - occlusion->area.x0) / 64; w++)
+        if (occlusion->full_rows[w] != rows)
+            return false;
+    return true;
+}
+
+/**
+ * @brief Draws the pixels of [x0, x1) on row y that are not covered yet and covers them
+ *
+ * Consecutive uncovered pixels are stored as one span, also across words.
+ *
+ * @param occlusion Mask
+ * @param pixmap Target pixmap
+ * @param x0 First column, inside the area
+ * @param x1 Column after the last one, inside the area and greater than x0
+ * @param y Row inside the area
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+static void occlusion_span(Occlusion *occlusion, Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color)
+{
+    const Rect *area = &occlusion->area;
+    uint64_t *bits = occlusion->bits + (size_t)(y - area->y0) * (size_t)occlusion->words;
+    int32_t rows = area->y1 - area->y0;
+    int32_t first = x0 - area->x0, last = x1 - 1 - area->x0;
+    if (y < occlusion->touched_y0)
+        occlusion->touched_y0 = y;
+    if (y >= occlusion->touched_y1)
+        occlusion->touched_y1 = y + 1;
+
+    int32_t run_x0 = 0, run_x1 = 0; // Pending span, relative to the area
+    for (int32_t w = first / 64; w <= last / 64; w++)
+    {
+        uint64_t range = ~(uint64_t)0;
+        if (w == first / 64)
+            range &= ~(uint64_t)0 << (first % 64);
+        if (w == last / 64)
+            range &= ~(uint64_t)0 >> (63 - last % 64);
+        uint64_t fresh = range & ~bits[w];
+        if (fresh == 0)
+            continue;
+
+        bits[w] |= fresh;
+        uint64_t full = w == occlusion->words - 1 ? occlusion->tail : ~(uint64_t)0;
+        if (bits[w] == full && ++occlusion->full_rows[w] == rows)
+            occlusion->full_columns++;
+
+        while (fresh != 0)
+        {
+            uint32_t lo = bit_lowest64(fresh);
+            uint64_t rest = ~(fresh >> lo);
+            uint32_t length = rest != 0 ? bit_lowest64(rest) : 64 - lo;
+            int32_t start = w * 64 + (int32_t)lo;
+            if (start != run_x1)
+            {
+                if (run_x0 < run_x1)
+                    span_store(pixmap, area->x0 + run_x0, area->x0 + run_x1, y, color);
+                run_x0 = start;
+            }
+            run_x1 = start + (int32_t)length;
+            fresh = lo + length >= 64 ? 0 : fresh & (~(uint64_t)0 << (lo + length));
+        }
+    }
+    if (run_x0 < run_x1)
+        span_store(pixmap, area->x0 + run_x0, area->x0 + run_x1, y, color);
+}
+
+/**
+ * @brief Draws the uncovered part of a `fill_rect`
+ *
+ */
+static void occlusion_rect(Occlusion *occlusion, Pixmap *pixmap, const CmdRect *rect)
+{
+    PROBE_PRIMITIVE(STAT_RECT);
+    if (rect->width <= 0 || rect->height <= 0)
+        return;
+
+    const Rect *area = &occlusion->area;
+    int64_t x0 = rect->x < area->x0 ? area->x0 : rect->x;
+    int64_t y0 = rect->y < area->y0 ? area->y0 : rect->y;
+    int64_t x1 = (int64_t)rect->x + rect->width;
+    int64_t y1 = (int64_t)rect->y + rect->height;
+    if (x1 > area->x1)
+        x1 = area->x1;
+    if (y1 > area->y1)
+        y1 = area->y1;
+    if (x0 >= x1 || y0 >= y1 || occlusion_covers(occlusion, (int32_t)x0, (int32_t)x1))
+        return;
+
+    for (int32_t y = (int32_t)y0; y < (int32_t)y1; y++)
+        occlusion_span(occlusion, pixmap, (int32_t)x0, (int32_t)x1, y, rect->cmd.color);
+}
+
+/**
+ * @brief Draws the uncovered part of a `fill_circle`, row by row with the same spans
+ *
+ */
+static void occlusion_disc(Occlusion *occlusion, Pixmap *pixmap, const CmdCircle *circle)
+{
+    PROBE_PRIMITIVE(STAT_DISC);
+    if (circle->r < 0)
+        return;
+
+    const Rect *area = &occlusion->area;
+    int64_t cx = circle->cx, cy = circle->cy, r = circle->r;
+    int64_t x0 = cx - r < area->x0 ? area->x0 : cx - r;
+    int64_t x1 = cx + r + 1 > area->x1 ? area->x1 : cx + r + 1;
+    int64_t y0 = cy - r < area->y0 ? area->y0 : cy - r;
+    int64_t y1 = cy + r + 1 > area->y1 ? area->y1 : cy + r + 1;
+    if (x0 >= x1 || y0 >= y1 || occlusion_covers(occlusion, (int32_t)x0, (int32_t)x1))
+        return;
+
+    int64_t limit = r * r + r;
+    for (int64_t y = y0; y < y1; y++)
+    {
+        int64_t hw = disc_half_width(limit, y < cy ? cy - y : y - cy);
+        int64_t left = cx - hw < area->x0 ? area->x0 : cx - hw;
+        int64_t right = cx + hw + 1 > area->x1 ? area->x1 : cx + hw + 1;
+        if (left < right)
+            occlusion_span(occlusion, pixmap, (int32_t)left, (int32_t)right, (int32_t)y, circle->cmd.color);
+    }
+}
+
+/**
+ * @brief Returns whether a command replaces every pixel it draws
+ *
+ * Opaque fills drawn as stores and clears hide whatever lies below them, so
+ * their order only matters where they overlap each other. Points, lines and
+ * outlines are drawn as they are.
+ */
+static bool cmd_occludes(const Pixmap *pixmap, const Cmd *cmd)
+{
+    switch ((CmdType)cmd->type)
+    {
+    case CMD_CLEAR:
+        return true;
+    case CMD_FILL_CIRCLE:
+    case CMD_FILL_RECT:
+        return color_is_store(pixmap, cmd->color) || pixmap->blend == BLEND_NONE;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Fills the pixels of a band left uncovered by the fills above a clear
+ *
+ * @param occlusion Mask of the fills drawn after the clear, tracking the visible part of the band
+ * @param pixmap Target pixmap
+ * @param band The band, including the row padding like a clear
+ * @param color Premultiplied clear color
+ */
+static void occlusion_clear(const Occlusion *occlusion, const Pixmap *pixmap, const Rect *band, uint32_t color)
+{
+    // Everything outside the tracked area, which the fills never reach
+    const Rect *area = &occlusion->area;
+    Rect outside[4] = {
+        {band->x0, band->y0, band->x1, area->y0},
+        {band->x0, area->y1, band->x1, band->y1},
+        {band->x0, area->y0, area->x0, area->y1},
+        {area->x1, area->y0, band->x1, area->y1},
+    };
+    for (size_t i = 0; i < 4; i++)
+        if (outside[i].x0 < outside[i].x1 && outside[i].y0 < outside[i].y1)
+            area_fill(pixmap, &outside[i], color);
+
+    for (int32_t y = area->y0; y < area->y1; y++)
+    {
+        const uint64_t *bits = occlusion->bits + (size_t)(y - area->y0) * (size_t)occlusion->words;
+        if (y < occlusion->touched_y0 || y >= occlusion->touched_y1)
+        {
+            Rect row = {area->x0, y, area->x1, y + 1};
+            area_fill(pixmap, &row, color);
+            continue;
+        }
+        for (int32_t w = 0; w < occlusion->words; w++)
+        {
+            uint64_t empty = ~bits[w] & (w == occlusion->words - 1 ? occlusion->tail : ~(uint64_t)0);
+            while (empty != 0)
+            {
+                uint32_t lo = bit_lowest64(empty);
+                uint64_t rest = ~(empty >> lo);
+                uint32_t length = rest != 0 ? bit_lowest64(rest) : 64 - lo;
+                Rect run = {area->x0 + w * 64 + (int32_t)lo, y, area->x0 + w * 64 + (int32_t)(lo + length), y + 1};
+                area_fill(pixmap, &run, color);
+                empty = lo + length >= 64 ? 0 : empty & (~(uint64_t)0 << (lo + length));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Replays consecutive occluding commands of a band from the last to the first
+ *
+ * @param occlusion Mask, reset for the visible part of the band
+ * @param pixmap Target pixmap, clipped to the band
+ * @param commands Occluding commands in recording order, a clear can only come first
+ * @param count Number of commands
+ * @param band Pixels of the band
+ */
+static void occlusion_replay(Occlusion *occlusion, Pixmap *pixmap, const Cmd *const *commands, size_t count, const Rect *band)
+{
+    occlusion_reset(occlusion, &pixmap->clip);
+
+    const Cmd *clear = commands[0]->type == CMD_CLEAR ? commands[0] : NULL;
+    if (clear != NULL)
+    {
+        PROBE_PRIMITIVE(STAT_CLEAR);
+        PROBE_CLEAR(pixmap, band);
+        dirty_clear(pixmap, band);
+    }
+
+    for (size_t i = count; i-- > (clear != NULL ? 1u : 0u) && !occlusion_full(occlusion);)
+    {
+        if (commands[i]->type == CMD_FILL_RECT)
+            occlusion_rect(occlusion, pixmap, (const CmdRect *)commands[i]);
+        else
+            occlusion_disc(occlusion, pixmap, (const CmdCircle *)commands[i]);
+    }
+
+    if (clear != NULL)
+    {
+        Rect fill = *band;
+        fill.x1 = band->x1 == pixmap->width ? pixmap->stride : band->x1;
+        occlusion_clear(occlusion, pixmap, &fill, color_premultiply(clear->color));
+    }
+}
+
+/**
+ * @brief Replays one band front to back
+ *
+ * The commands are split at every command that does not occlude. Those are
+ * drawn in order, while the occluding runs between them are drawn in reverse
+ * against a fresh mask, which gives the same pixels as the recording order.
+ *
+ * @param bins Binned commands, one column of bands
+ * @param pixmap Target pixmap, whose clip rectangle is narrowed while the band is replayed
+ * @param row Band to replay
+ * @param occlusion Mask large enough for a band
+ */
+static void cmdlist_replay_band_front_to_back(const CmdBins *bins, Pixmap *pixmap, int32_t row, Occlusion *occlusion)
+{
+    Rect clip = pixmap->clip;
+    Rect band = {0, row * bins->tile_height, bins->width, row * bins->tile_height + bins->tile_height};
+    if (band.y1 > bins->height)
+        band.y1 = bins->height;
+
+    pixmap->clip.x0 = clip.x0;
+    pixmap->clip.y0 = clip.y0 > band.y0 ? clip.y0 : band.y0;
+    pixmap->clip.x1 = clip.x1;
+    pixmap->clip.y1 = clip.y1 < band.y1 ? clip.y1 : band.y1;
+    if (pixmap->clip.x0 >= pixmap->clip.x1 || pixmap->clip.y0 >= pixmap->clip.y1)
+    {
+        // Only a clear can draw into an invisible band
+        pixmap->clip = clip;
+        cmdlist_replay_tile(bins, pixmap, 0, row);
+        return;
+    }
+
+    size_t end = bins->offsets[row + 1];
+    for (size_t first = bins->offsets[row]; first < end;)
+    {
+        size_t last = first;
+        while (last < end && cmd_occludes(pixmap, bins->commands[last]))
+            last++;
+        if (last > first)
+            occlusion_replay(occlusion, pixmap, bins->commands + first, last - first, &band);
+        if (last < end)
+            cmd_execute(pixmap, bins->commands[last], &band);
+        first = last + 1;
+    }
+
+    pixmap->clip = clip;
+}
+
+void cmdlist_replay_front_to_back(const CmdList *list, Pixmap *pixmap, CmdBins *bins)
+{
+    PROBE_TIMER("replay");
+    cmdlist_probe_calls(list);
+    PROBE_PART();
+    CmdBins local = {};
+    CmdBins *storage = bins != NULL ? bins : &local;
+    int32_t band_height = cmdlist_band_height(pixmap);
+    const CmdBins *bands = cmdlist_bin(list, storage, pixmap->width, pixmap->height, pixmap->width, band_height);
+    Occlusion occlusion;
+    if (bands == NULL || !occlusion_create(&occlusion, pixmap->width, band_height))
+        cmdlist_replay_bands(list, pixmap, storage);
+    else
+    {
+        for (int32_t row = 0; row < bands->rows; row++)
+            cmdlist_replay_band_front_to_back(bands, pixmap, row, &occlusion);
+        free(occlusion.bits);
+    }
+    bins_release(&local);
+}
+#pragma endregion Occlusion
@@ -0,0 +1,37 @@
+/**
+ * @file convert.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Conversion of pixmap rows into the byte layouts of the image formats
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <export.h>
+
+/**
+ * @brief Converts `count` pixels into the bytes of an image format
+ *
+ */
+typedef void (*ConvertFn)(uint8_t *dst, const uint32_t *src, size_t count);
+
+/**
+ * @brief Picks the fastest pixel to byte conversion for this processor
+ *
+ * @param format IMAGE_RGBA or IMAGE_RAW for 4 bytes per pixel, otherwise 3 bytes per pixel
+ * @return The conversion kernel
+ */
+ConvertFn select_convert(ImageFormat format);
+
+/**
+ * @brief Returns the number of bytes a pixel takes in the rows of an uncompressed format
+ *
+ */
+static inline size_t convert_pixel_bytes(ImageFormat format)
+{
+    return format == IMAGE_RGBA || format == IMAGE_RAW ? 4 : 3;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file cpu.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include "cpu.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Queries the processor for its instruction set extensions
+ *
+ * @return Bitmask of `CpuFeature` values
+ */
+static uint32_t detect_features(void)
+{
+    uint32_t features = 0;
+#if RENDERER_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    if (info[3] & (1 << 26))
+        features |= CPU_SSE2;
+    if (info[2] & (1 << 9))
+        features |= CPU_SSSE3;
+    if (info[2] & (1 << 19))
+        features |= CPU_SSE41;
+
+    // AVX2 also needs the OS to save the YMM registers
+    bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    if (max_leaf >= 7 && os_avx)
+    {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+            features |= CPU_AVX2;
+    }
+#elif RENDERER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        features |= CPU_SSE2;
+    if (__builtin_cpu_supports("ssse3"))
+        features |= CPU_SSSE3;
+    if (__builtin_cpu_supports("sse4.1"))
+        features |= CPU_SSE41;
+    if (__builtin_cpu_supports("avx2"))
+        features |= CPU_AVX2;
+#endif
+
+    const char *mask = getenv("RENDERER_CPU_MASK");
+    if (mask != NULL)
+        features &= (uint32_t)strtoul(mask, NULL, 0);
+
+    return features;
+}
+
+uint32_t cpu_features(void)
+{
+    static const uint32_t features = detect_features();
+    return features;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file cpu.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Runtime detection of the instruction sets used by the SIMD kernels
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define RENDERER_X86 1
+    // Lets a single function use instructions beyond the compiler's baseline
+    #define TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #define RENDERER_X86 1
+    #define TARGET(isa)
+#else
+    #define RENDERER_X86 0
+    #define TARGET(isa)
+#endif
+
+#if RENDERER_X86
+    #include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+/**
+ * @brief Instruction set extensions relevant for the kernels
+ *
+ */
+enum CpuFeature
+{
+    CPU_SSE2 = 1 << 0,
+    CPU_SSSE3 = 1 << 1,
+    CPU_SSE41 = 1 << 2,
+    CPU_AVX2 = 1 << 3,
+};
+
+/**
+ * @brief Returns the supported instruction set extensions
+ *
+ * The result is detected once and cached. Setting the environment variable
+ * `RENDERER_CPU_MASK` to an integer masks the detected features, which allows
+ * the scalar and SSE fallbacks to be exercised on machines with AVX2.
+ *
+ * @return Bitmask of `CpuFeature` values
+ */
+uint32_t cpu_features(void);
+
+/**
+ * @brief Returns the index of the highest set bit
+ *
+ * @param value Non-zero value
+ */
+static inline uint32_t bit_highest(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, value);
+    return (uint32_t)index;
+#else
+    return 31 - (uint32_t)__builtin_clz(value);
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit
+ *
+ * @param value Non-zero value
+ */
+static inline uint32_t bit_lowest(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(value);
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of a 64-bit value
+ *
+ * @param value Non-zero value
+ */
+static inline uint32_t bit_lowest64(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint32_t)index;
+#elif defined(_MSC_VER)
+    uint32_t low = (uint32_t)value;
+    return low != 0 ? bit_lowest(low) : 32 + bit_lowest((uint32_t)(value >> 32));
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
+}
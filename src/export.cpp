@@ -0,0 +1,898 @@
+/**
+ * @file export.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <export.h>
+
+#include "convert.h"
+#include "cpu.h"
+#include "probe.h"
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+    #include <io.h>
+    #define write_fd _write
+    #define open_fd _open
+    #define close_fd _close
+    #define OPEN_FLAGS (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+    #define OPEN_MODE (_S_IREAD | _S_IWRITE)
+#else
+    #include <unistd.h>
+    #define write_fd write
+    #define open_fd open
+    #define close_fd close
+    #define OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+    #define OPEN_MODE 0644
+#endif
+
+/**
+ * @brief Sizes of the internal buffers
+ *
+ */
+enum
+{
+    WRITER_BUFFER_SIZE = 1 << 18, // Bytes collected before each write call
+    IDAT_CHUNK_SIZE = 1 << 16,    // Compressed bytes per PNG IDAT chunk
+    DEFLATE_WINDOW = 1 << 15,     // History searched for matches
+    DEFLATE_BLOCK = 1 << 18,      // Input bytes compressed per deflate block
+    DEFLATE_HASH_BITS = 15,
+    DEFLATE_MIN_MATCH = 4,
+    DEFLATE_MAX_MATCH = 258,
+};
+
+#pragma region Writer
+/**
+ * @brief Buffered output to a file descriptor or a caller-supplied buffer
+ *
+ */
+typedef struct Writer
+{
+    int fd;            // Target descriptor or -1 when writing to memory
+    uint8_t *memory;   // Target buffer when writing to memory
+    size_t capacity;   // Size of `memory`
+    size_t total;      // Bytes produced so far
+    uint8_t *buffer;   // Staging buffer of WRITER_BUFFER_SIZE bytes
+    size_t used;       // Bytes waiting in `buffer`
+    uint8_t *reserved; // Last pointer handed out by `writer_reserve`
+    bool failed;
+} Writer;
+
+static bool writer_init_fd(Writer *writer, int fd)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = fd;
+    writer->buffer = (uint8_t *)malloc(WRITER_BUFFER_SIZE);
+    return writer->buffer != NULL;
+}
+
+static bool writer_init_memory(Writer *writer, uint8_t *memory, size_t capacity)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+    writer->memory = memory;
+    writer->capacity = memory != NULL ? capacity : 0;
+    writer->buffer = (uint8_t *)malloc(WRITER_BUFFER_SIZE);
+    return writer->buffer != NULL;
+}
+
+/**
+ * @brief Hands the staged bytes to the file descriptor
+ *
+ * @param writer Writer targeting a file descriptor
+ */
+static void writer_flush(Writer *writer)
+{
+    size_t offset = 0;
+    while (offset < writer->used && !writer->failed)
+    {
+        size_t chunk = writer->used - offset;
+        if (chunk > (1u << 30))
+            chunk = 1u << 30;
+
+        long written = (long)write_fd(writer->fd, writer->buffer + offset, (unsigned)chunk);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            writer->failed = true;
+        else
+            offset += (size_t)written;
+    }
+    writer->used = 0;
+}
+
+/**
+ * @brief Flushes the writer and releases its staging buffer
+ *
+ * @param writer Writer to finish
+ * @return true if every byte was written
+ */
+static bool writer_finish(Writer *writer)
+{
+    if (writer->fd >= 0)
+        writer_flush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return !writer->failed;
+}
+
+/**
+ * @brief Returns space for up to `size` bytes of output
+ *
+ * When writing to memory with enough room left, the pointer refers directly
+ * into the caller's buffer, so no copy is made.
+ *
+ * @param writer Writer
+ * @param size Number of bytes, at most WRITER_BUFFER_SIZE
+ * @return Pointer to at least `size` writable bytes
+ */
+static uint8_t *writer_reserve(Writer *writer, size_t size)
+{
+    if (writer->fd < 0)
+    {
+        if (writer->total <= writer->capacity && writer->capacity - writer->total >= size)
+            writer->reserved = writer->memory + writer->total;
+        else
+            writer->reserved = writer->buffer;
+        return writer->reserved;
+    }
+
+    if (writer->used + size > WRITER_BUFFER_SIZE)
+        writer_flush(writer);
+    writer->reserved = writer->buffer + writer->used;
+    return writer->reserved;
+}
+
+/**
+ * @brief Appends the first `size` bytes of the last reservation to the output
+ *
+ * @param writer Writer
+ * @param size Number of bytes actually written to the reservation
+ */
+static void writer_commit(Writer *writer, size_t size)
+{
+    if (writer->fd < 0)
+    {
+        // The reservation was in the staging buffer, copy what still fits
+        if (writer->reserved == writer->buffer && writer->total < writer->capacity)
+        {
+            size_t room = writer->capacity - writer->total;
+            memcpy(writer->memory + writer->total, writer->buffer, size < room ? size : room);
+        }
+        writer->total += size;
+        return;
+    }
+
+    writer->used += size;
+    writer->total += size;
+}
+
+static void writer_bytes(Writer *writer, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    while (size > 0)
+    {
+        size_t chunk = size < (size_t)WRITER_BUFFER_SIZE ? size : (size_t)WRITER_BUFFER_SIZE;
+        memcpy(writer_reserve(writer, chunk), bytes, chunk);
+        writer_commit(writer, chunk);
+        bytes += chunk;
+        size -= chunk;
+    }
+}
+
+static void writer_u32be(Writer *writer, uint32_t value)
+{
+    uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    writer_bytes(writer, bytes, sizeof(bytes));
+}
+#pragma endregion Writer
+
+#pragma region Conversion
+static void convert_raw(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    memcpy(dst, src, count * sizeof(uint32_t));
+}
+
+static void convert_rgb_scalar(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t pixel = src[i];
+        dst[0] = (uint8_t)(pixel >> 24);
+        dst[1] = (uint8_t)(pixel >> 16);
+        dst[2] = (uint8_t)(pixel >> 8);
+        dst += 3;
+    }
+}
+
+static void convert_rgba_scalar(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t pixel = src[i];
+        dst[0] = (uint8_t)(pixel >> 24);
+        dst[1] = (uint8_t)(pixel >> 16);
+        dst[2] = (uint8_t)(pixel >> 8);
+        dst[3] = (uint8_t)pixel;
+        dst += 4;
+    }
+}
+
+#if RENDERER_X86
+/**
+ * @brief Packs 16 pixels per iteration into 48 RGB bytes
+ *
+ * Each shuffle drops the alpha byte of 4 pixels, the byte shifts then stitch
+ * the four 12-byte results into three full 16-byte stores.
+ */
+TARGET("ssse3") static void convert_rgb_ssse3(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i + 0)), shuffle);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i + 4)), shuffle);
+        __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i + 8)), shuffle);
+        __m128i d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i + 12)), shuffle);
+
+        _mm_storeu_si128((__m128i *)(dst + 0), _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128((__m128i *)(dst + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+        dst += 48;
+    }
+    convert_rgb_scalar(dst, src + i, count - i);
+}
+
+/**
+ * @brief Packs 8 pixels per iteration into 24 RGB bytes
+ *
+ * The 32-byte store runs 8 bytes past the packed data, so the loop stops
+ * early enough for those bytes to be overwritten by the remaining pixels.
+ */
+TARGET("avx2") static void convert_rgb_avx2(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1,
+                                             3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 11 <= count; i += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, shuffle), compact);
+        _mm256_storeu_si256((__m256i *)dst, packed);
+        dst += 24;
+    }
+    convert_rgb_ssse3(dst, src + i, count - i);
+}
+
+TARGET("ssse3") static void convert_rgba_ssse3(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    convert_rgba_scalar(dst + 4 * i, src + i, count - i);
+}
+
+TARGET("avx2") static void convert_rgba_avx2(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                             3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + 4 * i), _mm256_shuffle_epi8(pixels, shuffle));
+    }
+    convert_rgba_ssse3(dst + 4 * i, src + i, count - i);
+}
+#endif
+
+ConvertFn select_convert(ImageFormat format)
+{
+    if (format == IMAGE_RAW)
+        return convert_raw;
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return format == IMAGE_RGBA ? convert_rgba_avx2 : convert_rgb_avx2;
+    if (features & CPU_SSSE3)
+        return format == IMAGE_RGBA ? convert_rgba_ssse3 : convert_rgb_ssse3;
+#endif
+    return format == IMAGE_RGBA ? convert_rgba_scalar : convert_rgb_scalar;
+}
+
+/**
+ * @brief Hands out the rows of a pixmap in row-major order
+ *
+ * Rows of linear pixmaps are read in place. Tiled pixmaps are detiled into a
+ * buffer one row of tiles at a time, from the row asked for to the end of its
+ * row of tiles.
+ */
+typedef struct RowReader
+{
+    const Pixmap *pixmap;
+    uint32_t *rows; // Detiled rows [y0, y1), NULL for linear pixmaps
+    int32_t y0, y1;
+} RowReader;
+
+static bool row_reader_init(RowReader *reader, const Pixmap *pixmap)
+{
+    reader->pixmap = pixmap;
+    reader->rows = NULL;
+    reader->y0 = reader->y1 = 0;
+    if (pixmap->layout == LAYOUT_LINEAR)
+        return true;
+    reader->rows = (uint32_t *)malloc(((size_t)pixmap->width << layout_shift(pixmap->layout)) * sizeof(uint32_t));
+    return reader->rows != NULL;
+}
+
+static const uint32_t *row_reader_row(RowReader *reader, int32_t y)
+{
+    const Pixmap *pixmap = reader->pixmap;
+    if (reader->rows == NULL)
+        return pixmap_row(pixmap, y);
+    if (y < reader->y0 || y >= reader->y1)
+    {
+        int32_t size = 1 << layout_shift(pixmap->layout);
+        reader->y0 = y;
+        reader->y1 = (y & ~(size - 1)) + size < pixmap->height ? (y & ~(size - 1)) + size : pixmap->height;
+        pixmap_read_rows(pixmap, reader->y0, reader->y1 - reader->y0, reader->rows, (size_t)pixmap->width);
+    }
+    return reader->rows + (size_t)(y - reader->y0) * (size_t)pixmap->width;
+}
+
+static void row_reader_release(RowReader *reader)
+{
+    free(reader->rows);
+}
+
+/**
+ * @brief Converts and writes the rows of an area of the pixmap
+ *
+ * @param writer Output
+ * @param pixmap Source pixmap
+ * @param area Area inside the pixmap
+ * @param format IMAGE_PPM, IMAGE_RGBA or IMAGE_RAW
+ */
+static void write_pixels(Writer *writer, const Pixmap *pixmap, const Rect *area, ImageFormat format)
+{
+    ConvertFn convert = select_convert(format);
+    size_t bytes_per_pixel = convert_pixel_bytes(format);
+    size_t chunk_pixels = WRITER_BUFFER_SIZE / bytes_per_pixel;
+    size_t width = (size_t)(area->x1 - area->x0);
+    RowReader reader;
+    if (!row_reader_init(&reader, pixmap))
+    {
+        writer->failed = true;
+        return;
+    }
+
+    for (int32_t y = area->y0; y < area->y1 && !writer->failed; y++)
+    {
+        const uint32_t *row = row_reader_row(&reader, y) + area->x0;
+        for (size_t x = 0; x < width; x += chunk_pixels)
+        {
+            size_t count = width - x;
+            if (count > chunk_pixels)
+                count = chunk_pixels;
+
+            convert(writer_reserve(writer, count * bytes_per_pixel), row + x, count);
+            writer_commit(writer, count * bytes_per_pixel);
+        }
+    }
+    row_reader_release(&reader);
+}
+#pragma endregion Conversion
+
+#pragma region PNG
+typedef struct CrcTable
+{
+    uint32_t entries[256];
+} CrcTable;
+
+static CrcTable make_crc_table(void)
+{
+    CrcTable table;
+    for (uint32_t n = 0; n < 256; n++)
+    {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table.entries[n] = c;
+    }
+    return table;
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, size_t size)
+{
+    static const CrcTable table = make_crc_table();
+    for (size_t i = 0; i < size; i++)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+/**
+ * @brief Writes a complete PNG chunk
+ *
+ * @param writer Output
+ * @param type Four character chunk type
+ * @param data Chunk payload
+ * @param size Payload size in bytes
+ */
+static void png_chunk(Writer *writer, const char *type, const uint8_t *data, size_t size)
+{
+    uint32_t crc = crc_update(0xFFFFFFFFu, (const uint8_t *)type, 4);
+    crc = crc_update(crc, data, size);
+
+    writer_u32be(writer, (uint32_t)size);
+    writer_bytes(writer, type, 4);
+    writer_bytes(writer, data, size);
+    writer_u32be(writer, crc ^ 0xFFFFFFFFu);
+}
+
+/**
+ * @brief Streaming zlib compressor which emits its output as IDAT chunks
+ *
+ * Uses greedy LZ77 matching with a single-entry hash table and the fixed
+ * Huffman codes of deflate. This trades some compression ratio for speed,
+ * which suits rendered images with long runs of identical pixels.
+ */
+typedef struct Deflater
+{
+    Writer *writer;
+    uint8_t *window;   // DEFLATE_WINDOW bytes of history followed by pending input
+    size_t history;    // Bytes of history at the start of `window`
+    size_t pending;    // Bytes of input after the history
+    int64_t base;      // Stream position of window[0]
+    int64_t *head;     // Most recent stream position for each hash
+    uint64_t bits;     // Bits not yet moved to `chunk`
+    uint32_t bit_count;
+    uint32_t adler_a;
+    uint32_t adler_b;
+    uint8_t *chunk;    // IDAT payload being collected
+    size_t chunk_used;
+    uint16_t lit_code[288]; // Bit-reversed fixed Huffman codes
+    uint8_t lit_bits[288];
+} Deflater;
+
+static uint32_t reverse_bits(uint32_t code, uint32_t count)
+{
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+static void deflate_chunk_flush(Deflater *deflater)
+{
+    if (deflater->chunk_used == 0)
+        return;
+    png_chunk(deflater->writer, "IDAT", deflater->chunk, deflater->chunk_used);
+    deflater->chunk_used = 0;
+}
+
+static void deflate_byte(Deflater *deflater, uint8_t byte)
+{
+    if (deflater->chunk_used == IDAT_CHUNK_SIZE)
+        deflate_chunk_flush(deflater);
+    deflater->chunk[deflater->chunk_used++] = byte;
+}
+
+static void deflate_bits(Deflater *deflater, uint32_t value, uint32_t count)
+{
+    deflater->bits |= (uint64_t)value << deflater->bit_count;
+    deflater->bit_count += count;
+    if (deflater->bit_count >= 32)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            deflate_byte(deflater, (uint8_t)deflater->bits);
+            deflater->bits >>= 8;
+        }
+        deflater->bit_count -= 32;
+    }
+}
+
+static void deflate_align(Deflater *deflater)
+{
+    while (deflater->bit_count > 0)
+    {
+        deflate_byte(deflater, (uint8_t)deflater->bits);
+        deflater->bits >>= 8;
+        deflater->bit_count = deflater->bit_count > 8 ? deflater->bit_count - 8 : 0;
+    }
+    deflater->bits = 0;
+}
+
+static void deflate_symbol(Deflater *deflater, uint32_t symbol)
+{
+    deflate_bits(deflater, deflater->lit_code[symbol], deflater->lit_bits[symbol]);
+}
+
+/**
+ * @brief Emits a <length, distance> pair with the fixed Huffman codes
+ *
+ * @param deflater Compressor
+ * @param length Match length in [3, 258]
+ * @param distance Match distance in [1, 32768]
+ */
+static void deflate_match(Deflater *deflater, uint32_t length, uint32_t distance)
+{
+    uint32_t l = length - 3;
+    if (length == DEFLATE_MAX_MATCH)
+        deflate_symbol(deflater, 285);
+    else if (l < 8)
+        deflate_symbol(deflater, 257 + l);
+    else
+    {
+        uint32_t top = bit_highest(l);
+        deflate_symbol(deflater, 257 + 4 * (top - 1) + ((l >> (top - 2)) & 3));
+        deflate_bits(deflater, l & ((1u << (top - 2)) - 1), top - 2);
+    }
+
+    uint32_t d = distance - 1;
+    if (d < 4)
+        deflate_bits(deflater, reverse_bits(d, 5), 5);
+    else
+    {
+        uint32_t top = bit_highest(d);
+        uint32_t code = 2 * top + ((d >> (top - 1)) & 1);
+        deflate_bits(deflater, reverse_bits(code, 5), 5);
+        deflate_bits(deflater, d & ((1u << (top - 1)) - 1), top - 1);
+    }
+}
+
+static bool deflate_init(Deflater *deflater, Writer *writer)
+{
+    memset(deflater, 0, sizeof(*deflater));
+    deflater->writer = writer;
+    deflater->adler_a = 1;
+    deflater->window = (uint8_t *)malloc(DEFLATE_WINDOW + DEFLATE_BLOCK);
+    deflater->head = (int64_t *)malloc(sizeof(int64_t) << DEFLATE_HASH_BITS);
+    deflater->chunk = (uint8_t *)malloc(IDAT_CHUNK_SIZE);
+    if (deflater->window == NULL || deflater->head == NULL || deflater->chunk == NULL)
+        return false;
+
+    for (size_t i = 0; i < ((size_t)1 << DEFLATE_HASH_BITS); i++)
+        deflater->head[i] = -1;
+
+    for (uint32_t s = 0; s < 288; s++)
+    {
+        uint32_t code, bits;
+        if (s < 144)
+            code = 0x30 + s, bits = 8;
+        else if (s < 256)
+            code = 0x190 + (s - 144), bits = 9;
+        else if (s < 280)
+            code = s - 256, bits = 7;
+        else
+            code = 0xC0 + (s - 280), bits = 8;
+        deflater->lit_code[s] = (uint16_t)reverse_bits(code, bits);
+        deflater->lit_bits[s] = (uint8_t)bits;
+    }
+
+    // zlib header: deflate with a 32K window, fastest compression level
+    deflate_byte(deflater, 0x78);
+    deflate_byte(deflater, 0x01);
+    return true;
+}
+
+static void deflate_release(Deflater *deflater)
+{
+    free(deflater->window);
+    free(deflater->head);
+    free(deflater->chunk);
+}
+
+/**
+ * @brief Compresses the pending input as one non-final fixed Huffman block
+ *
+ * @param deflater Compressor
+ */
+static void deflate_block(Deflater *deflater)
+{
+    const uint8_t *window = deflater->window;
+    size_t pos = deflater->history;
+    size_t end = deflater->history + deflater->pending;
+
+    deflate_bits(deflater, 1 << 1, 3); // BFINAL = 0, BTYPE = 01
+
+    while (pos < end)
+    {
+        if (end - pos >= DEFLATE_MIN_MATCH)
+        {
+            uint32_t word;
+            memcpy(&word, window + pos, sizeof(word));
+            uint32_t hash = (word * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+
+            int64_t candidate = deflater->head[hash] - deflater->base;
+            deflater->head[hash] = deflater->base + (int64_t)pos;
+
+            if (candidate >= 0 && (int64_t)pos - candidate <= DEFLATE_WINDOW)
+            {
+                size_t limit = end - pos < (size_t)DEFLATE_MAX_MATCH ? end - pos : (size_t)DEFLATE_MAX_MATCH;
+                size_t length = 0;
+                while (length < limit && window[candidate + length] == window[pos + length])
+                    length++;
+
+                if (length >= DEFLATE_MIN_MATCH)
+                {
+                    deflate_match(deflater, (uint32_t)length, (uint32_t)(pos - candidate));
+                    pos += length;
+                    continue;
+                }
+            }
+        }
+
+        deflate_symbol(deflater, window[pos]);
+        pos++;
+    }
+
+    deflate_symbol(deflater, 256);
+
+    // Keep the last window of input as history for the next block
+    size_t keep = end < (size_t)DEFLATE_WINDOW ? end : (size_t)DEFLATE_WINDOW;
+    memmove(deflater->window, deflater->window + end - keep, keep);
+    deflater->base += (int64_t)(end - keep);
+    deflater->history = keep;
+    deflater->pending = 0;
+}
+
+static void deflate_feed(Deflater *deflater, const uint8_t *data, size_t size)
+{
+    // Adler-32, reduced before the sums can overflow
+    uint32_t a = deflater->adler_a, b = deflater->adler_b;
+    for (size_t i = 0; i < size;)
+    {
+        size_t n = size - i < 5552 ? size - i : 5552;
+        for (size_t k = 0; k < n; k++)
+        {
+            a += data[i + k];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        i += n;
+    }
+    deflater->adler_a = a;
+    deflater->adler_b = b;
+
+    while (size > 0)
+    {
+        size_t room = DEFLATE_BLOCK - deflater->pending;
+        size_t n = size < room ? size : room;
+        memcpy(deflater->window + deflater->history + deflater->pending, data, n);
+        deflater->pending += n;
+        data += n;
+        size -= n;
+
+        if (deflater->pending == DEFLATE_BLOCK)
+            deflate_block(deflater);
+    }
+}
+
+static void deflate_finish(Deflater *deflater)
+{
+    if (deflater->pending > 0)
+        deflate_block(deflater);
+
+    // Empty final block
+    deflate_bits(deflater, 1 | (1 << 1), 3);
+    deflate_symbol(deflater, 256);
+    deflate_align(deflater);
+
+    uint32_t adler = (deflater->adler_b << 16) | deflater->adler_a;
+    deflate_byte(deflater, (uint8_t)(adler >> 24));
+    deflate_byte(deflater, (uint8_t)(adler >> 16));
+    deflate_byte(deflater, (uint8_t)(adler >> 8));
+    deflate_byte(deflater, (uint8_t)adler);
+    deflate_chunk_flush(deflater);
+}
+
+/**
+ * @brief Writes the pixmap as an 8-bit RGB PNG
+ *
+ * Every row uses the Sub filter, which turns runs of equal pixels into zeros
+ * that the matcher collapses into long back-references.
+ *
+ * @param writer Output
+ * @param pixmap Source pixmap
+ */
+static void write_png(Writer *writer, const Pixmap *pixmap)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    writer_bytes(writer, signature, sizeof(signature));
+
+    uint8_t header[13] = {
+        (uint8_t)(pixmap->width >> 24), (uint8_t)(pixmap->width >> 16), (uint8_t)(pixmap->width >> 8), (uint8_t)pixmap->width,
+        (uint8_t)(pixmap->height >> 24), (uint8_t)(pixmap->height >> 16), (uint8_t)(pixmap->height >> 8), (uint8_t)pixmap->height,
+        8, // Bit depth
+        2, // Color type RGB
+        0, 0, 0,
+    };
+    png_chunk(writer, "IHDR", header, sizeof(header));
+
+    size_t row_bytes = (size_t)pixmap->width * 3;
+    uint8_t *rgb = (uint8_t *)malloc(row_bytes);
+    uint8_t *filtered = (uint8_t *)malloc(row_bytes + 1);
+    RowReader reader;
+    bool ready = row_reader_init(&reader, pixmap);
+    // Always initialized, so that a partial allocation is released below
+    Deflater deflater;
+    ready = deflate_init(&deflater, writer) && ready;
+    if (rgb == NULL || filtered == NULL || !ready)
+    {
+        writer->failed = true;
+        free(rgb);
+        free(filtered);
+        deflate_release(&deflater);
+        row_reader_release(&reader);
+        return;
+    }
+
+    ConvertFn convert = select_convert(IMAGE_PPM);
+    for (int32_t y = 0; y < pixmap->height; y++)
+    {
+        convert(rgb, row_reader_row(&reader, y), (size_t)pixmap->width);
+
+        filtered[0] = 1; // Sub filter
+        memcpy(filtered + 1, rgb, 3);
+        for (size_t i = 3; i < row_bytes; i++)
+            filtered[1 + i] = (uint8_t)(rgb[i] - rgb[i - 3]);
+
+        deflate_feed(&deflater, filtered, row_bytes + 1);
+    }
+    deflate_finish(&deflater);
+    deflate_release(&deflater);
+    row_reader_release(&reader);
+    free(rgb);
+    free(filtered);
+
+    png_chunk(writer, "IEND", NULL, 0);
+}
+#pragma endregion PNG
+
+#pragma region Delta
+/**
+ * @brief Writes the changed regions of the pixmap in the IMAGE_DELTA layout
+ *
+ */
+static void write_delta(Writer *writer, const Pixmap *pixmap)
+{
+    Rect rects[PIXMAP_DIRTY_MAX];
+    size_t count = pixmap_dirty_rects(pixmap, rects, PIXMAP_DIRTY_MAX);
+
+    writer_bytes(writer, "RDLT", 4);
+    writer_u32be(writer, (uint32_t)pixmap->width);
+    writer_u32be(writer, (uint32_t)pixmap->height);
+    writer_u32be(writer, (uint32_t)count);
+    for (size_t i = 0; i < count && !writer->failed; i++)
+    {
+        const Rect *rect = &rects[i];
+        writer_u32be(writer, (uint32_t)rect->x0);
+        writer_u32be(writer, (uint32_t)rect->y0);
+        writer_u32be(writer, (uint32_t)(rect->x1 - rect->x0));
+        writer_u32be(writer, (uint32_t)(rect->y1 - rect->y0));
+        write_pixels(writer, pixmap, rect, IMAGE_RGBA);
+    }
+}
+#pragma endregion Delta
+
+/**
+ * @brief Encodes the pixmap into any writer
+ *
+ * @param writer Output
+ * @param pixmap Source pixmap
+ * @param format Output format
+ */
+static void write_image(Writer *writer, const Pixmap *pixmap, ImageFormat format)
+{
+    PROBE_TIMER("export");
+    Rect all = {0, 0, pixmap->width, pixmap->height};
+    switch (format)
+    {
+    case IMAGE_PPM:
+    {
+        char header[64];
+        int length = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", pixmap->width, pixmap->height);
+        writer_bytes(writer, header, (size_t)length);
+        write_pixels(writer, pixmap, &all, IMAGE_PPM);
+        break;
+    }
+    case IMAGE_RGBA:
+    case IMAGE_RAW:
+        write_pixels(writer, pixmap, &all, format);
+        break;
+    case IMAGE_PNG:
+        write_png(writer, pixmap);
+        break;
+    case IMAGE_DELTA:
+        write_delta(writer, pixmap);
+        break;
+    }
+}
+
+bool pixmap_export_fd(const Pixmap *pixmap, int fd, ImageFormat format)
+{
+    Writer writer;
+    if (!writer_init_fd(&writer, fd))
+    {
+        free(writer.buffer);
+        return false;
+    }
+    write_image(&writer, pixmap, format);
+    return writer_finish(&writer);
+}
+
+bool pixmap_export_file(const Pixmap *pixmap, const char *path, ImageFormat format)
+{
+    int fd = open_fd(path, OPEN_FLAGS, OPEN_MODE);
+    if (fd < 0)
+        return false;
+
+    bool ok = pixmap_export_fd(pixmap, fd, format);
+    if (close_fd(fd) != 0)
+        ok = false;
+    return ok;
+}
+
+size_t pixmap_export_memory(const Pixmap *pixmap, uint8_t *buffer, size_t capacity, ImageFormat format)
+{
+    Writer writer;
+    if (!writer_init_memory(&writer, buffer, capacity))
+    {
+        free(writer.buffer);
+        return 0;
+    }
+    write_image(&writer, pixmap, format);
+    writer_finish(&writer);
+    return writer.total;
+}
+
+size_t pixmap_export_bound(const Pixmap *pixmap, ImageFormat format)
+{
+    size_t pixels = (size_t)pixmap->width * (size_t)pixmap->height;
+    switch (format)
+    {
+    case IMAGE_PPM:
+        return 32 + pixels * 3;
+    case IMAGE_RGBA:
+    case IMAGE_RAW:
+        return pixels * 4;
+    case IMAGE_DELTA:
+        return 16 + PIXMAP_DIRTY_MAX * 16 + pixels * 4; // The rectangles are disjoint
+    case IMAGE_PNG:
+    {
+        // Every input byte costs at most 9 bits, plus block, chunk and file overhead
+        size_t raw = (size_t)pixmap->height * ((size_t)pixmap->width * 3 + 1);
+        size_t compressed = raw + raw / 8 + (raw / DEFLATE_BLOCK + 2) * 4 + 16;
+        return compressed + (compressed / IDAT_CHUNK_SIZE + 1) * 12 + 8 + 25 + 12;
+    }
+    }
+    return 0;
+}
+
+void pixmap_export(const Pixmap *pixmap)
+{
+    pixmap_export_file(pixmap, "pixmap.ppm", IMAGE_PPM);
+}
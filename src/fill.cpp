@@ -0,0 +1,571 @@
+/**
+ * @file fill.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <fill.h>
+#include <pool.h>
+
+#include "cpu.h"
+#include "raster.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Sizes of the span stacks and bands
+ *
+ */
+enum
+{
+    FILL_STACK_BASE = 256,   // Segments every stack holds on top of those per row
+    FILL_STACK_PER_ROW = 4,  // Segments per row of a band
+    FILL_BAND_MIN_ROWS = 64, // Smallest band of a parallel fill
+};
+
+/**
+ * @brief Pixels [x0, x1] of row y that may continue the region
+ *
+ */
+typedef struct FillSegment
+{
+    int32_t y, x0, x1;
+} FillSegment;
+
+/**
+ * @brief The region being filled and the pixels found so far
+ *
+ * Pixels are only read while the region is searched, so the search does not
+ * depend on the blend mode or on the fill color.
+ */
+typedef struct FillRegion
+{
+    const Pixmap *pixmap;
+    Rect area;      // Clip rectangle the region is confined to
+    uint32_t value; // Value of the seed, or the premultiplied boundary color
+    bool boundary;  // Inside means differing from `value` instead of equal to it
+    uint32_t *mask; // One bit per pixel of `area`, set once the pixel is found
+    size_t words;   // Mask words per row, rows never share a word
+} FillRegion;
+
+/**
+ * @brief Rows [y0, y1) of the area searched by one worker, with its span stack
+ *
+ */
+typedef struct FillBand
+{
+    int32_t y0, y1;
+    FillSegment *stack;
+    size_t size;
+    size_t capacity;
+    bool overflow; // Segments were dropped, the band needs a sweep
+} FillBand;
+
+#pragma region Search
+static inline bool region_inside(const FillRegion *region, int32_t x, int32_t y)
+{
+    uint32_t pixel = *pixmap_pixel(region->pixmap, x, y);
+    return region->boundary ? pixel != region->value : pixel == region->value;
+}
+
+static inline uint32_t *region_bits(const FillRegion *region, int32_t y)
+{
+    return region->mask + (size_t)(y - region->area.y0) * region->words;
+}
+
+static inline bool region_found(const FillRegion *region, int32_t x, int32_t y)
+{
+    int32_t i = x - region->area.x0;
+    return (region_bits(region, y)[i >> 5] >> (i & 31)) & 1u;
+}
+
+/**
+ * @brief Returns the first mask index in [from, end) whose bit equals `set`, or `end`
+ *
+ */
+static int32_t region_next(const uint32_t *bits, int32_t from, int32_t end, bool set)
+{
+    while (from < end)
+    {
+        uint32_t word = (set ? bits[from >> 5] : ~bits[from >> 5]) & (~0u << (from & 31));
+        if (word != 0)
+        {
+            int32_t i = (from & ~31) + (int32_t)bit_lowest(word);
+            return i < end ? i : end;
+        }
+        from = (from & ~31) + 32;
+    }
+    return end;
+}
+
+/**
+ * @brief Sets the mask bits of [x0, x1] on row y
+ *
+ */
+static void region_mark(FillRegion *region, int32_t x0, int32_t x1, int32_t y)
+{
+    uint32_t *bits = region_bits(region, y);
+    int32_t i = x0 - region->area.x0, end = x1 - region->area.x0 + 1;
+    while (i < end)
+    {
+        int32_t base = i & ~31;
+        uint32_t word = ~0u << (i & 31);
+        if (end - base < 32)
+            word &= (1u << (end - base)) - 1;
+        bits[i >> 5] |= word;
+        i = base + 32;
+    }
+}
+
+static void region_push(FillBand *band, int32_t y, int32_t x0, int32_t x1)
+{
+    if (y < band->y0 || y >= band->y1)
+        return;
+    if (band->size == band->capacity)
+    {
+        band->overflow = true;
+        return;
+    }
+    band->stack[band->size++] = FillSegment{y, x0, x1};
+}
+
+/**
+ * @brief Finds where a run of inside pixels starting at a pixel ends
+ *
+ * A pixel is inside if it equals `value` exactly when `equal` is set.
+ *
+ * @return First x in [x, end) that is outside, or `end`
+ */
+typedef int32_t (*RunRightFn)(const uint32_t *row, int32_t x, int32_t end, uint32_t value, bool equal);
+
+/**
+ * @brief Finds where a run of inside pixels ending before a pixel starts
+ *
+ * @return Smallest x0 >= begin with every pixel of [x0, x) inside
+ */
+typedef int32_t (*RunLeftFn)(const uint32_t *row, int32_t x, int32_t begin, uint32_t value, bool equal);
+
+static int32_t run_right_scalar(const uint32_t *row, int32_t x, int32_t end, uint32_t value, bool equal)
+{
+    while (x < end && (row[x] == value) == equal)
+        x++;
+    return x;
+}
+
+static int32_t run_left_scalar(const uint32_t *row, int32_t x, int32_t begin, uint32_t value, bool equal)
+{
+    while (x > begin && (row[x - 1] == value) == equal)
+        x--;
+    return x;
+}
+
+#if RENDERER_X86
+TARGET("sse2") static int32_t run_right_sse2(const uint32_t *row, int32_t x, int32_t end, uint32_t value, bool equal)
+{
+    __m128i v = _mm_set1_epi32((int32_t)value);
+    uint32_t flip = equal ? 0 : 0xFu;
+    for (; x + 4 <= end; x += 4)
+    {
+        uint32_t inside = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(row + x)), v))) ^ flip;
+        if (inside != 0xFu)
+            return x + (int32_t)bit_lowest(~inside);
+    }
+    return run_right_scalar(row, x, end, value, equal);
+}
+
+TARGET("sse2") static int32_t run_left_sse2(const uint32_t *row, int32_t x, int32_t begin, uint32_t value, bool equal)
+{
+    __m128i v = _mm_set1_epi32((int32_t)value);
+    uint32_t flip = equal ? 0 : 0xFu;
+    for (; x - 4 >= begin; x -= 4)
+    {
+        uint32_t inside = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(row + x - 4)), v))) ^ flip;
+        if (inside != 0xFu)
+            return x - 3 + (int32_t)bit_highest(~inside & 0xFu);
+    }
+    return run_left_scalar(row, x, begin, value, equal);
+}
+
+TARGET("avx2") static int32_t run_right_avx2(const uint32_t *row, int32_t x, int32_t end, uint32_t value, bool equal)
+{
+    __m256i v = _mm256_set1_epi32((int32_t)value);
+    uint32_t flip = equal ? 0 : 0xFFu;
+    for (; x + 8 <= end; x += 8)
+    {
+        uint32_t inside = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(row + x)), v))) ^ flip;
+        if (inside != 0xFFu)
+            return x + (int32_t)bit_lowest(~inside);
+    }
+    return run_right_scalar(row, x, end, value, equal);
+}
+
+TARGET("avx2") static int32_t run_left_avx2(const uint32_t *row, int32_t x, int32_t begin, uint32_t value, bool equal)
+{
+    __m256i v = _mm256_set1_epi32((int32_t)value);
+    uint32_t flip = equal ? 0 : 0xFFu;
+    for (; x - 8 >= begin; x -= 8)
+    {
+        uint32_t inside = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(row + x - 8)), v))) ^ flip;
+        if (inside != 0xFFu)
+            return x - 7 + (int32_t)bit_highest(~inside & 0xFFu);
+    }
+    return run_left_scalar(row, x, begin, value, equal);
+}
+#endif
+
+static RunRightFn select_run_right(void)
+{
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return run_right_avx2;
+    if (features & CPU_SSE2)
+        return run_right_sse2;
+#endif
+    return run_right_scalar;
+}
+
+static RunLeftFn select_run_left(void)
+{
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return run_left_avx2;
+    if (features & CPU_SSE2)
+        return run_left_sse2;
+#endif
+    return run_left_scalar;
+}
+
+static const RunRightFn run_right = select_run_right();
+static const RunLeftFn run_left = select_run_left();
+
+/**
+ * @brief Records the span through an inside pixel not found yet
+ *
+ * The neighbours of a recorded span are never inside, so the span is extended
+ * to its full length without consulting the mask. The rows above and below
+ * are pushed as segments.
+ *
+ * @return Last x-coordinate of the span
+ */
+static int32_t region_span(FillRegion *region, FillBand *band, int32_t x, int32_t y)
+{
+    int32_t x0 = x, x1 = x;
+    if (region->pixmap->layout == LAYOUT_LINEAR)
+    {
+        const uint32_t *row = pixmap_row(region->pixmap, y);
+        x0 = run_left(row, x, region->area.x0, region->value, !region->boundary);
+        x1 = run_right(row, x + 1, region->area.x1, region->value, !region->boundary) - 1;
+    }
+    else
+    {
+        // Rows of tiled pixmaps are not contiguous, their runs are extended pixel by pixel
+        while (x0 > region->area.x0 && region_inside(region, x0 - 1, y))
+            x0--;
+        while (x1 + 1 < region->area.x1 && region_inside(region, x1 + 1, y))
+            x1++;
+    }
+
+    region_mark(region, x0, x1, y);
+    region_push(band, y - 1, x0, x1);
+    region_push(band, y + 1, x0, x1);
+    return x1;
+}
+
+/**
+ * @brief Records every span through the inside pixels of [x0, x1] on row y
+ *
+ */
+static void region_scan(FillRegion *region, FillBand *band, int32_t y, int32_t x0, int32_t x1)
+{
+    const uint32_t *bits = region_bits(region, y);
+    int32_t base = region->area.x0;
+    int32_t x = x0;
+    while (x <= x1)
+    {
+        x = base + region_next(bits, x - base, x1 + 1 - base, false);
+        if (x > x1)
+            break;
+        if (region_inside(region, x, y))
+            x = region_span(region, band, x, y) + 2; // The pixel after a span is outside
+        else
+            x++;
+    }
+}
+
+static void region_drain(FillRegion *region, FillBand *band)
+{
+    while (band->size > 0)
+    {
+        FillSegment segment = band->stack[--band->size];
+        region_scan(region, band, segment.y, segment.x0, segment.x1);
+    }
+}
+
+/**
+ * @brief Finds the spans of dropped segments again
+ *
+ * A dropped segment lies next to a recorded span in the row above or below, so
+ * every inside pixel not found yet with a found pixel above or below it in the
+ * same band is a seed. Sweeps repeat until no segment is dropped anymore.
+ */
+static void region_sweep(FillRegion *region, FillBand *band)
+{
+    int32_t base = region->area.x0;
+    int32_t width = region->area.x1 - base;
+    for (int32_t y = band->y0; y < band->y1; y++)
+    {
+        const uint32_t *bits = region_bits(region, y);
+        int32_t i = 0;
+        while ((i = region_next(bits, i, width, false)) < width)
+        {
+            int32_t x = base + i;
+            bool seed = (y > band->y0 && region_found(region, x, y - 1)) ||
+                        (y + 1 < band->y1 && region_found(region, x, y + 1));
+            if (seed && region_inside(region, x, y))
+            {
+                i = region_span(region, band, x, y) + 1 - base;
+                region_drain(region, band);
+            }
+            else
+                i++;
+        }
+    }
+}
+
+/**
+ * @brief Searches a band until its stack is empty and nothing was dropped
+ *
+ */
+static void region_run(FillRegion *region, FillBand *band)
+{
+    region_drain(region, band);
+    while (band->overflow)
+    {
+        band->overflow = false;
+        region_sweep(region, band);
+    }
+}
+
+/**
+ * @brief Pushes the pixels of row `to_y` that continue found pixels of the adjacent row `from_y`
+ *
+ * Used between two rounds of a parallel fill, where `from_y` and `to_y` lie on
+ * either side of a band border.
+ */
+static void region_exchange(FillRegion *region, int32_t from_y, FillBand *to, int32_t to_y)
+{
+    const uint32_t *from = region_bits(region, from_y);
+    int32_t base = region->area.x0;
+    int32_t width = region->area.x1 - base;
+    int32_t i = 0;
+    while ((i = region_next(from, i, width, true)) < width)
+    {
+        int32_t x = base + i;
+        if (region_found(region, x, to_y) || !region_inside(region, x, to_y))
+        {
+            i++;
+            continue;
+        }
+        int32_t start = x;
+        while (i + 1 < width && region_found(region, base + i + 1, from_y) &&
+               !region_found(region, base + i + 1, to_y) && region_inside(region, base + i + 1, to_y))
+            i++;
+        region_push(to, to_y, start, base + i);
+        i++;
+    }
+}
+#pragma endregion Search
+
+#pragma region Fill
+/**
+ * @brief Paints the found pixels of rows [y0, y1) as spans
+ *
+ */
+static void region_paint(const FillRegion *region, Pixmap *pixmap, int32_t y0, int32_t y1, uint32_t color)
+{
+    int32_t base = region->area.x0;
+    int32_t width = region->area.x1 - base;
+    for (int32_t y = y0; y < y1; y++)
+    {
+        const uint32_t *bits = region_bits(region, y);
+        int32_t i = 0;
+        while ((i = region_next(bits, i, width, true)) < width)
+        {
+            int32_t end = region_next(bits, i, width, false);
+            span_store(pixmap, base + i, base + end, y, color);
+            i = end;
+        }
+    }
+}
+
+/**
+ * @brief Shared state of a parallel fill
+ *
+ */
+typedef struct FillJob
+{
+    FillRegion *region;
+    FillBand *bands;
+    const size_t *active; // Bands searched in the current round
+    Pixmap *pixmap;
+    uint32_t color;
+} FillJob;
+
+static void region_search_task(void *context, size_t index, int32_t worker)
+{
+    (void)worker;
+    const FillJob *job = (const FillJob *)context;
+    region_run(job->region, &job->bands[job->active[index]]);
+}
+
+static void region_paint_task(void *context, size_t index, int32_t worker)
+{
+    (void)worker;
+    PROBE_PART();
+    PROBE_PRIMITIVE(STAT_FILL);
+    const FillJob *job = (const FillJob *)context;
+    const FillBand *band = &job->bands[index];
+    region_paint(job->region, job->pixmap, band->y0, band->y1, job->color);
+}
+
+/**
+ * @brief Splits the rows of the area into bands on PIXMAP_DIRTY_TILE borders
+ *
+ * Tile-aligned bands keep the dirty flags of different workers apart.
+ *
+ * @return Number of bands, at least 1 and at most `count`
+ */
+static size_t region_bands(const Rect *area, size_t count, FillBand *bands)
+{
+    int64_t rows = area->y1 - area->y0;
+    size_t used = 0;
+    int32_t y = area->y0;
+    for (size_t i = 1; i <= count; i++)
+    {
+        int64_t end = area->y0 + rows * (int64_t)i / (int64_t)count;
+        end = (end + PIXMAP_DIRTY_TILE - 1) / PIXMAP_DIRTY_TILE * PIXMAP_DIRTY_TILE;
+        if (i == count || end > area->y1)
+            end = area->y1;
+        if (end <= y)
+            continue;
+        bands[used] = FillBand{};
+        bands[used].y0 = y;
+        bands[used].y1 = (int32_t)end;
+        y = (int32_t)end;
+        used++;
+    }
+    return used;
+}
+
+/**
+ * @brief Searches and paints a region, on the workers of `pool` if it has several
+ *
+ */
+static bool region_fill(Pixmap *pixmap, RenderPool *pool, int32_t x, int32_t y, bool boundary, uint32_t value, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_FILL);
+    const Rect *clip = &pixmap->clip;
+    if (x < clip->x0 || x >= clip->x1 || y < clip->y0 || y >= clip->y1)
+        return true;
+
+    FillRegion region = {pixmap, *clip, boundary ? value : *pixmap_pixel(pixmap, x, y), boundary, NULL, 0};
+    if (!region_inside(&region, x, y))
+        return true;
+
+    int32_t rows = clip->y1 - clip->y0;
+    size_t count = 1;
+    if (pool != NULL && render_pool_threads(pool) > 1 && rows >= 2 * FILL_BAND_MIN_ROWS)
+    {
+        count = (size_t)render_pool_threads(pool);
+        if (count > (size_t)(rows / FILL_BAND_MIN_ROWS))
+            count = (size_t)(rows / FILL_BAND_MIN_ROWS);
+    }
+
+    region.words = (size_t)(clip->x1 - clip->x0 + 31) / 32;
+    region.mask = (uint32_t *)calloc((size_t)rows * region.words, sizeof(uint32_t));
+    FillBand *bands = (FillBand *)malloc(count * sizeof(FillBand));
+    size_t *active = (size_t *)malloc(count * sizeof(size_t));
+    FillSegment *stacks = NULL;
+    if (region.mask != NULL && bands != NULL && active != NULL)
+    {
+        count = region_bands(clip, count, bands);
+        stacks = (FillSegment *)malloc(((size_t)FILL_STACK_BASE * count + (size_t)FILL_STACK_PER_ROW * (size_t)rows) * sizeof(FillSegment));
+    }
+    if (stacks == NULL)
+    {
+        free(region.mask);
+        free(bands);
+        free(active);
+        return false;
+    }
+
+    FillBand *seed = bands;
+    for (size_t i = 0, offset = 0; i < count; i++)
+    {
+        bands[i].stack = stacks + offset;
+        bands[i].capacity = FILL_STACK_BASE + FILL_STACK_PER_ROW * (size_t)(bands[i].y1 - bands[i].y0);
+        offset += bands[i].capacity;
+        if (y >= bands[i].y0 && y < bands[i].y1)
+            seed = &bands[i];
+    }
+    region_span(&region, seed, x, y);
+
+    FillJob job = {&region, bands, active, pixmap, color};
+    if (count == 1)
+    {
+        region_run(&region, bands);
+        region_paint(&region, pixmap, clip->y0, clip->y1, color);
+    }
+    else
+    {
+        for (;;)
+        {
+            size_t searched = 0;
+            for (size_t i = 0; i < count; i++)
+                if (bands[i].size > 0 || bands[i].overflow)
+                    active[searched++] = i;
+            if (searched == 0)
+                break;
+            render_pool_run(pool, searched, region_search_task, &job);
+
+            // Spans ending at a band border continue in the neighbouring band next round
+            for (size_t i = 0; i + 1 < count; i++)
+            {
+                int32_t border = bands[i + 1].y0;
+                region_exchange(&region, border - 1, &bands[i + 1], border);
+                region_exchange(&region, border, &bands[i], border - 1);
+            }
+        }
+        render_pool_run(pool, count, region_paint_task, &job);
+    }
+
+    free(stacks);
+    free(region.mask);
+    free(bands);
+    free(active);
+    return true;
+}
+
+bool flood_fill(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color)
+{
+    return region_fill(pixmap, NULL, x, y, false, 0, color);
+}
+
+bool boundary_fill(Pixmap *pixmap, int32_t x, int32_t y, uint32_t boundary, uint32_t color)
+{
+    return region_fill(pixmap, NULL, x, y, true, color_premultiply(boundary), color);
+}
+
+bool flood_fill_parallel(Pixmap *pixmap, RenderPool *pool, int32_t x, int32_t y, uint32_t color)
+{
+    return region_fill(pixmap, pool, x, y, false, 0, color);
+}
+
+bool boundary_fill_parallel(Pixmap *pixmap, RenderPool *pool, int32_t x, int32_t y, uint32_t boundary, uint32_t color)
+{
+    return region_fill(pixmap, pool, x, y, true, color_premultiply(boundary), color);
+}
+#pragma endregion Fill
@@ -0,0 +1,232 @@
+/**
+ * @file layout.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <pixmap.h>
+
+#include "cpu.h"
+#include "raster.h"
+
+#include <string.h>
+
+/**
+ * @brief Copies whole tiles of a row of tiles into linear rows
+ *
+ * @param src First pixel of the first tile
+ * @param tiles Number of tiles, one after another
+ * @param dst Receives the pixels of the first tile row at its first pixel
+ * @param dst_stride Distance between two rows of `dst` in pixels
+ */
+typedef void (*DetileFn)(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride);
+
+#pragma region Detile Kernels
+template <uint32_t SHIFT>
+static void detile_rows_scalar(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride)
+{
+    const uint32_t size = 1u << SHIFT;
+    for (size_t t = 0; t < tiles; t++, src += size * size, dst += size)
+        for (uint32_t v = 0; v < size; v++)
+            memcpy(dst + v * dst_stride, src + (v << SHIFT), size * sizeof(uint32_t));
+}
+
+template <uint32_t SHIFT>
+static void detile_morton_scalar(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride)
+{
+    const uint32_t size = 1u << SHIFT;
+    for (size_t t = 0; t < tiles; t++, src += size * size, dst += size)
+        for (uint32_t v = 0; v < size; v++)
+            for (uint32_t u = 0; u < size; u++)
+                dst[v * dst_stride + u] = src[morton_spread(u) | morton_spread(v) << 1];
+}
+
+#if RENDERER_X86
+/*
+ * In Morton order a tile consists of 4x4 blocks of 16 pixels, in Morton order
+ * themselves. A block holds four 2x2 quads, each as its top pair followed by
+ * its bottom pair, so two quads side by side give two rows of the block by
+ * interleaving their halves.
+ */
+
+template <uint32_t SHIFT>
+TARGET("sse2") static void detile_morton_sse2(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride)
+{
+    const uint32_t size = 1u << SHIFT;
+    const uint32_t blocks = size / 4;
+    for (size_t t = 0; t < tiles; t++, src += size * size, dst += size)
+        for (uint32_t by = 0; by < blocks; by++)
+            for (uint32_t bx = 0; bx < blocks; bx++)
+            {
+                const __m128i *block = (const __m128i *)(src + 16 * (morton_spread(bx) | morton_spread(by) << 1));
+                __m128i q0 = _mm_load_si128(block + 0), q1 = _mm_load_si128(block + 1);
+                __m128i q2 = _mm_load_si128(block + 2), q3 = _mm_load_si128(block + 3);
+
+                uint32_t *out = dst + 4 * by * dst_stride + 4 * bx;
+                _mm_storeu_si128((__m128i *)(out + 0 * dst_stride), _mm_unpacklo_epi64(q0, q1));
+                _mm_storeu_si128((__m128i *)(out + 1 * dst_stride), _mm_unpackhi_epi64(q0, q1));
+                _mm_storeu_si128((__m128i *)(out + 2 * dst_stride), _mm_unpacklo_epi64(q2, q3));
+                _mm_storeu_si128((__m128i *)(out + 3 * dst_stride), _mm_unpackhi_epi64(q2, q3));
+            }
+}
+
+/**
+ * @brief Detiles two neighbouring 4x4 blocks at once, which follow each other in memory
+ *
+ * The 64-bit interleave works within 128-bit lanes, a permutation then puts
+ * the halves of both blocks in order.
+ */
+template <uint32_t SHIFT>
+TARGET("avx2") static void detile_morton_avx2(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride)
+{
+    const uint32_t size = 1u << SHIFT;
+    const uint32_t blocks = size / 4;
+    for (size_t t = 0; t < tiles; t++, src += size * size, dst += size)
+        for (uint32_t by = 0; by < blocks; by++)
+            for (uint32_t bx = 0; bx < blocks; bx += 2)
+            {
+                const __m256i *pair = (const __m256i *)(src + 16 * (morton_spread(bx) | morton_spread(by) << 1));
+                __m256i top0 = _mm256_load_si256(pair + 0), bottom0 = _mm256_load_si256(pair + 1);
+                __m256i top1 = _mm256_load_si256(pair + 2), bottom1 = _mm256_load_si256(pair + 3);
+
+                uint32_t *out = dst + 4 * by * dst_stride + 4 * bx;
+                _mm256_storeu_si256((__m256i *)(out + 0 * dst_stride),
+                                    _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(top0, top1), 0xD8));
+                _mm256_storeu_si256((__m256i *)(out + 1 * dst_stride),
+                                    _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(top0, top1), 0xD8));
+                _mm256_storeu_si256((__m256i *)(out + 2 * dst_stride),
+                                    _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(bottom0, bottom1), 0xD8));
+                _mm256_storeu_si256((__m256i *)(out + 3 * dst_stride),
+                                    _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(bottom0, bottom1), 0xD8));
+            }
+}
+
+template <uint32_t SHIFT>
+TARGET("avx2") static void detile_rows_avx2(const uint32_t *src, size_t tiles, uint32_t *dst, size_t dst_stride)
+{
+    const uint32_t size = 1u << SHIFT;
+    for (size_t t = 0; t < tiles; t++, src += size * size, dst += size)
+        for (uint32_t v = 0; v < size; v++)
+            for (uint32_t u = 0; u < size; u += 8)
+                _mm256_storeu_si256((__m256i *)(dst + v * dst_stride + u),
+                                    _mm256_load_si256((const __m256i *)(src + (v << SHIFT) + u)));
+}
+#endif
+
+/**
+ * @brief Picks the detile kernel of a tiled layout for the running CPU
+ *
+ */
+static DetileFn select_detile(PixmapLayout layout)
+{
+    bool morton = layout_morton(layout);
+    bool large = layout_shift(layout) == 4;
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+    {
+        if (morton)
+            return large ? detile_morton_avx2<4> : detile_morton_avx2<3>;
+        return large ? detile_rows_avx2<4> : detile_rows_avx2<3>;
+    }
+    if (morton && (features & CPU_SSE2))
+        return large ? detile_morton_sse2<4> : detile_morton_sse2<3>;
+#endif
+    if (morton)
+        return large ? detile_morton_scalar<4> : detile_morton_scalar<3>;
+    return large ? detile_rows_scalar<4> : detile_rows_scalar<3>;
+}
+
+static const DetileFn detile_kernels[4] = {
+    select_detile(LAYOUT_TILED8),
+    select_detile(LAYOUT_TILED16),
+    select_detile(LAYOUT_MORTON8),
+    select_detile(LAYOUT_MORTON16),
+};
+#pragma endregion Detile Kernels
+
+/**
+ * @brief Copies [0, width) of row y pixel run by pixel run
+ *
+ */
+static void read_row(const Pixmap *pixmap, int32_t y, uint32_t *dst)
+{
+    for (int32_t x = 0, run; x < pixmap->width; x += run)
+    {
+        run = pixmap_run(pixmap, x) < pixmap->width - x ? pixmap_run(pixmap, x) : pixmap->width - x;
+        memcpy(dst + x, pixmap_pixel(pixmap, x, y), (size_t)run * sizeof(uint32_t));
+    }
+}
+
+void pixmap_read_rows(const Pixmap *pixmap, int32_t y, int32_t count, uint32_t *dst, size_t dst_stride)
+{
+    if (pixmap->layout == LAYOUT_LINEAR)
+    {
+        for (int32_t r = 0; r < count; r++)
+            memcpy(dst + (size_t)r * dst_stride, pixmap_row(pixmap, y + r), (size_t)pixmap->width * sizeof(uint32_t));
+        return;
+    }
+
+    uint32_t shift = layout_shift(pixmap->layout);
+    int32_t size = 1 << shift;
+    DetileFn detile = detile_kernels[(layout_morton(pixmap->layout) ? 2 : 0) + (shift == 4 ? 1 : 0)];
+    size_t tiles = (size_t)(pixmap->width >> shift);
+    int32_t edge = (int32_t)(tiles << shift);
+
+    for (int32_t row = y, end = y + count; row < end;)
+    {
+        // Rows of tiles that are requested as a whole are detiled tile by tile, the rest row by row
+        if ((row & (size - 1)) != 0 || end - row < size || tiles == 0)
+        {
+            read_row(pixmap, row, dst + (size_t)(row - y) * dst_stride);
+            row++;
+            continue;
+        }
+
+        uint32_t *out = dst + (size_t)(row - y) * dst_stride;
+        detile(pixmap_pixel(pixmap, 0, row), tiles, out, dst_stride);
+        for (int32_t v = 0; v < size && edge < pixmap->width; v++)
+            for (int32_t x = edge; x < pixmap->width; x++)
+                out[(size_t)v * dst_stride + (size_t)x] = *pixmap_pixel(pixmap, x, row + v);
+        row += size;
+    }
+}
+
+uint32_t pixmap_get_pixel(const Pixmap *pixmap, int32_t x, int32_t y)
+{
+    return *pixmap_pixel(pixmap, x, y);
+}
+
+void pixmap_write_rows(Pixmap *pixmap, int32_t y, int32_t count, const uint32_t *src, size_t src_stride)
+{
+    for (int32_t row = y; row < y + count; row++)
+    {
+        const uint32_t *colors = src + (size_t)(row - y) * src_stride;
+        dirty_mark(pixmap, 0, pixmap->width, row);
+        for (int32_t x = 0, run; x < pixmap->width; x += run)
+        {
+            run = pixmap_run(pixmap, x) < pixmap->width - x ? pixmap_run(pixmap, x) : pixmap->width - x;
+            uint32_t *dst = pixmap_pixel(pixmap, x, row);
+            for (int32_t i = 0; i < run; i++)
+                dst[i] = color_premultiply(colors[x + i]);
+        }
+    }
+}
+
+uint32_t color_unpremultiply(uint32_t pixel)
+{
+    uint32_t a = pixel & 0xFFu;
+    if (a == 0xFFu)
+        return pixel;
+    if (a == 0)
+        return 0;
+
+    uint32_t color = a;
+    for (uint32_t shift = 8; shift < 32; shift += 8)
+    {
+        uint32_t channel = (((pixel >> shift) & 0xFFu) * 255u + a / 2) / a;
+        color |= (channel < 0xFFu ? channel : 0xFFu) << shift;
+    }
+    return color;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file mapped.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <defs.h>
+#include <mapped.h>
+#include <stats.h>
+
+#include "convert.h"
+#include "probe.h"
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+struct MappedImage
+{
+    Pixmap pixmap;       // Whole image, its pixels are the file or the scratch memory
+    ImageFormat format;  // Layout of the pixels in the file
+    int fd;              // The open file
+    uint8_t *map;        // Mapping of the whole file
+    size_t map_size;     // Size of the file in bytes
+    size_t header;       // Bytes in front of the first pixel
+    uint32_t *scratch;   // Reserved pixels of the converted formats, NULL for IMAGE_RAW
+    size_t scratch_size; // Size of the reservation in bytes
+    uint8_t *converted;  // Flag per row, set once the row is final in the file
+    bool failed;         // A write back failed
+};
+
+#ifndef _WIN32
+#pragma region Pages
+/**
+ * @brief Returns the size of a memory page
+ *
+ */
+static size_t page_size(void)
+{
+    static const size_t size = (size_t)sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+/**
+ * @brief Schedules the bytes [begin, end) of the file for writing and drops them from the process
+ *
+ * The pages stay in the page cache until the system has written them, but no
+ * longer count towards the memory of the process. Pages only partly inside the
+ * range are included, their other rows are read back from the cache when needed.
+ */
+static void map_release(MappedImage *image, size_t begin, size_t end)
+{
+    size_t page = page_size();
+    begin = begin / page * page;
+    end = end < image->map_size ? end : image->map_size;
+    if (begin >= end)
+        return;
+    if (msync(image->map + begin, end - begin, MS_ASYNC) != 0)
+        image->failed = true;
+    madvise(image->map + begin, end - begin, MADV_DONTNEED);
+}
+
+/**
+ * @brief Discards the scratch rows [0, y1)
+ *
+ * Only whole pages are discarded, since a page shared with row y1 still holds
+ * pixels of the next band. The last band also discards its partial page.
+ */
+static void scratch_release(MappedImage *image, int32_t y1)
+{
+    size_t page = page_size();
+    size_t end = (size_t)y1 * (size_t)image->pixmap.stride * sizeof(uint32_t);
+    end = y1 == image->pixmap.height ? image->scratch_size : end / page * page;
+    if (end > 0)
+        madvise(image->scratch, end, MADV_DONTNEED);
+}
+#pragma endregion Pages
+
+#pragma region Rows
+/**
+ * @brief Converts the scratch rows [y0, y1) into the layout of the file
+ *
+ * @param all true to convert rows which are already final as well
+ */
+static void rows_convert(MappedImage *image, int32_t y0, int32_t y1, bool all)
+{
+    if (image->scratch == NULL)
+        return;
+
+    ConvertFn convert = select_convert(image->format);
+    size_t width = (size_t)image->pixmap.width;
+    size_t row_bytes = width * convert_pixel_bytes(image->format);
+    for (int32_t y = y0; y < y1; y++)
+    {
+        if (!all && image->converted[y])
+            continue;
+        convert(image->map + image->header + (size_t)y * row_bytes, pixmap_row(&image->pixmap, y), width);
+        image->converted[y] = 1;
+    }
+}
+
+/**
+ * @brief Clears the rows [y0, y1) to a color, including their padding
+ *
+ */
+static void rows_clear(MappedImage *image, int32_t y0, int32_t y1, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_CLEAR);
+    Pixmap *pixmap = &image->pixmap;
+    Rect area = {0, y0, pixmap->stride, y1};
+    PROBE_CLEAR(pixmap, &area);
+
+    size_t count = (size_t)(y1 - y0) * (size_t)pixmap->stride;
+    SpanKernel kernel = count >= SPAN_STREAM_MIN ? span_kernel_stream : span_kernel;
+    kernel(pixmap_row(pixmap, y0), count, color_premultiply(color));
+    dirty_clear(pixmap, &area);
+}
+#pragma endregion Rows
+
+MappedImage *mapped_image_create(const char *path, int32_t width, int32_t height, ImageFormat format)
+{
+    if (width <= 0 || height <= 0 || (format != IMAGE_RAW && format != IMAGE_PPM && format != IMAGE_RGBA))
+        return NULL;
+
+    char header[64];
+    int header_size = format == IMAGE_PPM ? snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height) : 0;
+
+    // The scratch rows are padded like those of pixmap_create
+    const int32_t pixels_per_block = PIXMAP_ALIGNMENT / sizeof(uint32_t);
+    int64_t stride = format == IMAGE_RAW ? width : ((int64_t)width + pixels_per_block - 1) / pixels_per_block * pixels_per_block;
+    if (stride > INT32_MAX || (size_t)height > SIZE_MAX / 4 / (size_t)stride)
+        return NULL;
+    size_t pixels = (size_t)width * (size_t)height;
+    size_t map_size = (size_t)header_size + pixels * convert_pixel_bytes(format);
+
+    MappedImage *image = (MappedImage *)calloc(1, sizeof(MappedImage));
+    if (image == NULL)
+        return NULL;
+    image->format = format;
+    image->map_size = map_size;
+    image->header = (size_t)header_size;
+    image->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (image->fd < 0)
+    {
+        free(image);
+        return NULL;
+    }
+
+#ifdef __linux__
+    bool allocated = posix_fallocate(image->fd, 0, (off_t)map_size) == 0;
+#else
+    bool allocated = ftruncate(image->fd, (off_t)map_size) == 0;
+#endif
+    void *map = allocated ? mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, image->fd, 0) : MAP_FAILED;
+    if (map == MAP_FAILED)
+    {
+        close(image->fd);
+        free(image);
+        return NULL;
+    }
+    image->map = (uint8_t *)map;
+    memcpy(image->map, header, image->header);
+
+    uint32_t *pixel_storage = (uint32_t *)image->map;
+    if (format != IMAGE_RAW)
+    {
+        // Address space for the whole image, pages are only allocated once they are drawn
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        image->scratch_size = (size_t)stride * (size_t)height * sizeof(uint32_t);
+        void *scratch = mmap(NULL, image->scratch_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        image->converted = (uint8_t *)calloc((size_t)height, 1);
+        if (scratch == MAP_FAILED || image->converted == NULL)
+        {
+            if (scratch != MAP_FAILED)
+                munmap(scratch, image->scratch_size);
+            free(image->converted);
+            munmap(image->map, map_size);
+            close(image->fd);
+            free(image);
+            return NULL;
+        }
+        image->scratch = (uint32_t *)scratch;
+        pixel_storage = image->scratch;
+    }
+
+    image->pixmap.pixels = pixel_storage;
+    image->pixmap.width = width;
+    image->pixmap.height = height;
+    image->pixmap.stride = (int32_t)stride;
+    image->pixmap.blend = BLEND_NONE;
+    image->pixmap.dirty = NULL;
+    image->pixmap.layout = LAYOUT_LINEAR;
+    pixmap_reset_clip(&image->pixmap);
+    return image;
+}
+
+Pixmap *mapped_image_pixmap(MappedImage *image)
+{
+    return &image->pixmap;
+}
+
+bool mapped_image_render(MappedImage *image, int32_t band_height, uint32_t background, RenderBand render, void *context)
+{
+    Pixmap *pixmap = &image->pixmap;
+    int32_t height = pixmap->height;
+    if (band_height <= 0 || band_height > height)
+        band_height = height;
+
+    size_t row_bytes = (size_t)pixmap->width * convert_pixel_bytes(image->format);
+    for (int32_t y0 = 0, y1; y0 < height; y0 = y1)
+    {
+        PROBE_TIMER("band");
+        y1 = height - y0 > band_height ? y0 + band_height : height;
+        rows_clear(image, y0, y1, background);
+        pixmap_set_clip(pixmap, 0, y0, pixmap->width, y1 - y0);
+        render(context, pixmap);
+
+        rows_convert(image, y0, y1, true);
+        map_release(image, image->header + (size_t)y0 * row_bytes, image->header + (size_t)y1 * row_bytes);
+        if (image->scratch != NULL)
+            scratch_release(image, y1);
+    }
+    pixmap_reset_clip(pixmap);
+    return !image->failed;
+}
+
+bool mapped_image_close(MappedImage *image)
+{
+    if (image == NULL)
+        return true;
+
+    rows_convert(image, 0, image->pixmap.height, false);
+    bool ok = !image->failed;
+    if (msync(image->map, image->map_size, MS_SYNC) != 0)
+        ok = false;
+    munmap(image->map, image->map_size);
+    if (image->scratch != NULL)
+        munmap(image->scratch, image->scratch_size);
+    if (close(image->fd) != 0)
+        ok = false;
+
+    free(image->converted);
+    free(image->pixmap.dirty);
+    free(image);
+    return ok;
+}
+#else
+MappedImage *mapped_image_create(const char *path, int32_t width, int32_t height, ImageFormat format)
+{
+    (void)path;
+    (void)width;
+    (void)height;
+    (void)format;
+    return NULL;
+}
+
+Pixmap *mapped_image_pixmap(MappedImage *image)
+{
+    (void)image;
+    return NULL;
+}
+
+bool mapped_image_render(MappedImage *image, int32_t band_height, uint32_t background, RenderBand render, void *context)
+{
+    (void)image;
+    (void)band_height;
+    (void)background;
+    (void)render;
+    (void)context;
+    return false;
+}
+
+bool mapped_image_close(MappedImage *image)
+{
+    (void)image;
+    return true;
+}
+#endif
@@ -0,0 +1,281 @@
+/**
+ * @file pool.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <pool.h>
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+enum
+{
+    POOL_MAX_THREADS = 256,
+};
+
+/**
+ * @brief Remaining tasks of one worker
+ *
+ * The range [begin, end) is packed into one word as begin | end << 32 so that
+ * the owner and the thieves can shrink it with a single compare-and-swap.
+ * Every queue sits on its own cache line.
+ */
+typedef struct alignas(64) WorkQueue
+{
+    std::atomic<uint64_t> range;
+} WorkQueue;
+
+/**
+ * @brief The job currently being run
+ *
+ */
+typedef struct PoolJob
+{
+    RenderTask task;
+    void *context;
+    size_t base; // Index of task 0 of the queues
+} PoolJob;
+
+struct RenderPool
+{
+    int32_t threads;
+    std::thread *workers; // threads - 1 background workers
+    WorkQueue *queues;    // One per worker, the caller uses queue 0
+
+    std::mutex run_mutex; // Serializes render_pool_run
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    PoolJob job;
+    uint64_t generation; // Incremented for every job
+    int32_t pending;     // Background workers still busy with the job
+    bool stop;
+};
+
+static uint64_t range_pack(uint32_t begin, uint32_t end)
+{
+    return (uint64_t)begin | (uint64_t)end << 32;
+}
+
+/**
+ * @brief Takes the first task of a queue, only called by its owner
+ *
+ * @return false if the queue is empty
+ */
+static bool queue_pop(WorkQueue *queue, uint32_t *index)
+{
+    uint64_t range = queue->range.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+        if (begin >= end)
+            return false;
+        if (queue->range.compare_exchange_weak(range, range_pack(begin + 1, end), std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+        {
+            *index = begin;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Takes the upper half of the tasks of another queue
+ *
+ * Stealing from the end keeps the owner working on neighbouring tasks, which
+ * for tiles means neighbouring memory.
+ *
+ * @return false if the queue is empty
+ */
+static bool queue_steal(WorkQueue *queue, uint32_t *begin, uint32_t *end)
+{
+    uint64_t range = queue->range.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t first = (uint32_t)range, last = (uint32_t)(range >> 32);
+        if (first >= last)
+            return false;
+        uint32_t middle = last - (last - first + 1) / 2;
+        if (queue->range.compare_exchange_weak(range, range_pack(first, middle), std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+        {
+            *begin = middle;
+            *end = last;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Runs tasks until no worker has any left
+ *
+ * Tasks never create new tasks, so once every queue is empty the job is done
+ * apart from the tasks that other workers are already running.
+ *
+ * @param pool Pool
+ * @param worker Index of the calling worker
+ */
+static void pool_work(RenderPool *pool, int32_t worker)
+{
+    const PoolJob job = pool->job;
+    WorkQueue *own = &pool->queues[worker];
+
+    for (;;)
+    {
+        uint32_t index;
+        while (queue_pop(own, &index))
+            job.task(job.context, job.base + index, worker);
+
+        bool stolen = false;
+        for (int32_t i = 1; i < pool->threads && !stolen; i++)
+        {
+            uint32_t begin, end;
+            if (queue_steal(&pool->queues[(worker + i) % pool->threads], &begin, &end))
+            {
+                // Only this worker refills its own empty queue, thieves merely fail on it meanwhile
+                own->range.store(range_pack(begin, end), std::memory_order_release);
+                stolen = true;
+            }
+        }
+        if (!stolen)
+            return;
+    }
+}
+
+/**
+ * @brief Main loop of a background worker
+ *
+ */
+static void pool_thread(RenderPool *pool, int32_t worker)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wake.wait(lock, [&] { return pool->stop || pool->generation != seen; });
+            if (pool->stop)
+                return;
+            seen = pool->generation;
+        }
+
+        pool_work(pool, worker);
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (--pool->pending == 0)
+            pool->done.notify_one();
+    }
+}
+
+RenderPool *render_pool_create(int32_t threads)
+{
+    if (threads <= 0)
+        threads = (int32_t)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    if (threads > POOL_MAX_THREADS)
+        threads = POOL_MAX_THREADS;
+
+    RenderPool *pool = new (std::nothrow) RenderPool();
+    if (pool == NULL)
+        return NULL;
+    pool->threads = threads;
+    pool->queues = new (std::nothrow) WorkQueue[threads];
+    pool->workers = new (std::nothrow) std::thread[threads - 1];
+    if (pool->queues == NULL || pool->workers == NULL)
+    {
+        delete[] pool->queues;
+        delete[] pool->workers;
+        delete pool;
+        return NULL;
+    }
+    for (int32_t i = 0; i < threads; i++)
+        pool->queues[i].range.store(0, std::memory_order_relaxed);
+
+    for (int32_t i = 1; i < threads; i++)
+    {
+        try
+        {
+            pool->workers[i - 1] = std::thread(pool_thread, pool, i);
+        }
+        catch (...)
+        {
+            // Too few threads available, run with the ones already started
+            pool->threads = i;
+            break;
+        }
+    }
+    return pool;
+}
+
+void render_pool_destroy(RenderPool *pool)
+{
+    if (pool == NULL)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stop = true;
+    }
+    pool->wake.notify_all();
+    for (int32_t i = 0; i < pool->threads - 1; i++)
+        pool->workers[i].join();
+
+    delete[] pool->workers;
+    delete[] pool->queues;
+    delete pool;
+}
+
+int32_t render_pool_threads(const RenderPool *pool)
+{
+    return pool->threads;
+}
+
+void render_pool_run(RenderPool *pool, size_t count, RenderTask task, void *context)
+{
+    std::lock_guard<std::mutex> run_lock(pool->run_mutex);
+
+    if (pool->threads == 1)
+    {
+        for (size_t i = 0; i < count; i++)
+            task(context, i, 0);
+        return;
+    }
+
+    // The queues hold 32-bit indices, larger jobs run in several rounds
+    for (size_t base = 0; base < count; base += UINT32_MAX)
+    {
+        uint32_t round = (uint32_t)(count - base < UINT32_MAX ? count - base : UINT32_MAX);
+
+        // Deal out contiguous ranges, stealing evens out the differences in cost
+        uint32_t threads = (uint32_t)pool->threads;
+        for (uint32_t i = 0; i < threads; i++)
+        {
+            uint32_t begin = (uint32_t)((uint64_t)round * i / threads);
+            uint32_t end = (uint32_t)((uint64_t)round * (i + 1) / threads);
+            pool->queues[i].range.store(range_pack(begin, end), std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            pool->job.task = task;
+            pool->job.context = context;
+            pool->job.base = base;
+            pool->pending = pool->threads - 1;
+            pool->generation++;
+        }
+        pool->wake.notify_all();
+
+        pool_work(pool, 0);
+
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        pool->done.wait(lock, [&] { return pool->pending == 0; });
+    }
+}
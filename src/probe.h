@@ -0,0 +1,86 @@
+/**
+ * @file probe.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Instrumentation hooks placed in the rasterizers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * The hooks feed the counters of stats.h. Without RENDERER_STATS they expand
+ * to nothing, so an uninstrumented build carries no trace of them.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pixmap.h>
+#include <stats.h>
+
+#ifndef RENDERER_STATS
+    #define RENDERER_STATS 0
+#endif
+
+#if RENDERER_STATS
+void probe_enter(StatPrimitive primitive);
+void probe_leave(void);
+void probe_write(const Pixmap *pixmap, int32_t x, int32_t y, size_t count);
+void probe_reject(size_t count);
+void probe_clear(const Pixmap *pixmap, const Rect *area);
+uint64_t probe_now(void);
+void probe_event(const char *name, uint64_t begin);
+void probe_part_enter(void);
+void probe_part_leave(void);
+void probe_calls(StatPrimitive primitive, uint64_t calls);
+
+/**
+ * @brief Attributes everything until the end of the scope to a primitive type
+ *
+ * Nested scopes belong to the outermost one.
+ */
+struct ProbeScope
+{
+    explicit ProbeScope(StatPrimitive primitive) { probe_enter(primitive); }
+    ~ProbeScope() { probe_leave(); }
+};
+
+/**
+ * @brief Marks everything until the end of the scope as part of calls counted elsewhere
+ *
+ * Bands and tiles of one replay or fill still add their pixels and time, but
+ * neither a call nor a trace event, so a primitive drawn in many pieces
+ * counts once. The caller adds the calls with `PROBE_CALLS`.
+ */
+struct ProbePart
+{
+    ProbePart() { probe_part_enter(); }
+    ~ProbePart() { probe_part_leave(); }
+};
+
+/**
+ * @brief Records a trace event spanning the scope
+ *
+ */
+struct ProbeTimer
+{
+    const char *name;
+    uint64_t begin;
+    explicit ProbeTimer(const char *name) : name(name), begin(probe_now()) {}
+    ~ProbeTimer() { probe_event(name, begin); }
+};
+
+    #define PROBE_PRIMITIVE(primitive) ProbeScope probe_scope(primitive)
+    #define PROBE_TIMER(name) ProbeTimer probe_timer(name)
+    #define PROBE_PART() ProbePart probe_part
+    #define PROBE_CALLS(primitive, calls) probe_calls(primitive, calls)
+    #define PROBE_WRITE(pixmap, x, y, count) probe_write(pixmap, x, y, count)
+    #define PROBE_REJECT(count) probe_reject(count)
+    #define PROBE_CLEAR(pixmap, area) probe_clear(pixmap, area)
+#else
+    #define PROBE_PRIMITIVE(primitive) ((void)0)
+    #define PROBE_TIMER(name) ((void)0)
+    #define PROBE_PART() ((void)0)
+    #define PROBE_CALLS(primitive, calls) ((void)0)
+    #define PROBE_WRITE(pixmap, x, y, count) ((void)0)
+    #define PROBE_REJECT(count) ((void)0)
+    #define PROBE_CLEAR(pixmap, area) ((void)0)
+#endif
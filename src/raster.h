@@ -0,0 +1,536 @@
+/**
+ * @file raster.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Unchecked pixel and span stores shared by the rasterizers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Every rasterizer writes through these helpers once its primitive has been
+ * clipped, so they are the single place where pixels reach memory.
+ */
+#pragma once
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pixmap.h>
+
+#include "probe.h"
+
+/**
+ * @brief Fills `count` pixels starting at `dst` with one color
+ *
+ */
+typedef void (*SpanKernel)(uint32_t *dst, size_t count, uint32_t color);
+
+/**
+ * @brief Fastest span fill for this processor (AVX2, SSE2 or scalar)
+ *
+ */
+extern const SpanKernel span_kernel;
+
+/**
+ * @brief Span fill with non-temporal stores
+ *
+ * Bypasses the caches, which pays off for fills much larger than the cache
+ * whose pixels are not read again soon, such as full-surface clears.
+ */
+extern const SpanKernel span_kernel_stream;
+
+/**
+ * @brief Size thresholds for choosing a span kernel
+ *
+ * Spans shorter than SPAN_KERNEL_MIN are filled inline instead of through a kernel.
+ */
+enum
+{
+    SPAN_KERNEL_MIN = 16,
+    MASK_KERNEL_MIN = 8,       // Shorter coverage runs, such as the edge pixels of a shape, are blended inline
+    SPAN_STREAM_MIN = 1 << 18, // Clears of at least this many pixels bypass the caches
+};
+
+/**
+ * @brief Returns the first pixel of a row of a linear pixmap
+ *
+ * @param pixmap Pixmap with LAYOUT_LINEAR
+ * @param y Row index inside the pixmap
+ */
+static inline uint32_t *pixmap_row(const Pixmap *pixmap, int32_t y)
+{
+    return pixmap->pixels + (size_t)y * (size_t)pixmap->stride;
+}
+
+/**
+ * @brief Returns log2 of the tile size of a layout, 0 for LAYOUT_LINEAR
+ *
+ */
+static inline uint32_t layout_shift(PixmapLayout layout)
+{
+    return (uint32_t)layout & 0xFu;
+}
+
+/**
+ * @brief Returns true if the pixels inside the tiles are in Morton order
+ *
+ */
+static inline bool layout_morton(PixmapLayout layout)
+{
+    return ((uint32_t)layout & 0x10u) != 0;
+}
+
+/**
+ * @brief Spreads the low four bits of v to the even bit positions
+ *
+ */
+static inline uint32_t morton_spread(uint32_t v)
+{
+    v = (v | v << 2) & 0x33u;
+    return (v | v << 1) & 0x55u;
+}
+
+/**
+ * @brief Returns the number of pixels in the storage, including the padding
+ *
+ */
+static inline size_t pixmap_storage(const Pixmap *pixmap)
+{
+    uint32_t mask = (1u << layout_shift(pixmap->layout)) - 1;
+    size_t rows = ((size_t)pixmap->height + mask) & ~(size_t)mask;
+    return rows * (size_t)pixmap->stride;
+}
+
+/**
+ * @brief Returns the address of a pixel, for any layout
+ *
+ * A tile starts at the first row of its row of tiles, `stride` pixels per row,
+ * plus one whole tile for every tile to its left.
+ *
+ * @param pixmap Pixmap
+ * @param x Column inside the storage, up to the stride
+ * @param y Row inside the storage
+ */
+static inline uint32_t *pixmap_pixel(const Pixmap *pixmap, int32_t x, int32_t y)
+{
+    if (pixmap->layout == LAYOUT_LINEAR)
+        return pixmap_row(pixmap, y) + x;
+
+    uint32_t shift = layout_shift(pixmap->layout);
+    uint32_t mask = (1u << shift) - 1;
+    uint32_t u = (uint32_t)x & mask, v = (uint32_t)y & mask;
+    size_t tile = (size_t)((uint32_t)y & ~mask) * (size_t)pixmap->stride + ((size_t)((uint32_t)x & ~mask) << shift);
+    uint32_t inner = layout_morton(pixmap->layout) ? morton_spread(u) | morton_spread(v) << 1 : v << shift | u;
+    return pixmap->pixels + tile + inner;
+}
+
+/**
+ * @brief Returns the number of pixels from (x, y) on to the right that follow each other in memory
+ *
+ * Spans are written run by run: rows of linear pixmaps are a single run,
+ * tiled pixmaps break them at every tile border, Morton order into pairs.
+ */
+static inline int32_t pixmap_run(const Pixmap *pixmap, int32_t x)
+{
+    if (pixmap->layout == LAYOUT_LINEAR)
+        return INT32_MAX;
+    if (layout_morton(pixmap->layout))
+        return 2 - (x & 1);
+    int32_t size = 1 << layout_shift(pixmap->layout);
+    return size - (x & (size - 1));
+}
+
+/**
+ * @brief Returns the half-width of a disc row
+ *
+ * A pixel (x, y) belongs to a disc of radius r if x² + y² <= r² + r, which is
+ * the integer form of lying inside the circle of radius r + 1/2. This covers
+ * every pixel of `draw_circle` and leaves no gaps between the rows.
+ *
+ * @param limit r² + r
+ * @param dy Row offset from the center
+ * @return Largest x with x² + dy² <= limit
+ */
+static inline int64_t disc_half_width(int64_t limit, int64_t dy)
+{
+    int64_t remaining = limit - dy * dy;
+    int64_t hw = (int64_t)sqrt((double)remaining);
+    while (hw * hw > remaining)
+        hw--;
+    while ((hw + 1) * (hw + 1) <= remaining)
+        hw++;
+    return hw;
+}
+
+/**
+ * @brief Flags kept for every dirty tile
+ *
+ */
+enum
+{
+    DIRTY_SHIFT = 4,        // log2 of PIXMAP_DIRTY_TILE
+    DIRTY_CHANGED = 1 << 0, // Changed since the last pixmap_dirty_reset
+    DIRTY_DRAWN = 1 << 1,   // Drawn since the last clear
+};
+static_assert(PIXMAP_DIRTY_TILE == 1 << DIRTY_SHIFT, "DIRTY_SHIFT must match PIXMAP_DIRTY_TILE");
+
+/**
+ * @brief Returns the number of dirty tiles per row of tiles
+ *
+ */
+static inline int32_t dirty_columns(const Pixmap *pixmap)
+{
+    return (pixmap->width + PIXMAP_DIRTY_TILE - 1) >> DIRTY_SHIFT;
+}
+
+/**
+ * @brief Returns the number of rows of dirty tiles
+ *
+ */
+static inline int32_t dirty_rows(const Pixmap *pixmap)
+{
+    return (pixmap->height + PIXMAP_DIRTY_TILE - 1) >> DIRTY_SHIFT;
+}
+
+/**
+ * @brief Marks the tiles of a drawn span [x0, x1) on row y
+ *
+ * Tiles divide the 64x64 tiles of a parallel replay, so its workers never
+ * mark the same flag.
+ */
+static inline void dirty_mark(const Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y)
+{
+    if (pixmap->dirty == NULL)
+        return;
+    uint8_t *row = pixmap->dirty + (size_t)(y >> DIRTY_SHIFT) * (size_t)dirty_columns(pixmap);
+    for (int32_t tile = x0 >> DIRTY_SHIFT; tile <= (x1 - 1) >> DIRTY_SHIFT; tile++)
+        row[tile] = DIRTY_CHANGED | DIRTY_DRAWN;
+}
+
+/**
+ * @brief Records a clear of an area, which may extend into the row padding
+ *
+ * Tiles covered completely are no longer drawn, partly covered ones keep
+ * their flag, since the rest of them may still hold drawn pixels.
+ */
+static inline void dirty_clear(const Pixmap *pixmap, const Rect *area)
+{
+    if (pixmap->dirty == NULL)
+        return;
+    int32_t x1 = area->x1 < pixmap->width ? area->x1 : pixmap->width;
+    int32_t columns = dirty_columns(pixmap);
+    for (int32_t ty = area->y0 >> DIRTY_SHIFT; ty <= (area->y1 - 1) >> DIRTY_SHIFT; ty++)
+    {
+        int32_t top = ty << DIRTY_SHIFT;
+        int32_t bottom = top + PIXMAP_DIRTY_TILE < pixmap->height ? top + PIXMAP_DIRTY_TILE : pixmap->height;
+        bool rows_covered = top >= area->y0 && bottom <= area->y1;
+        uint8_t *row = pixmap->dirty + (size_t)ty * (size_t)columns;
+        for (int32_t tx = area->x0 >> DIRTY_SHIFT; tx <= (x1 - 1) >> DIRTY_SHIFT; tx++)
+        {
+            int32_t left = tx << DIRTY_SHIFT;
+            int32_t right = left + PIXMAP_DIRTY_TILE < pixmap->width ? left + PIXMAP_DIRTY_TILE : pixmap->width;
+            if (rows_covered && left >= area->x0 && right <= x1)
+                row[tx] = DIRTY_CHANGED;
+            else
+                row[tx] |= DIRTY_CHANGED;
+        }
+    }
+}
+
+/**
+ * @brief Stores a premultiplied color into an area, which may extend into the row padding
+ *
+ * A raw store without blending, instrumentation or dirty marks, for clears.
+ * Whole rows of linear pixmaps and whole rows of tiles of tiled pixmaps are
+ * contiguous and filled with a single kernel call.
+ */
+static inline void area_fill(const Pixmap *pixmap, const Rect *area, uint32_t color)
+{
+    if (pixmap->layout == LAYOUT_LINEAR)
+    {
+        if (area->x0 == 0 && area->x1 == pixmap->stride)
+        {
+            span_kernel(pixmap_row(pixmap, area->y0), (size_t)pixmap->stride * (size_t)(area->y1 - area->y0), color);
+            return;
+        }
+        for (int32_t y = area->y0; y < area->y1; y++)
+            span_kernel(pixmap_row(pixmap, y) + area->x0, (size_t)(area->x1 - area->x0), color);
+        return;
+    }
+
+    uint32_t shift = layout_shift(pixmap->layout);
+    int32_t size = 1 << shift;
+    for (int32_t top = area->y0 & ~(size - 1); top < area->y1; top += size)
+    {
+        int32_t y0 = top > area->y0 ? top : area->y0;
+        int32_t y1 = top + size < area->y1 ? top + size : area->y1;
+        int32_t x0 = area->x0, x1 = area->x1;
+        if (y0 == top && y1 == top + size)
+        {
+            // The whole tiles of the row of tiles are contiguous
+            int32_t tx0 = (x0 + size - 1) >> shift, tx1 = x1 >> shift;
+            if (tx0 < tx1)
+            {
+                span_kernel(pixmap_pixel(pixmap, tx0 << shift, top), (size_t)(tx1 - tx0) << (2 * shift), color);
+                for (int32_t y = y0; y < y1; y++)
+                {
+                    for (int32_t x = x0; x < tx0 << shift; x++)
+                        *pixmap_pixel(pixmap, x, y) = color;
+                    for (int32_t x = tx1 << shift; x < x1; x++)
+                        *pixmap_pixel(pixmap, x, y) = color;
+                }
+                continue;
+            }
+        }
+        for (int32_t y = y0; y < y1; y++)
+            for (int32_t x = x0; x < x1; x++)
+                *pixmap_pixel(pixmap, x, y) = color;
+    }
+}
+
+/**
+ * @brief Blends `count` pixels starting at `dst` with one premultiplied color
+ *
+ */
+extern const SpanKernel blend_kernels[BLEND_MULTIPLY + 1];
+
+/**
+ * @brief Blends `count` pixels with one premultiplied color scaled by a coverage per pixel
+ *
+ * Pixels with coverage 0 keep their value. As in `pixel_blend`, BLEND_NONE
+ * composites like BLEND_SRC_OVER.
+ */
+typedef void (*MaskKernel)(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color);
+
+/**
+ * @brief Fastest coverage kernels for this processor, indexed by blend mode
+ *
+ */
+extern const MaskKernel mask_kernels[BLEND_MULTIPLY + 1];
+
+/**
+ * @brief Divides a product of two 8-bit values by 255, rounded
+ *
+ * Exact for every x in [0, 255 * 255], and shared by the scalar and vector kernels.
+ */
+static inline uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * @brief Converts a color to premultiplied alpha
+ *
+ */
+static inline uint32_t color_premultiply(uint32_t color)
+{
+    uint32_t a = color & 0xFFu;
+    if (a == 0xFFu)
+        return color;
+    uint32_t r = div255((color >> 24) * a);
+    uint32_t g = div255(((color >> 16) & 0xFFu) * a);
+    uint32_t b = div255(((color >> 8) & 0xFFu) * a);
+    return r << 24 | g << 16 | b << 8 | a;
+}
+
+/**
+ * @brief Combines a premultiplied color with one pixel
+ *
+ * Reference for the blend kernels, which produce exactly the same results.
+ *
+ * @param mode Any mode but BLEND_NONE
+ * @param dst Premultiplied destination color
+ * @param src Premultiplied source color
+ */
+static inline uint32_t color_composite(BlendMode mode, uint32_t dst, uint32_t src)
+{
+    if (mode == BLEND_SRC_OVER)
+    {
+        // Two channels per 16-bit lane: s + div255(d * (255 - sa)), saturated
+        uint32_t inv = 255 - (src & 0xFFu);
+        uint32_t lanes[2] = {dst & 0x00FF00FFu, (dst >> 8) & 0x00FF00FFu};
+        uint32_t srcs[2] = {src & 0x00FF00FFu, (src >> 8) & 0x00FF00FFu};
+        for (int i = 0; i < 2; i++)
+        {
+            uint32_t x = lanes[i] * inv + 0x00800080u;
+            x = ((x + ((x >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+            x += srcs[i];
+            lanes[i] = (x | ((x >> 8) & 0x00010001u) * 0xFFu) & 0x00FF00FFu;
+        }
+        return lanes[0] | lanes[1] << 8;
+    }
+
+    uint32_t sa = src & 0xFFu;
+    uint32_t da = dst & 0xFFu;
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        uint32_t s = (src >> shift) & 0xFFu;
+        uint32_t d = (dst >> shift) & 0xFFu;
+        uint32_t value;
+        if (mode == BLEND_ADD)
+            value = s + d;
+        else
+            value = div255(d * (s + 255 - sa) + s * (255 - da));
+        result |= (value > 255 ? 255 : value) << shift;
+    }
+    return result;
+}
+
+/**
+ * @brief Scales every channel of a premultiplied color by a coverage of 0 to 255
+ *
+ */
+static inline uint32_t color_scale(uint32_t color, uint32_t coverage)
+{
+    uint32_t rb = ((color >> 8) & 0x00FF00FFu) * coverage + 0x00800080u;
+    uint32_t ga = (color & 0x00FF00FFu) * coverage + 0x00800080u;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    ga = ((ga + ((ga >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    return rb << 8 | ga;
+}
+
+/**
+ * @brief Returns true if a color drawn into the pixmap is a plain store
+ *
+ */
+static inline bool color_is_store(const Pixmap *pixmap, uint32_t color)
+{
+    return (color & 0xFFu) == 0xFFu && pixmap->blend <= BLEND_SRC_OVER;
+}
+
+/**
+ * @brief Stores one pixel which is known to lie inside the pixmap
+ *
+ */
+static inline void pixel_store(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color)
+{
+    PROBE_WRITE(pixmap, x, y, 1);
+    dirty_mark(pixmap, x, x + 1, y);
+    uint32_t *dst = pixmap_pixel(pixmap, x, y);
+    if (color_is_store(pixmap, color))
+        *dst = color;
+    else if (pixmap->blend == BLEND_NONE)
+        *dst = color_premultiply(color);
+    else
+        *dst = color_composite(pixmap->blend, *dst, color_premultiply(color));
+}
+
+/**
+ * @brief Fills [x0, x1) on row y of a tiled pixmap, one contiguous run at a time
+ *
+ */
+static inline void span_store_runs(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color)
+{
+    bool store = color_is_store(pixmap, color) || pixmap->blend == BLEND_NONE;
+    color = color_premultiply(color);
+    if (!store && color == 0)
+        return;
+    for (int32_t x = x0, count; x < x1; x += count)
+    {
+        count = pixmap_run(pixmap, x) < x1 - x ? pixmap_run(pixmap, x) : x1 - x;
+        uint32_t *dst = pixmap_pixel(pixmap, x, y);
+        if (!store)
+            blend_kernels[pixmap->blend](dst, (size_t)count, color);
+        else
+            for (int32_t i = 0; i < count; i++)
+                dst[i] = color;
+    }
+}
+
+/**
+ * @brief Fills [x0, x1) on row y, which is known to lie inside the pixmap
+ *
+ */
+static inline void span_store(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color)
+{
+    PROBE_WRITE(pixmap, x0, y, (size_t)(x1 - x0));
+    dirty_mark(pixmap, x0, x1, y);
+    if (pixmap->layout != LAYOUT_LINEAR)
+    {
+        span_store_runs(pixmap, x0, x1, y, color);
+        return;
+    }
+    uint32_t *dst = pixmap_row(pixmap, y) + x0;
+    size_t count = (size_t)(x1 - x0);
+    if (!color_is_store(pixmap, color))
+    {
+        color = color_premultiply(color);
+        if (pixmap->blend == BLEND_NONE)
+            span_kernel(dst, count, color);
+        else if (color != 0) // Transparent black leaves every mode unchanged
+            blend_kernels[pixmap->blend](dst, count, color);
+        return;
+    }
+    if (count < SPAN_KERNEL_MIN)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = color;
+        return;
+    }
+    span_kernel(dst, count, color);
+}
+
+/**
+ * @brief Blends a partially covered pixel which is known to lie inside the pixmap
+ *
+ * The color is scaled by `coverage` and combined with the pixel by the blend
+ * mode of the pixmap, where BLEND_NONE composites like BLEND_SRC_OVER, since a
+ * partly covered pixel keeps part of what was there before.
+ *
+ * @param pixmap Target pixmap
+ * @param x x-coordinate of the pixel
+ * @param y y-coordinate of the pixel
+ * @param color 4 byte integer representing the color in RGBA format
+ * @param coverage Fraction of the pixel covered, 0 to 255
+ */
+static inline void pixel_blend(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color, uint32_t coverage)
+{
+    uint32_t src = color_premultiply(color);
+    if (coverage < 255)
+        src = color_scale(src, coverage);
+    PROBE_WRITE(pixmap, x, y, 1);
+    dirty_mark(pixmap, x, x + 1, y);
+    BlendMode mode = pixmap->blend == BLEND_NONE ? BLEND_SRC_OVER : pixmap->blend;
+    uint32_t *dst = pixmap_pixel(pixmap, x, y);
+    *dst = color_composite(mode, *dst, src);
+}
+
+/**
+ * @brief Blends [x0, x1) on row y, which is known to lie inside the pixmap, with a coverage per pixel
+ *
+ * @param pixmap Target pixmap
+ * @param x0 First x-coordinate of the run
+ * @param x1 x-coordinate one past the end of the run
+ * @param y y-coordinate of the run
+ * @param coverage Coverage of every pixel of the run, 0 to 255
+ * @param color Premultiplied color
+ */
+static inline void mask_store(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, const uint8_t *coverage, uint32_t color)
+{
+    PROBE_WRITE(pixmap, x0, y, (size_t)(x1 - x0));
+    dirty_mark(pixmap, x0, x1, y);
+    if (x1 - x0 < MASK_KERNEL_MIN)
+    {
+        BlendMode mode = pixmap->blend == BLEND_NONE ? BLEND_SRC_OVER : pixmap->blend;
+        for (int32_t x = x0; x < x1; x++)
+            if (coverage[x - x0] != 0)
+            {
+                uint32_t *dst = pixmap_pixel(pixmap, x, y);
+                *dst = color_composite(mode, *dst, color_scale(color, coverage[x - x0]));
+            }
+        return;
+    }
+    MaskKernel kernel = mask_kernels[pixmap->blend];
+    if (pixmap->layout == LAYOUT_LINEAR)
+    {
+        kernel(pixmap_row(pixmap, y) + x0, coverage, (size_t)(x1 - x0), color);
+        return;
+    }
+    for (int32_t x = x0, run; x < x1; x += run, coverage += run)
+    {
+        run = pixmap_run(pixmap, x) < x1 - x ? pixmap_run(pixmap, x) : x1 - x;
+        kernel(pixmap_pixel(pixmap, x, y), coverage, (size_t)run, color);
+    }
+}
@@ -8,19 +8,18 @@
 #include <renderer.h>
 #include <rmath.h>
 
+#include "cpu.h"
+#include "raster.h"
+#include "scan.h"
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include <assert.h>
 
-/**
- * @brief Emulates a display
- *
- */
-static uint32_t pixmap[RES];
-
 /**
  * @brief Swaps two integers
  *
@@ -34,52 +33,351 @@ static void swapi(int32_t *a, int32_t *b)
     *b = temp;
 }
 
-void pixmap_clear(uint32_t color)
+/**
+ * @brief Target of the spans produced by the scan converter
+ *
+ */
+typedef struct SpanTarget
 {
-    for (uint32_t i = 0; i < RES; i++)
-        pixmap[i] = color;
+    Pixmap *pixmap;
+    uint32_t color;
+} SpanTarget;
+
+static void span_target_fill(void *context, int32_t x0, int32_t x1, int32_t y)
+{
+    SpanTarget *target = (SpanTarget *)context;
+    span_store(target->pixmap, x0, x1, y, target->color);
 }
 
-void pixmap_export(void)
+#pragma region Pixmap
+/**
+ * @brief Allocates memory aligned to `PIXMAP_ALIGNMENT` bytes
+ *
+ * @param size Number of bytes, must be a multiple of `PIXMAP_ALIGNMENT`
+ * @return Pointer to the memory or NULL on failure
+ */
+static void *aligned_malloc(size_t size)
 {
-    FILE *data = fopen("pixmap.ppm", "w");
-    if (data != NULL)
+#ifdef _MSC_VER
+    return _aligned_malloc(size, PIXMAP_ALIGNMENT);
+#else
+    return aligned_alloc(PIXMAP_ALIGNMENT, size);
+#endif
+}
+
+/**
+ * @brief Releases memory obtained from `aligned_malloc`
+ *
+ * @param ptr Pointer to the memory, may be NULL
+ */
+static void aligned_free(void *ptr)
+{
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+Pixmap *pixmap_create(int32_t width, int32_t height)
+{
+    return pixmap_create_layout(width, height, LAYOUT_LINEAR);
+}
+
+Pixmap *pixmap_create_layout(int32_t width, int32_t height, PixmapLayout layout)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+    if (layout != LAYOUT_LINEAR && layout != LAYOUT_TILED8 && layout != LAYOUT_TILED16 && layout != LAYOUT_MORTON8 &&
+        layout != LAYOUT_MORTON16)
+        return NULL;
+
+    // Round every row up to a whole number of aligned blocks and of tiles,
+    // the rows of tiled pixmaps are padded to a whole row of tiles as well
+    const int32_t pixels_per_block = PIXMAP_ALIGNMENT / sizeof(uint32_t);
+    const int32_t tile = 1 << layout_shift(layout);
+    const int32_t granule = tile > pixels_per_block ? tile : pixels_per_block;
+    if (width > INT32_MAX - (granule - 1) || height > INT32_MAX - (tile - 1))
+        return NULL;
+    int32_t stride = (width + granule - 1) / granule * granule;
+    int32_t rows = (height + tile - 1) / tile * tile;
+
+    if ((size_t)rows > SIZE_MAX / sizeof(uint32_t) / (size_t)stride)
+        return NULL;
+    size_t size = (size_t)stride * (size_t)rows * sizeof(uint32_t);
+
+    Pixmap *pixmap = (Pixmap *)malloc(sizeof(Pixmap));
+    if (pixmap == NULL)
+        return NULL;
+
+    pixmap->pixels = (uint32_t *)aligned_malloc(size);
+    if (pixmap->pixels == NULL)
     {
-        fprintf(data, "P3\n%d %d\n255\n", WIDTH, HEIGHT);
-        for (uint32_t i = 0; i < RES; i++)
-        {
-            uint32_t pixel = pixmap[i];
+        free(pixmap);
+        return NULL;
+    }
 
-            uint8_t r = (pixel >> 24) & 0xFF;
-            uint8_t g = (pixel >> 16) & 0xFF;
-            uint8_t b = (pixel >> 8) & 0xFF;
-            uint8_t a = (pixel >> 0) & 0xFF; // If needed in future
+    pixmap->width = width;
+    pixmap->height = height;
+    pixmap->stride = stride;
+    pixmap->blend = BLEND_NONE;
+    pixmap->dirty = NULL;
+    pixmap->layout = layout;
+    pixmap_reset_clip(pixmap);
+    return pixmap;
+}
 
-            fprintf(data, "%d %d %d ", r, g, b);
+void pixmap_destroy(Pixmap *pixmap)
+{
+    if (pixmap == NULL)
+        return;
+    aligned_free(pixmap->pixels);
+    free(pixmap->dirty);
+    free(pixmap);
+}
+
+void pixmap_set_clip(Pixmap *pixmap, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    int64_t x0 = x, y0 = y;
+    int64_t x1 = (int64_t)x + (width > 0 ? width : 0);
+    int64_t y1 = (int64_t)y + (height > 0 ? height : 0);
+
+    pixmap->clip.x0 = (int32_t)(x0 < 0 ? 0 : (x0 > pixmap->width ? pixmap->width : x0));
+    pixmap->clip.y0 = (int32_t)(y0 < 0 ? 0 : (y0 > pixmap->height ? pixmap->height : y0));
+    pixmap->clip.x1 = (int32_t)(x1 < pixmap->clip.x0 ? pixmap->clip.x0 : (x1 > pixmap->width ? pixmap->width : x1));
+    pixmap->clip.y1 = (int32_t)(y1 < pixmap->clip.y0 ? pixmap->clip.y0 : (y1 > pixmap->height ? pixmap->height : y1));
+}
+
+void pixmap_reset_clip(Pixmap *pixmap)
+{
+    pixmap->clip.x0 = 0;
+    pixmap->clip.y0 = 0;
+    pixmap->clip.x1 = pixmap->width;
+    pixmap->clip.y1 = pixmap->height;
+}
+
+void pixmap_set_blend(Pixmap *pixmap, BlendMode mode)
+{
+    pixmap->blend = mode;
+}
+
+void pixmap_clear(Pixmap *pixmap, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_CLEAR);
+    PROBE_CLEAR(pixmap, NULL);
+    color = color_premultiply(color);
+
+    // Rows and rows of tiles are contiguous, so the padding is simply filled along with them
+    size_t count = pixmap_storage(pixmap);
+    if (count >= SPAN_STREAM_MIN)
+        span_kernel_stream(pixmap->pixels, count, color);
+    else
+        span_kernel(pixmap->pixels, count, color);
 
-            if ((i + 1) % WIDTH == 0)
-                fprintf(data, "\n");
+    if (pixmap->dirty != NULL)
+        memset(pixmap->dirty, DIRTY_CHANGED, (size_t)dirty_columns(pixmap) * (size_t)dirty_rows(pixmap));
+}
+
+bool pixmap_track_dirty(Pixmap *pixmap, bool enable)
+{
+    free(pixmap->dirty);
+    pixmap->dirty = NULL;
+    if (!enable)
+        return true;
+
+    size_t tiles = (size_t)dirty_columns(pixmap) * (size_t)dirty_rows(pixmap);
+    pixmap->dirty = (uint8_t *)malloc(tiles);
+    if (pixmap->dirty == NULL)
+        return false;
+    memset(pixmap->dirty, DIRTY_CHANGED | DIRTY_DRAWN, tiles);
+    return true;
+}
+
+/**
+ * @brief Returns the pixels of a run of tiles [tx0, tx1) on tile row ty
+ *
+ */
+static Rect dirty_tile_rect(const Pixmap *pixmap, int32_t tx0, int32_t tx1, int32_t ty)
+{
+    Rect rect;
+    rect.x0 = tx0 << DIRTY_SHIFT;
+    rect.y0 = ty << DIRTY_SHIFT;
+    rect.x1 = tx1 << DIRTY_SHIFT < pixmap->width ? tx1 << DIRTY_SHIFT : pixmap->width;
+    rect.y1 = rect.y0 + PIXMAP_DIRTY_TILE < pixmap->height ? rect.y0 + PIXMAP_DIRTY_TILE : pixmap->height;
+    return rect;
+}
+
+static int64_t rect_area(const Rect *rect)
+{
+    return (int64_t)(rect->x1 - rect->x0) * (int64_t)(rect->y1 - rect->y0);
+}
+
+/**
+ * @brief Merges the tiles carrying a flag into at most `capacity` disjoint rectangles
+ *
+ * First every row of tiles is split into runs, and a run continues the
+ * rectangle above it if that spans the same columns. If that needs too many
+ * rectangles, every row of tiles is reduced to the run from its first to its
+ * last flagged tile instead. Rectangles of different rows never overlap, so
+ * whenever the list is full, the two neighbours whose union adds the fewest
+ * pixels are merged.
+ */
+static size_t dirty_collect(const Pixmap *pixmap, uint8_t flag, Rect *rects, size_t capacity)
+{
+    if (capacity == 0)
+        return 0;
+    if (pixmap->dirty == NULL)
+    {
+        rects[0] = Rect{0, 0, pixmap->width, pixmap->height};
+        return 1;
+    }
+
+    int32_t columns = dirty_columns(pixmap);
+    int32_t rows = dirty_rows(pixmap);
+    size_t count = 0;
+    bool overflow = false;
+    for (int32_t ty = 0; ty < rows && !overflow; ty++)
+    {
+        const uint8_t *row = pixmap->dirty + (size_t)ty * (size_t)columns;
+        for (int32_t tx = 0; tx < columns && !overflow; tx++)
+        {
+            if (!(row[tx] & flag))
+                continue;
+            int32_t end = tx + 1;
+            while (end < columns && (row[end] & flag))
+                end++;
+
+            Rect run = dirty_tile_rect(pixmap, tx, end, ty);
+            size_t above = 0;
+            while (above < count && !(rects[above].y1 == run.y0 && rects[above].x0 == run.x0 && rects[above].x1 == run.x1))
+                above++;
+            if (above < count)
+                rects[above].y1 = run.y1;
+            else if (count < capacity)
+                rects[count++] = run;
+            else
+                overflow = true;
+            tx = end;
+        }
+    }
+    if (!overflow)
+        return count;
+
+    count = 0;
+    for (int32_t ty = 0; ty < rows; ty++)
+    {
+        const uint8_t *row = pixmap->dirty + (size_t)ty * (size_t)columns;
+        int32_t first = 0, last = columns - 1;
+        while (first < columns && !(row[first] & flag))
+            first++;
+        if (first == columns)
+            continue;
+        while (!(row[last] & flag))
+            last--;
+
+        Rect span = dirty_tile_rect(pixmap, first, last + 1, ty);
+        Rect *previous = count > 0 ? &rects[count - 1] : NULL;
+        if (previous != NULL && previous->y1 == span.y0 && previous->x0 == span.x0 && previous->x1 == span.x1)
+        {
+            previous->y1 = span.y1;
+            continue;
+        }
+        if (count == capacity)
+        {
+            // Merge the cheapest pair of neighbours, counting the new span as the last one
+            size_t best = 0;
+            int64_t best_cost = INT64_MAX;
+            for (size_t i = 0; i < count; i++)
+            {
+                const Rect *a = &rects[i];
+                const Rect *b = i + 1 < count ? &rects[i + 1] : &span;
+                Rect merged = {a->x0 < b->x0 ? a->x0 : b->x0, a->y0, a->x1 > b->x1 ? a->x1 : b->x1, b->y1};
+                int64_t cost = rect_area(&merged) - rect_area(a) - rect_area(b);
+                if (cost < best_cost)
+                {
+                    best = i;
+                    best_cost = cost;
+                }
+            }
+            Rect *a = &rects[best];
+            const Rect *b = best + 1 < count ? &rects[best + 1] : &span;
+            Rect merged = {a->x0 < b->x0 ? a->x0 : b->x0, a->y0, a->x1 > b->x1 ? a->x1 : b->x1, b->y1};
+            *a = merged;
+            if (best + 1 == count)
+                continue; // The span went into the last rectangle
+            for (size_t i = best + 1; i + 1 < count; i++)
+                rects[i] = rects[i + 1];
+            count--;
         }
+        rects[count++] = span;
+    }
+    return count;
+}
+
+size_t pixmap_dirty_rects(const Pixmap *pixmap, Rect *rects, size_t capacity)
+{
+    return dirty_collect(pixmap, DIRTY_CHANGED, rects, capacity);
+}
+
+void pixmap_dirty_reset(Pixmap *pixmap)
+{
+    if (pixmap->dirty == NULL)
+        return;
+    size_t tiles = (size_t)dirty_columns(pixmap) * (size_t)dirty_rows(pixmap);
+    for (size_t i = 0; i < tiles; i++)
+        pixmap->dirty[i] &= (uint8_t)~DIRTY_CHANGED;
+}
+
+void pixmap_clear_dirty(Pixmap *pixmap, uint32_t color)
+{
+    if (pixmap->dirty == NULL)
+    {
+        pixmap_clear(pixmap, color);
+        return;
+    }
+
+    PROBE_PRIMITIVE(STAT_CLEAR);
+    color = color_premultiply(color);
+    Rect rects[PIXMAP_DIRTY_MAX];
+    size_t count = dirty_collect(pixmap, DIRTY_DRAWN, rects, PIXMAP_DIRTY_MAX);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Rect *rect = &rects[i];
+        PROBE_CLEAR(pixmap, rect);
+        area_fill(pixmap, rect, color);
+        dirty_clear(pixmap, rect);
     }
-    fclose(data);
 }
+#pragma endregion Pixmap
 
 #pragma region Point
-void draw_point(int32_t x, int32_t y, uint32_t color)
+void draw_point(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_POINT);
+    if (clip_outcode(&pixmap->clip, x, y) != CLIP_INSIDE)
+    {
+        PROBE_REJECT(1);
+        return;
+    }
+    pixel_store(pixmap, x, y, color);
+}
+
+void blend_point(Pixmap *pixmap, int32_t x, int32_t y, uint32_t color, uint8_t coverage)
 {
-    if (x >= WIDTH || y >= HEIGHT || y < 0 || x < 0) // TODO: Negative coordinates?
+    PROBE_PRIMITIVE(STAT_POINT);
+    if (clip_outcode(&pixmap->clip, x, y) != CLIP_INSIDE)
+    {
+        PROBE_REJECT(1);
         return;
-    pixmap[y * WIDTH + x] = color;
+    }
+    pixel_blend(pixmap, x, y, color, coverage);
 }
 
-void draw_point_thick(int32_t x, int32_t y, int32_t thickness, uint32_t color)
+void draw_point_thick(Pixmap *pixmap, int32_t x, int32_t y, int32_t thickness, uint32_t color)
 {
+    PROBE_PRIMITIVE(STAT_POINT);
     int32_t radius = thickness / 2;
-    for (int32_t dx = -radius; dx <= radius; dx++)
-        for (int32_t dy = -radius; dy <= radius; dy++)
-        {
-            draw_point(x + dx, y + dy, color);
-        }
+    fill_rect(pixmap, x - radius, y - radius, 2 * radius + 1, 2 * radius + 1, color);
 }
 #pragma endregion Point
 
@@ -90,82 +388,138 @@ void draw_point_thick(int32_t x, int32_t y, int32_t thickness, uint32_t color)
  * This function draws a vertical line segment by plotting individual points
  * from y0 to y1 (exclusive). If y0 > y1, they are swapped to maintain drawing order.
  *
+ * @param pixmap Target pixmap
  * @param x x-axis coordinate where the vertical line is drawn
  * @param y0 starting y-coordinate
  * @param y1 ending y-coordinate
  * @param color 4 byte integer which represents a color (RGBA)
  */
-static void draw_vertical_line(int32_t x, int32_t y0, int32_t y1, uint32_t color)
+static void draw_vertical_line(Pixmap *pixmap, int32_t x, int32_t y0, int32_t y1, uint32_t color)
 {
     if (y0 == y1)
     {
-        draw_point(x, y0, color);
+        draw_point(pixmap, x, y0, color);
         return;
     }
 
     if (y0 > y1)
         swapi(&y0, &y1);
 
+    const Rect *clip = &pixmap->clip;
+    if (x < clip->x0 || x >= clip->x1)
+        return;
+    if (y0 < clip->y0)
+        y0 = clip->y0;
+    if (y1 > clip->y1)
+        y1 = clip->y1;
+
     for (int32_t y = y0; y < y1; y++)
-    {
-        draw_point(x, y, color);
-    }
+        pixel_store(pixmap, x, y, color);
 }
 
 /**
  * @brief Draws a horizontal line at a specified y-coordinate between two x-coordinates
  *
- * This function draws a horizontal line segment by plotting individual points
- * from x0 to x1 (exclusive). If x1 > x0, they are swapped to maintain drawing order.
+ * This function draws a horizontal line segment as one clipped span
+ * from x0 to x1 (exclusive). If x0 > x1, they are swapped to maintain drawing order.
  *
+ * @param pixmap Target pixmap
  * @param x0 starting x-coordinate
  * @param x1 ending x-coordinate
  * @param y y-axis coordinate where the horizontal line is drawn
  * @param color 4 byte integer which represents a color (RGBA)
  */
-static void draw_horizontal_line(int32_t x0, int32_t x1, int32_t y, uint32_t color)
+static void draw_horizontal_line(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color)
 {
     if (x0 == x1)
     {
-        draw_point(x0, y, color);
+        draw_point(pixmap, x0, y, color);
         return;
     }
 
-    if (x1 > x0)
-        swapi(&x0, &x1);
-
-    for (int32_t x = x0; x < x1; x++)
-        draw_point(x, y, color);
+    fill_span(pixmap, x0, x1, y, color);
 }
 
 // TODO: Add description
-static bool handle_basic_lines(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) //TODO: Add thickness?
+static bool handle_basic_lines(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) //TODO: Add thickness?
 {
     if (x0 == x1 && y0 == y1)
     {
-        draw_point(x0, y0, color);
+        draw_point(pixmap, x0, y0, color);
         return true;
     }
 
     if (x0 == x1)
     {
-        draw_vertical_line(x0, y0, y1, color);
+        draw_vertical_line(pixmap, x0, y0, y1, color);
         return true;
     }
 
     if (y0 == y1)
     {
-        draw_horizontal_line(x0, x1, y0, color);
+        draw_horizontal_line(pixmap, x0, x1, y0, color);
         return true;
     }
 
     return false;
 }
 
-void draw_line_equation(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+/**
+ * @brief Rejects lines whose endpoints lie beyond the same edge of the clip rectangle
+ *
+ * @param pixmap Target pixmap
+ * @param x0 Starting x-coordinate
+ * @param y0 Starting y-coordinate
+ * @param x1 Ending x-coordinate
+ * @param y1 Ending y-coordinate
+ * @return true if the line cannot touch the clip rectangle
+ */
+static bool line_rejected(const Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
 {
+    return (clip_outcode(&pixmap->clip, x0, y0) & clip_outcode(&pixmap->clip, x1, y1)) != 0;
+}
 
-    if (handle_basic_lines(x0, y0, x1, y1, color))
+/**
+ * @brief Restricts the walk of a floating-point line to the clip rectangle
+ *
+ * The line runs along its major axis u from u0 to u1 (u0 <= u1). The visible
+ * part is found with Liang-Barsky and widened by one pixel on both sides, so
+ * rounding near the border cannot drop pixels. The rasterizer still checks
+ * each pixel, but only walks the visible part.
+ *
+ * @param pixmap Target pixmap
+ * @param steep true if u is the y-axis
+ * @param u0 Major coordinate of the start
+ * @param v0 Minor coordinate of the start
+ * @param u1 Major coordinate of the end
+ * @param v1 Minor coordinate of the end
+ * @param first Receives the first major coordinate to visit
+ * @param last Receives the last major coordinate to visit
+ * @return false if nothing is visible
+ */
+static bool clip_major_range(const Pixmap *pixmap, bool steep, int32_t u0, int32_t v0, int32_t u1, int32_t v1, int32_t *first, int32_t *last)
+{
+    double t0, t1;
+    bool visible = steep ? clip_line_liang_barsky(&pixmap->clip, v0, u0, v1, u1, &t0, &t1)
+                         : clip_line_liang_barsky(&pixmap->clip, u0, v0, u1, v1, &t0, &t1);
+    if (!visible)
+        return false;
+
+    double du = (double)u1 - u0;
+    double lo = floor(u0 + t0 * du) - 1;
+    double hi = ceil(u0 + t1 * du) + 1;
+    *first = lo > u0 ? (int32_t)lo : u0;
+    *last = hi < u1 ? (int32_t)hi : u1;
+    return *first <= *last;
+}
+
+void draw_line_equation(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_LINE);
+
+    if (handle_basic_lines(pixmap, x0, y0, x1, y1, color))
+        return;
+    if (line_rejected(pixmap, x0, y0, x1, y1))
         return;
 
     bool steep = abs(y1 - y0) > abs(x1 - x0);
@@ -182,18 +536,28 @@ void draw_line_equation(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t
         swapi(&y0, &y1);
     }
 
+    int32_t first, last;
+    if (!clip_major_range(pixmap, steep, x0, y0, x1, y1, &first, &last))
+        return;
+
     float m = (float)(y1 - y0) / (x1 - x0);
     float b = y0 - m * x0;
-    for (int32_t x = x0; x <= x1; x++) // TODO: Check if inclusive or exclusive
+    for (int32_t x = first; x <= last; x++)
     {
         float y = m * x + b;
-        draw_point(x, roundf(y), color);
+        if (steep)
+            draw_point(pixmap, roundf(y), x, color);
+        else
+            draw_point(pixmap, x, roundf(y), color);
     }
 }
 
-void draw_line_incremental(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+void draw_line_incremental(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
-    if (handle_basic_lines(x0, y0, x1, y1, color))
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (handle_basic_lines(pixmap, x0, y0, x1, y1, color))
+        return;
+    if (line_rejected(pixmap, x0, y0, x1, y1))
         return;
 
     bool steep = abs(y1 - y0) > abs(x1 - x0);
@@ -210,19 +574,31 @@ void draw_line_incremental(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint3
         swapi(&y0, &y1);
     }
 
+    int32_t first, last;
+    if (!clip_major_range(pixmap, steep, x0, y0, x1, y1, &first, &last))
+        return;
+    if (first > x0) // Each pixel shows y one step ahead, so start one column earlier
+        first--;
+
     float m = (y1 - y0) / (float)(x1 - x0);
     float b = y0 - m * x0;
-    float y = m * x0 + b;
-    for (int32_t x = x0; x <= x1; x++) // TODO: Check if inclusive or exclusive
+    float y = m * x0 + b + m * (first - x0); // Restart the accumulation at the first visible column
+    for (int32_t x = first; x <= last; x++)
     {
         y += m;
-        draw_point(x, roundf(y), color);
+        if (steep)
+            draw_point(pixmap, roundf(y), x, color);
+        else
+            draw_point(pixmap, x, roundf(y), color);
     }
 }
 
-void draw_line_dda(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+void draw_line_dda(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
-    if (handle_basic_lines(x0, y0, x1, y1, color))
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (handle_basic_lines(pixmap, x0, y0, x1, y1, color))
+        return;
+    if (line_rejected(pixmap, x0, y0, x1, y1))
         return;
 
     int32_t dx = x1 - x0;
@@ -234,23 +610,61 @@ void draw_line_dda(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t colo
     else
         steps = abs(dy);
 
+    double t0, t1;
+    if (!clip_line_liang_barsky(&pixmap->clip, x0, y0, x1, y1, &t0, &t1))
+        return;
+    double lo = floor(t0 * steps) - 1;
+    double hi = ceil(t1 * steps) + 1;
+    int32_t first = lo > 0 ? (int32_t)lo : 0;
+    int32_t end = hi < steps ? (int32_t)hi : steps;
+
     float x_inc = dx / (float)steps;
     float y_inc = dy / (float)steps;
 
-    float x = (float)x0;
-    float y = (float)y0;
+    float x = (float)x0 + x_inc * first;
+    float y = (float)y0 + y_inc * first;
 
-    for (int32_t i = 0; i < steps; i++)
+    for (int32_t i = first; i < end; i++)
     {
-        draw_point(roundf(x), roundf(y), color);
+        draw_point(pixmap, roundf(x), roundf(y), color);
         x += x_inc;
         y += y_inc;
     }
 }
 
-void draw_line_midpoint(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+/**
+ * @brief Returns the row that `draw_line_midpoint` has reached at column x
+ *
+ * The row rises by at most one per column and only while the line is more
+ * than half a pixel above it. It therefore equals the smallest n >= y0 with
+ * y(x) <= n + 1/2, capped by the diagonal y0 + (x - x0).
+ *
+ * @param m Slope of the line
+ * @param b Intercept of the line
+ * @param x0 Starting x-coordinate
+ * @param y0 Starting y-coordinate
+ * @param x Column, at least x0
+ * @return The row plotted at column x
+ */
+static int64_t midpoint_row(float m, float b, int32_t x0, int32_t y0, int32_t x)
+{
+    float py = m * x + b;
+    int64_t n = (int64_t)ceilf(py - 0.5f);
+    while (py > n + 0.5f)
+        n++;
+    while (n > y0 && !(py > (n - 1) + 0.5f))
+        n--;
+
+    int64_t most = (int64_t)y0 + ((int64_t)x - x0);
+    return n < y0 ? y0 : (n > most ? most : n);
+}
+
+void draw_line_midpoint(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
-    if (handle_basic_lines(x0, y0, x1, y1, color))
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (handle_basic_lines(pixmap, x0, y0, x1, y1, color))
+        return;
+    if (line_rejected(pixmap, x0, y0, x1, y1))
         return;
 
     if (x0 > x1)
@@ -263,21 +677,145 @@ void draw_line_midpoint(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t
     float b = y0 - m * x0;
     int32_t y = y0;
 
-    for (int32_t x = x0; x <= x1; x++)
+    // The plotted rows never decrease, so the visible columns form one range
+    // whose ends can be found by bisection on the closed form of the row
+    const Rect *clip = &pixmap->clip;
+    int32_t first = x0 > clip->x0 ? x0 : clip->x0;
+    int32_t last = x1 < clip->x1 - 1 ? x1 : clip->x1 - 1;
+    if (first > last || midpoint_row(m, b, x0, y0, last) < clip->y0 || midpoint_row(m, b, x0, y0, first) >= clip->y1)
+        return;
+
+    for (int32_t lo = first, hi = last; lo < hi;) // First column at or below the top edge
+    {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (midpoint_row(m, b, x0, y0, mid) >= clip->y0)
+            hi = mid;
+        else
+            lo = mid + 1;
+        first = lo;
+    }
+    for (int32_t lo = first, hi = last; lo < hi;) // Last column above the bottom edge
+    {
+        int32_t mid = lo + (hi - lo + 1) / 2;
+        if (midpoint_row(m, b, x0, y0, mid) < clip->y1)
+            lo = mid;
+        else
+            hi = mid - 1;
+        last = lo;
+    }
+
+    if (first > x0)
+        y = (int32_t)midpoint_row(m, b, x0, y0, first - 1);
+
+    for (int32_t x = first; x <= last; x++)
     {
         float py = m * x + b;
         if (py > y + 0.5f)
             y++;
 
-        draw_point(x, y, color);
+        draw_point(pixmap, x, y, color);
     }
 }
 
-// TODO: Handle other slopes (m < 0, m > 1)
-void draw_line_bresenham(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+/**
+ * @brief Walks the visible steps of a Bresenham line in one octant by stepping a pixel pointer
+ *
+ * The octant is fixed at compile time: a step along the major axis advances
+ * the pointer by 1 or by the stride, a step along the minor axis by the stride
+ * or by 1 in the direction SV. Each pixel then costs a store and a few
+ * arithmetic operations, without coordinates, bounds checks or branches.
+ * TRACKED keeps the coordinates as well, for dirty tracking, instrumentation
+ * and tiled layouts, whose pixels are addressed from the coordinates.
+ *
+ * @param pixmap Target pixmap
+ * @param u Major coordinate of the first pixel
+ * @param v Minor coordinate of the first pixel
+ * @param count Number of pixels, all inside the clip rectangle
+ * @param D Error term of the first pixel
+ * @param incrEast Error increment of a step along the major axis
+ * @param incrNEast Error increment of a diagonal step
+ * @param color Premultiplied color
+ * @param mode Blend mode, BLEND_NONE stores the color
+ */
+template <bool STEEP, int SV, bool TRACKED>
+static void bresenham_walk(Pixmap *pixmap, int32_t u, int32_t v, int64_t count, int64_t D, int64_t incrEast,
+                           int64_t incrNEast, uint32_t color, BlendMode mode)
 {
-    if (handle_basic_lines(x0, y0, x1, y1, color))
-        return;
+    const ptrdiff_t stride = pixmap->stride;
+    const ptrdiff_t major = STEEP ? stride : 1;
+    const ptrdiff_t minor = STEEP ? SV : SV * stride;
+    const bool linear = pixmap->layout == LAYOUT_LINEAR;
+    uint32_t *dst = linear ? (STEEP ? pixmap_row(pixmap, u) + v : pixmap_row(pixmap, v) + u) : NULL;
+
+    for (int64_t k = 0; k < count; k++)
+    {
+        uint32_t *pixel = dst;
+        if (TRACKED)
+        {
+            int32_t x = STEEP ? v : u;
+            int32_t y = STEEP ? u : v;
+            PROBE_WRITE(pixmap, x, y, 1);
+            dirty_mark(pixmap, x, x + 1, y);
+            if (!linear)
+                pixel = pixmap_pixel(pixmap, x, y);
+            u++;
+        }
+        *pixel = mode == BLEND_NONE ? color : color_composite(mode, *pixel, color);
+
+        // The minor step depends on the slope and mispredicts as a branch, so it is masked in
+        int64_t east = D >> 63;
+        if (!TRACKED || linear)
+            dst += major + (minor & ~east);
+        D += incrNEast + ((incrEast - incrNEast) & east);
+        if (TRACKED)
+            v += (int32_t)(SV & ~east);
+    }
+}
+
+typedef void (*BresenhamWalk)(Pixmap *pixmap, int32_t u, int32_t v, int64_t count, int64_t D, int64_t incrEast,
+                              int64_t incrNEast, uint32_t color, BlendMode mode);
+
+// Indexed by [tracked][steep][minor direction > 0]
+static const BresenhamWalk bresenham_walks[2][2][2] = {
+    {{bresenham_walk<false, -1, false>, bresenham_walk<false, 1, false>},
+     {bresenham_walk<true, -1, false>, bresenham_walk<true, 1, false>}},
+    {{bresenham_walk<false, -1, true>, bresenham_walk<false, 1, true>},
+     {bresenham_walk<true, -1, true>, bresenham_walk<true, 1, true>}},
+};
+
+/**
+ * @brief Resolves how the pixels of a line are written
+ *
+ * @param pixmap Target pixmap
+ * @param color 4 byte integer representing the color in RGBA format
+ * @param src Receives the premultiplied color
+ * @return BLEND_NONE if the pixels are stored, otherwise the blend mode to composite with
+ */
+static BlendMode line_mode(const Pixmap *pixmap, uint32_t color, uint32_t *src)
+{
+    *src = color_premultiply(color);
+    return color_is_store(pixmap, color) ? BLEND_NONE : pixmap->blend;
+}
+
+/**
+ * @brief Draws a line that is neither a point nor axis-aligned with integer Bresenham
+ *
+ * The line is normalized to run along its major axis in positive direction,
+ * clipped to the steps inside the clip rectangle and handed to the walk of its
+ * octant. Lines with both end points inside skip the clipping arithmetic.
+ */
+static void bresenham_line(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t src, BlendMode mode)
+{
+    const Rect *clip = &pixmap->clip;
+    bool inside = x0 >= clip->x0 && x0 < clip->x1 && y0 >= clip->y0 && y0 < clip->y1 &&
+                  x1 >= clip->x0 && x1 < clip->x1 && y1 >= clip->y0 && y1 < clip->y1;
+
+    bool steep = llabs((int64_t)y1 - y0) > llabs((int64_t)x1 - x0);
+    if (steep)
+    {
+        swapi(&x0, &y0);
+        swapi(&x1, &y1);
+    }
 
     if (x0 > x1)
     {
@@ -285,92 +823,507 @@ void draw_line_bresenham(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_
         swapi(&y0, &y1);
     }
 
-    int32_t dx = x1 - x0;
-    int32_t dy = y1 - y0;
-    int32_t D = 2 * dy - dx;
-    int32_t incrEast = 2 * dy;
-    int32_t incrNEast = 2 * (dy - dx);
-    int32_t x = x0;
+    int64_t dx = (int64_t)x1 - x0;
+    int64_t dy = llabs((int64_t)y1 - y0);
+    int64_t sy = y1 >= y0 ? 1 : -1;
+    int64_t incrEast = 2 * dy;
+    int64_t incrNEast = 2 * (dy - dx);
+
+    int64_t first = 0, last = dx;
+    int64_t D = 2 * dy - dx;
     int32_t y = y0;
+    if (!inside)
+    {
+        Rect bounds = steep ? Rect{clip->y0, clip->x0, clip->y1, clip->x1} : *clip;
+        if (!clip_bresenham(&bounds, x0, y0, dx, dy, sy, &first, &last))
+            return;
+
+        // Error term of the first visible step, derived from the closed form of e(k)
+        uint64_t remainder;
+        int64_t e = (int64_t)mul_div_u64((uint64_t)(2 * dy), (uint64_t)first, (uint64_t)dx, (uint64_t)(2 * dx), &remainder);
+        D = (int64_t)remainder + 2 * dy - 2 * dx;
+        y = (int32_t)(y0 + sy * e);
+    }
+
+    bool tracked = RENDERER_STATS || pixmap->dirty != NULL || pixmap->layout != LAYOUT_LINEAR;
+    bresenham_walks[tracked][steep][sy > 0](pixmap, (int32_t)(x0 + first), y, last - first + 1, D, incrEast, incrNEast, src, mode);
+}
+
+void draw_line_bresenham(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (handle_basic_lines(pixmap, x0, y0, x1, y1, color))
+        return;
+    if (line_rejected(pixmap, x0, y0, x1, y1))
+        return;
 
-    draw_point(x, y, color);
+    uint32_t src;
+    BlendMode mode = line_mode(pixmap, color, &src);
+    bresenham_line(pixmap, x0, y0, x1, y1, src, mode);
+}
+
+void draw_lines(Pixmap *pixmap, const int32_t *x0, const int32_t *y0, const int32_t *x1, const int32_t *y1, size_t count,
+                uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_LINE);
+    uint32_t src;
+    BlendMode mode = line_mode(pixmap, color, &src);
+    const Rect clip = pixmap->clip;
 
-    while (x < x1)
+    for (size_t i = 0; i < count; i++)
     {
-        x++;
-        if (D < 0)
-            D += incrEast;
+        int32_t ax = x0[i], ay = y0[i], bx = x1[i], by = y1[i];
+
+        // Trivial reject of lines beyond one edge, without computing outcodes
+        if ((ax < clip.x0 && bx < clip.x0) || (ax >= clip.x1 && bx >= clip.x1) ||
+            (ay < clip.y0 && by < clip.y0) || (ay >= clip.y1 && by >= clip.y1))
+            continue;
+
+        if (ax == bx || ay == by)
+            handle_basic_lines(pixmap, ax, ay, bx, by, color);
         else
+            bresenham_line(pixmap, ax, ay, bx, by, src, mode);
+    }
+}
+
+/**
+ * @brief Blends one pixel of an anti-aliased line, given in major/minor coordinates
+ *
+ * @param inside true if the pixel is known to lie inside the clip rectangle
+ */
+static inline void xiaolin_plot(Pixmap *pixmap, bool steep, bool inside, int32_t u, int32_t v, uint32_t color, uint32_t coverage)
+{
+    int32_t x = steep ? v : u;
+    int32_t y = steep ? u : v;
+    if (coverage == 0)
+        return;
+    if (inside || clip_outcode(&pixmap->clip, x, y) == CLIP_INSIDE)
+        pixel_blend(pixmap, x, y, color, coverage);
+    else
+        PROBE_REJECT(1);
+}
+
+void draw_line_xiaolin(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_LINE);
+    bool steep = llabs((int64_t)y1 - y0) > llabs((int64_t)x1 - x0);
+    if (steep)
+    {
+        swapi(&x0, &y0);
+        swapi(&x1, &y1);
+    }
+    if (x0 > x1)
+    {
+        swapi(&x0, &x1);
+        swapi(&y0, &y1);
+    }
+
+    // Work in the major/minor frame of the clip rectangle, with one extra pixel on the minor axis for the second pixel
+    const Rect *clip = &pixmap->clip;
+    Rect bounds = steep ? Rect{clip->y0, clip->x0, clip->y1, clip->x1} : *clip;
+    int32_t v_min = y0 < y1 ? y0 : y1;
+    int32_t v_max = y0 < y1 ? y1 : y0;
+    ClipResult visible = clip_bounds(&bounds, x0, (int64_t)v_min - 1, x1, (int64_t)v_max + 1);
+    if (visible == CLIP_REJECT)
+        return;
+    bool inside = visible == CLIP_ACCEPT;
+
+    int64_t dx = (int64_t)x1 - x0;
+    int64_t dy = llabs((int64_t)y1 - y0);
+    int32_t sy = y1 >= y0 ? 1 : -1;
+
+    // Only walk the steps that can touch the clip rectangle
+    int64_t first = 0, last = dx;
+    if (!inside)
+    {
+        Rect widened = {bounds.x0, bounds.y0 - 1, bounds.x1, bounds.y1 + 1};
+        double t0, t1;
+        if (dx > 0 && !clip_line_liang_barsky(&widened, x0, y0, x1, y1, &t0, &t1))
+            return;
+        if (dx > 0)
         {
-            y++;
-            D += incrNEast;
+            double lo = floor(t0 * (double)dx) - 1;
+            double hi = ceil(t1 * (double)dx) + 1;
+            first = lo > 0 ? (int64_t)lo : 0;
+            last = hi < (double)dx ? (int64_t)hi : dx;
         }
-        draw_point(x, y, color);
     }
+
+    // Distance from y0 in 16.16 fixed point, mirrored for falling lines so that it only grows:
+    // pos(k) = floor(k * dy * 2^16 / dx), advanced by step plus a remainder that carries over
+    int64_t pos = 0, rem = 0, step = 0, step_rem = 0;
+    if (dx > 0)
+    {
+        uint64_t r;
+        pos = (int64_t)mul_div_u64((uint64_t)first, (uint64_t)dy << 16, 0, (uint64_t)dx, &r);
+        rem = (int64_t)r;
+        step = (dy << 16) / dx;
+        step_rem = (dy << 16) % dx;
+    }
+
+    int64_t base = (int64_t)y0 * sy;
+    for (int64_t k = first; k <= last; k++)
+    {
+        int64_t minor = base + (pos >> 16);
+        uint32_t frac = (uint32_t)(pos >> 8) & 0xFF;
+        int32_t u = (int32_t)(x0 + k);
+        xiaolin_plot(pixmap, steep, inside, u, (int32_t)(minor * sy), color, 255 - frac);
+        xiaolin_plot(pixmap, steep, inside, u, (int32_t)((minor + 1) * sy), color, frac);
+
+        pos += step;
+        rem += step_rem;
+        if (rem >= dx)
+        {
+            pos++;
+            rem -= dx;
+        }
+    }
+}
+
+void draw_lines_xiaolin(Pixmap *pixmap, const Point *points, size_t count, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_LINE);
+    for (size_t i = 0; i < count; i++)
+        draw_line_xiaolin(pixmap, points[2 * i].x, points[2 * i].y, points[2 * i + 1].x, points[2 * i + 1].y, color);
+}
+
+enum
+{
+    STROKE_MITER_LIMIT = 4,      // Miters longer than this many half widths fall back to bevels
+    STROKE_ROUND_MIN = 8,        // Fewest vertices of a round cap or join
+    STROKE_ROUND_MAX = 1024,     // Most vertices of a round cap or join
+    STROKE_LOCAL_POINTS = 256,   // Strokes with up to this many outline vertices need no allocation
+};
+
+/**
+ * @brief Outline of a stroke, collected as many small contours filled together
+ *
+ */
+typedef struct Stroke
+{
+    ScanPoint *points;
+    size_t *ends;
+    size_t count;    // Vertices written so far
+    size_t contours; // Contours closed so far
+    double radius;   // Half of the stroke width in pixels
+    int32_t round;   // Vertices used for a round cap or join
+} Stroke;
+
+static void stroke_vertex(Stroke *stroke, double x, double y)
+{
+    ScanPoint *point = &stroke->points[stroke->count++];
+    point->x = llround(x * SCAN_SUBPIXEL_ONE);
+    point->y = llround(y * SCAN_SUBPIXEL_ONE);
+}
+
+/**
+ * @brief Closes the contour of all vertices added since the last one
+ *
+ * The pieces of a stroke overlap and are filled with the non-zero rule, so
+ * every contour is turned to the same orientation to keep them from cancelling.
+ */
+static void stroke_close(Stroke *stroke)
+{
+    size_t begin = stroke->contours > 0 ? stroke->ends[stroke->contours - 1] : 0;
+    ScanPoint *points = stroke->points + begin;
+    size_t count = stroke->count - begin;
+
+    double area = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const ScanPoint *next = &points[(i + 1) % count];
+        area += (double)points[i].x * next->y - (double)next->x * points[i].y;
+    }
+    for (size_t i = 0; area < 0.0 && i < count / 2; i++)
+    {
+        ScanPoint temp = points[i];
+        points[i] = points[count - 1 - i];
+        points[count - 1 - i] = temp;
+    }
+    stroke->ends[stroke->contours++] = stroke->count;
+}
+
+static void stroke_disc(Stroke *stroke, double x, double y)
+{
+    for (int32_t i = 0; i < stroke->round; i++)
+    {
+        double angle = 2.0 * M_PI * i / stroke->round;
+        stroke_vertex(stroke, x + stroke->radius * cos(angle), y + stroke->radius * sin(angle));
+    }
+    stroke_close(stroke);
+}
+
+/**
+ * @brief Fills the wedge between two segments on the outer side of their shared vertex
+ *
+ * @param x, y Shared vertex
+ * @param d0x, d0y Unit direction of the incoming segment
+ * @param d1x, d1y Unit direction of the outgoing segment
+ */
+static void stroke_join(Stroke *stroke, LineJoin join, double x, double y, double d0x, double d0y, double d1x, double d1y)
+{
+    double cross = d0x * d1y - d0y * d1x;
+    double dot = d0x * d1x + d0y * d1y;
+    if (fabs(cross) < 1e-12 && dot > 0.0) // Straight continuation
+        return;
+    if (join == JOIN_ROUND)
+    {
+        stroke_disc(stroke, x, y);
+        return;
+    }
+
+    // The segments turn towards the side of their normal (-dy, dx) when cross > 0, so the gap opens on the other side
+    double side = cross > 0.0 ? -stroke->radius : stroke->radius;
+    double n0x = -d0y * side, n0y = d0x * side;
+    double n1x = -d1y * side, n1y = d1x * side;
+    stroke_vertex(stroke, x, y);
+    stroke_vertex(stroke, x + n0x, y + n0y);
+    // The offset edges meet at (n0 + n1) / (1 + dot), which is 2 / (1 + dot) squared half widths away
+    if (1.0 + dot > 2.0 / (STROKE_MITER_LIMIT * STROKE_MITER_LIMIT))
+        stroke_vertex(stroke, x + (n0x + n1x) / (1.0 + dot), y + (n0y + n1y) / (1.0 + dot));
+    stroke_vertex(stroke, x + n1x, y + n1y);
+    stroke_close(stroke);
+}
+
+/**
+ * @brief Returns the number of vertices that keep a round cap within a quarter pixel of a true circle
+ *
+ */
+static int32_t stroke_round_vertices(double radius)
+{
+    if (radius <= 0.25)
+        return STROKE_ROUND_MIN;
+    double count = ceil(M_PI / acos(1.0 - 0.25 / radius));
+    if (count < STROKE_ROUND_MIN)
+        return STROKE_ROUND_MIN;
+    if (count > STROKE_ROUND_MAX)
+        return STROKE_ROUND_MAX;
+    return ((int32_t)count + 3) & ~3;
 }
 
-void draw_line_xiaolin(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+void draw_polyline(Pixmap *pixmap, const Point *points, size_t count, int32_t thickness, LineCap cap, LineJoin join, uint32_t color)
 {
-    assert(false);
-    // TODO: Implement
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (count == 0 || thickness <= 0)
+        return;
+
+    // Collapse repeated vertices, they have no direction
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++)
+        unique += points[i].x != points[i - 1].x || points[i].y != points[i - 1].y;
+
+    Stroke stroke = {};
+    stroke.radius = thickness / 2.0;
+    stroke.round = stroke_round_vertices(stroke.radius);
+
+    // Four vertices per segment and per miter join, and a disc for each cap and round join
+    size_t piece = (size_t)stroke.round > 4 ? (size_t)stroke.round : 4;
+    size_t capacity = 4 * unique + piece * (unique + 2);
+    size_t contours = 2 * unique + 2;
+
+    ScanPoint local_points[STROKE_LOCAL_POINTS];
+    size_t local_ends[STROKE_LOCAL_POINTS / 4];
+    stroke.points = local_points;
+    stroke.ends = local_ends;
+    if (capacity > STROKE_LOCAL_POINTS || contours > STROKE_LOCAL_POINTS / 4)
+    {
+        stroke.points = (ScanPoint *)malloc(capacity * sizeof(ScanPoint));
+        stroke.ends = (size_t *)malloc(contours * sizeof(size_t));
+        if (stroke.points == NULL || stroke.ends == NULL)
+        {
+            free(stroke.points);
+            free(stroke.ends);
+            return;
+        }
+    }
+
+    if (unique == 1)
+    {
+        // A single point only shows its caps
+        double x = points[0].x, y = points[0].y, r = stroke.radius;
+        if (cap == CAP_ROUND)
+            stroke_disc(&stroke, x, y);
+        else if (cap == CAP_SQUARE)
+        {
+            stroke_vertex(&stroke, x - r, y - r);
+            stroke_vertex(&stroke, x + r, y - r);
+            stroke_vertex(&stroke, x + r, y + r);
+            stroke_vertex(&stroke, x - r, y + r);
+            stroke_close(&stroke);
+        }
+    }
+
+    double prev_dx = 0.0, prev_dy = 0.0;
+    size_t segment = 0;
+    for (size_t i = 1; i < count; i++)
+    {
+        const Point *a = &points[i - 1];
+        const Point *b = &points[i];
+        if (a->x == b->x && a->y == b->y)
+            continue;
+
+        double dx = (double)b->x - a->x;
+        double dy = (double)b->y - a->y;
+        double length = sqrt(dx * dx + dy * dy);
+        dx /= length;
+        dy /= length;
+
+        double ax = a->x, ay = a->y, bx = b->x, by = b->y;
+        if (segment == 0 && cap == CAP_SQUARE)
+        {
+            ax -= dx * stroke.radius;
+            ay -= dy * stroke.radius;
+        }
+        if (segment + 2 == unique && cap == CAP_SQUARE)
+        {
+            bx += dx * stroke.radius;
+            by += dy * stroke.radius;
+        }
+        if (segment == 0 && cap == CAP_ROUND)
+            stroke_disc(&stroke, a->x, a->y);
+        if (segment + 2 == unique && cap == CAP_ROUND)
+            stroke_disc(&stroke, b->x, b->y);
+        if (segment > 0)
+            stroke_join(&stroke, join, a->x, a->y, prev_dx, prev_dy, dx, dy);
+
+        double nx = -dy * stroke.radius, ny = dx * stroke.radius;
+        stroke_vertex(&stroke, ax + nx, ay + ny);
+        stroke_vertex(&stroke, bx + nx, by + ny);
+        stroke_vertex(&stroke, bx - nx, by - ny);
+        stroke_vertex(&stroke, ax - nx, ay - ny);
+        stroke_close(&stroke);
+
+        prev_dx = dx;
+        prev_dy = dy;
+        segment++;
+    }
+
+    SpanTarget target = {pixmap, color};
+    scan_polygon(&pixmap->clip, stroke.points, stroke.ends, stroke.contours, FILL_NON_ZERO, span_target_fill, &target);
+
+    if (stroke.points != local_points)
+    {
+        free(stroke.points);
+        free(stroke.ends);
+    }
 }
 
-void draw_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t thickness, uint32_t color)
+void draw_line(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t thickness, uint32_t color)
 {
-    assert(false);
-    // TODO: Implement
+    PROBE_PRIMITIVE(STAT_LINE);
+    if (thickness <= 1)
+    {
+        draw_line_bresenham(pixmap, x0, y0, x1, y1, color);
+        return;
+    }
+    Point points[2] = {{x0, y0}, {x1, y1}};
+    draw_polyline(pixmap, points, 2, thickness, CAP_SQUARE, JOIN_MITER, color);
 }
 #pragma endregion Line
 
 #pragma region Circle
 
-static void draw_circle_symmetric(int32_t cx, int32_t cy, int32_t x, int32_t y, uint32_t color)
+/**
+ * @brief Classifies the bounding box of a circle against the clip rectangle
+ *
+ * @param pixmap Target pixmap
+ * @param cx x-coordinate of the center
+ * @param cy y-coordinate of the center
+ * @param r Radius of the circle
+ * @return CLIP_REJECT, CLIP_ACCEPT or CLIP_PARTIAL
+ */
+static ClipResult clip_circle(const Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r)
 {
-    draw_point(cx + x, cy + y, color);
-    draw_point(cx - x, cy + y, color);
-    draw_point(cx + x, cy - y, color);
-    draw_point(cx - x, cy - y, color);
-    draw_point(cx + y, cy + x, color);
-    draw_point(cx - y, cy + x, color);
-    draw_point(cx + y, cy - x, color);
-    draw_point(cx - y, cy - x, color);
+    return clip_bounds(&pixmap->clip, (int64_t)cx - r, (int64_t)cy - r, (int64_t)cx + r, (int64_t)cy + r);
+}
+
+static void draw_circle_symmetric(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t x, int32_t y, bool inside, uint32_t color)
+{
+    if (inside) // The whole circle is visible, skip the bounds checks
+    {
+        pixel_store(pixmap, cx + x, cy + y, color);
+        pixel_store(pixmap, cx - x, cy + y, color);
+        pixel_store(pixmap, cx + x, cy - y, color);
+        pixel_store(pixmap, cx - x, cy - y, color);
+        pixel_store(pixmap, cx + y, cy + x, color);
+        pixel_store(pixmap, cx - y, cy + x, color);
+        pixel_store(pixmap, cx + y, cy - x, color);
+        pixel_store(pixmap, cx - y, cy - x, color);
+        return;
+    }
+
+    draw_point(pixmap, cx + x, cy + y, color);
+    draw_point(pixmap, cx - x, cy + y, color);
+    draw_point(pixmap, cx + x, cy - y, color);
+    draw_point(pixmap, cx - x, cy - y, color);
+    draw_point(pixmap, cx + y, cy + x, color);
+    draw_point(pixmap, cx - y, cy + x, color);
+    draw_point(pixmap, cx + y, cy - x, color);
+    draw_point(pixmap, cx - y, cy - x, color);
 }
 
-void draw_circle_equation1(int32_t cx, int32_t cy, int32_t r, uint32_t color) // TODO: Add t parameter?
+void draw_circle_equation1(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color) // TODO: Add t parameter?
 {
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    ClipResult clip = clip_circle(pixmap, cx, cy, r);
+    if (clip == CLIP_REJECT)
+        return;
+    bool inside = clip == CLIP_ACCEPT;
+
     for (float t = 0; t < 2 * M_PI; t += 0.01f)
     {
         int32_t x = roundf(r * cosf(t));
         int32_t y = roundf(r * sinf(t));
-        draw_point(cx + x, cy + y, color);
+        if (inside)
+            pixel_store(pixmap, cx + x, cy + y, color);
+        else
+            draw_point(pixmap, cx + x, cy + y, color);
     }
 }
 
-void draw_circle_equation2(int32_t cx, int32_t cy, int32_t r, uint32_t color) // TODO: Add t parameter?
+void draw_circle_equation2(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color) // TODO: Add t parameter?
 {
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    ClipResult clip = clip_circle(pixmap, cx, cy, r);
+    if (clip == CLIP_REJECT)
+        return;
+    bool inside = clip == CLIP_ACCEPT;
+
     for (float t = (M_PI / 2); t > (M_PI / 4); t -= 0.01f)
     {
         int32_t x = roundf(r * cosf(t));
         int32_t y = roundf(r * sinf(t));
-        draw_circle_symmetric(cx, cy, x, y, color);
+        draw_circle_symmetric(pixmap, cx, cy, x, y, inside, color);
     }
 }
 
-void draw_circle_equation3(int32_t cx, int32_t cy, int32_t r, uint32_t color)
+void draw_circle_equation3(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
 {
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    ClipResult clip = clip_circle(pixmap, cx, cy, r);
+    if (clip == CLIP_REJECT)
+        return;
+    bool inside = clip == CLIP_ACCEPT;
+
     int32_t x = 0;
     int32_t y = r;
 
     while (y >= x)
     {
-        draw_circle_symmetric(cx, cy, x, y, color);
+        draw_circle_symmetric(pixmap, cx, cy, x, y, inside, color);
         x++;
         y = roundf(sqrtf(r * r - (float)x * x));
     }
 }
 
-void draw_circle_midpoint(int32_t cx, int32_t cy, int32_t r, uint32_t color)
+void draw_circle_midpoint(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
 {
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    ClipResult clip = clip_circle(pixmap, cx, cy, r);
+    if (clip == CLIP_REJECT)
+        return;
+    bool inside = clip == CLIP_ACCEPT;
+
     int32_t x = 0;
     int32_t y = -r;
     int32_t D = -r;
@@ -386,13 +1339,19 @@ void draw_circle_midpoint(int32_t cx, int32_t cy, int32_t r, uint32_t color)
         {
             D += 2 * x + 1;
         }
-        draw_circle_symmetric(cx, cy, x, y, color);
+        draw_circle_symmetric(pixmap, cx, cy, x, y, inside, color);
         x++;
     }
 }
 
-void draw_circle_bresenham(int32_t cx, int32_t cy, int32_t r, uint32_t color)
+void draw_circle_bresenham(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
 {
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    ClipResult clip = clip_circle(pixmap, cx, cy, r);
+    if (clip == CLIP_REJECT)
+        return;
+    bool inside = clip == CLIP_ACCEPT;
+
     int32_t r2 = r + r;
     int32_t x = r;
     int32_t y = 0;
@@ -402,7 +1361,7 @@ void draw_circle_bresenham(int32_t cx, int32_t cy, int32_t r, uint32_t color)
 
     while (y <= x)
     {
-        draw_circle_symmetric(cx, cy, x, y, color);
+        draw_circle_symmetric(pixmap, cx, cy, x, y, inside, color);
 
         D += dy;
         dy -= 4;
@@ -417,37 +1376,407 @@ void draw_circle_bresenham(int32_t cx, int32_t cy, int32_t r, uint32_t color)
     }
 }
 
-void draw_circle(int32_t cx, int32_t cy, int32_t r, uint32_t color)
+void draw_circle(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
 {
-    draw_circle_bresenham(cx, cy, r, color);
+    PROBE_PRIMITIVE(STAT_CIRCLE);
+    draw_circle_bresenham(pixmap, cx, cy, r, color);
 }
 
-void fill_circle(int32_t cx, int32_t cy, int32_t r, uint32_t color)
+/**
+ * @brief Fills one row of a disc, clipping the run against the clip rectangle
+ *
+ * The ends are 64-bit because the center plus the half-width can exceed the
+ * 32-bit range for huge radii.
+ *
+ * @param pixmap Target pixmap
+ * @param x0 First x-coordinate of the run
+ * @param x1 x-coordinate one past the end of the run
+ * @param y Row inside the clip rectangle
+ * @param color 4 byte integer representing the color in RGBA format
+ */
+static void fill_disc_row(Pixmap *pixmap, int64_t x0, int64_t x1, int32_t y, uint32_t color)
 {
-    int32_t x = 0;
-    int32_t y = -r;
-    int32_t D = -r;
+    if (x0 < pixmap->clip.x0)
+        x0 = pixmap->clip.x0;
+    if (x1 > pixmap->clip.x1)
+        x1 = pixmap->clip.x1;
+    if (x0 < x1)
+        span_store(pixmap, (int32_t)x0, (int32_t)x1, y, color);
+}
+
+void fill_circle(Pixmap *pixmap, int32_t cx, int32_t cy, int32_t r, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_DISC);
+    if (r < 0)
+        return;
+
+    const Rect *clip = &pixmap->clip;
+    if (clip_circle(pixmap, cx, cy, r) == CLIP_REJECT)
+        return;
+
+    // Rows cy + dy and cy - dy are visible for dy in [lo, hi], which is at most one clip rectangle high
+    int64_t lo = (int64_t)r + 1, hi = -1;
+    if (cy < clip->y1 && (int64_t)cy + r >= clip->y0) // Lower half
+    {
+        lo = cy < clip->y0 ? (int64_t)clip->y0 - cy : 0;
+        hi = (int64_t)clip->y1 - 1 - cy;
+    }
+    if (cy >= clip->y0 && (int64_t)cy - r < clip->y1) // Upper half
+    {
+        int64_t upper_lo = cy >= clip->y1 ? (int64_t)cy - clip->y1 + 1 : 0;
+        int64_t upper_hi = (int64_t)cy - clip->y0;
+        lo = upper_lo < lo ? upper_lo : lo;
+        hi = upper_hi > hi ? upper_hi : hi;
+    }
+    if (hi > r)
+        hi = r;
+    if (lo > hi)
+        return;
 
-    while (x <= -y)
+    int64_t limit = (int64_t)r * r + r;
+    int64_t hw = disc_half_width(limit, lo);
+    for (int64_t dy = lo; dy <= hi; dy++)
     {
-        //TODO: Change to draw line function
-        draw_line_bresenham(cx + x, cy + y, cx + x, cy - y, color);
-        draw_line_bresenham(cx - x, cy + y, cx - x, cy - y, color);
-        draw_line_bresenham(cx + y, cy + x, cx + y, cy - x, color);
-        draw_line_bresenham(cx - y, cy + x, cx - y, cy - x, color);
+        // The half-width only shrinks as the rows move away from the center
+        while (hw * hw + dy * dy > limit)
+            hw--;
 
-        if (D > 0)
+        int64_t y = (int64_t)cy + dy;
+        if (y >= clip->y0 && y < clip->y1)
+            fill_disc_row(pixmap, (int64_t)cx - hw, (int64_t)cx + hw + 1, (int32_t)y, color);
+
+        y = (int64_t)cy - dy;
+        if (dy > 0 && y >= clip->y0 && y < clip->y1)
+            fill_disc_row(pixmap, (int64_t)cx - hw, (int64_t)cx + hw + 1, (int32_t)y, color);
+    }
+}
+
+void fill_circles(Pixmap *pixmap, const int32_t *cx, const int32_t *cy, const int32_t *r, size_t count, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_DISC);
+    enum
+    {
+        TABLE_RADIUS = 1024, // Larger discs are rare enough to go through fill_circle
+    };
+    int32_t half_widths[TABLE_RADIUS + 1];
+    int32_t table_radius = -1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t radius = r[i];
+        int32_t x = cx[i];
+        int32_t y = cy[i];
+        if (radius < 0)
+            continue;
+        if (radius > TABLE_RADIUS)
         {
-            y++;
-            D += 2 * (x + y) + 1;
+            fill_circle(pixmap, x, y, radius, color);
+            continue;
         }
-        else
+
+        // Trivial reject against the bounding box
+        ClipResult clip = clip_circle(pixmap, x, y, radius);
+        if (clip == CLIP_REJECT)
+            continue;
+
+        // Markers mostly share a radius, so the row table is usually reused
+        if (radius != table_radius)
         {
-            D += 2 * x + 1;
+            int64_t limit = (int64_t)radius * radius + radius;
+            int64_t hw = radius;
+            for (int64_t dy = 0; dy <= radius; dy++)
+            {
+                while (hw * hw + dy * dy > limit)
+                    hw--;
+                half_widths[dy] = (int32_t)hw;
+            }
+            table_radius = radius;
         }
-        draw_circle_symmetric(cx, cy, x, y, color);
-        x++;
+
+        if (clip == CLIP_ACCEPT)
+        {
+            span_store(pixmap, x - half_widths[0], x + half_widths[0] + 1, y, color);
+            for (int32_t dy = 1; dy <= radius; dy++)
+            {
+                int32_t hw = half_widths[dy];
+                span_store(pixmap, x - hw, x + hw + 1, y - dy, color);
+                span_store(pixmap, x - hw, x + hw + 1, y + dy, color);
+            }
+            continue;
+        }
+
+        for (int32_t dy = -radius; dy <= radius; dy++)
+        {
+            int32_t row = y + dy;
+            if (row < pixmap->clip.y0 || row >= pixmap->clip.y1)
+                continue;
+            int32_t hw = half_widths[dy < 0 ? -dy : dy];
+            fill_disc_row(pixmap, (int64_t)x - hw, (int64_t)x + hw + 1, row, color);
+        }
+    }
+}
+
+#pragma endregion Circle
+#pragma region Polygon
+void draw_polygon(Pixmap *pixmap, const Point *points, size_t count, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_POLYGON);
+    if (count == 1)
+        draw_point(pixmap, points[0].x, points[0].y, color);
+    for (size_t i = 0; count >= 2 && i < count; i++)
+    {
+        const Point *next = &points[(i + 1) % count];
+        draw_line_bresenham(pixmap, points[i].x, points[i].y, next->x, next->y, color);
+    }
+}
+
+void fill_polygon(Pixmap *pixmap, const Point *points, size_t count, FillRule rule, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_POLYGON);
+    if (count < 3)
+        return;
+
+    ScanPoint local[64];
+    ScanPoint *vertices = local;
+    if (count > sizeof(local) / sizeof(local[0]))
+    {
+        vertices = (ScanPoint *)malloc(count * sizeof(ScanPoint));
+        if (vertices == NULL)
+            return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        vertices[i].x = (int64_t)points[i].x * SCAN_SUBPIXEL_ONE;
+        vertices[i].y = (int64_t)points[i].y * SCAN_SUBPIXEL_ONE;
+    }
+
+    SpanTarget target = {pixmap, color};
+    scan_polygon(&pixmap->clip, vertices, &count, 1, rule, span_target_fill, &target);
+
+    if (vertices != local)
+        free(vertices);
+}
+#pragma endregion Polygon
+
+#pragma region Triangle
+/**
+ * @brief Limits of the block rasterizer
+ *
+ * Triangles whose bounding box is smaller than TRIANGLE_MAX_SIZE keep every
+ * edge function value within 32 bits, larger ones go through the scan converter.
+ */
+enum
+{
+    TRIANGLE_BLOCK = 8,
+    TRIANGLE_MAX_SIZE = 1 << 14,
+};
+
+/**
+ * @brief Evaluates the edge functions of one 8x8 block
+ *
+ * Edge i has the value e[i] at the top-left pixel of the block and changes by
+ * a[i] per column and b[i] per row. A pixel is inside if all three values are
+ * non-negative.
+ *
+ * @param masks Receives one byte per row, bit k set if column k is inside
+ */
+typedef void (*TriangleBlockFn)(const int32_t e[3], const int32_t a[3], const int32_t b[3], uint8_t masks[TRIANGLE_BLOCK]);
+
+static void triangle_block_scalar(const int32_t e[3], const int32_t a[3], const int32_t b[3], uint8_t masks[TRIANGLE_BLOCK])
+{
+    int32_t row[3] = {e[0], e[1], e[2]};
+    for (int32_t y = 0; y < TRIANGLE_BLOCK; y++)
+    {
+        uint32_t mask = 0;
+        int32_t w[3] = {row[0], row[1], row[2]};
+        for (int32_t x = 0; x < TRIANGLE_BLOCK; x++)
+        {
+            mask |= (uint32_t)((w[0] | w[1] | w[2]) >= 0) << x;
+            w[0] += a[0], w[1] += a[1], w[2] += a[2];
+        }
+        masks[y] = (uint8_t)mask;
+        row[0] += b[0], row[1] += b[1], row[2] += b[2];
+    }
+}
+
+#if RENDERER_X86
+TARGET("sse2") static void triangle_block_sse2(const int32_t e[3], const int32_t a[3], const int32_t b[3], uint8_t masks[TRIANGLE_BLOCK])
+{
+    __m128i w_lo[3], w_hi[3], step[3];
+    for (int32_t i = 0; i < 3; i++)
+    {
+        // e + a * lane, the products fit into 32 bits
+        __m128i ai = _mm_set1_epi32(a[i]);
+        __m128i offsets = _mm_setr_epi32(0, a[i], 2 * a[i], 3 * a[i]);
+        w_lo[i] = _mm_add_epi32(_mm_set1_epi32(e[i]), offsets);
+        w_hi[i] = _mm_add_epi32(w_lo[i], _mm_slli_epi32(ai, 2));
+        step[i] = _mm_set1_epi32(b[i]);
+    }
+
+    for (int32_t y = 0; y < TRIANGLE_BLOCK; y++)
+    {
+        __m128i lo = _mm_or_si128(_mm_or_si128(w_lo[0], w_lo[1]), w_lo[2]);
+        __m128i hi = _mm_or_si128(_mm_or_si128(w_hi[0], w_hi[1]), w_hi[2]);
+        uint32_t outside = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(lo)) | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4;
+        masks[y] = (uint8_t)~outside;
+        for (int32_t i = 0; i < 3; i++)
+        {
+            w_lo[i] = _mm_add_epi32(w_lo[i], step[i]);
+            w_hi[i] = _mm_add_epi32(w_hi[i], step[i]);
+        }
+    }
+}
+
+TARGET("avx2") static void triangle_block_avx2(const int32_t e[3], const int32_t a[3], const int32_t b[3], uint8_t masks[TRIANGLE_BLOCK])
+{
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i w[3], step[3];
+    for (int32_t i = 0; i < 3; i++)
+    {
+        w[i] = _mm256_add_epi32(_mm256_set1_epi32(e[i]), _mm256_mullo_epi32(_mm256_set1_epi32(a[i]), lanes));
+        step[i] = _mm256_set1_epi32(b[i]);
+    }
+
+    for (int32_t y = 0; y < TRIANGLE_BLOCK; y++)
+    {
+        // The sign bit of the OR is set if any edge function is negative
+        __m256i any = _mm256_or_si256(_mm256_or_si256(w[0], w[1]), w[2]);
+        masks[y] = (uint8_t)~_mm256_movemask_ps(_mm256_castsi256_ps(any));
+        w[0] = _mm256_add_epi32(w[0], step[0]);
+        w[1] = _mm256_add_epi32(w[1], step[1]);
+        w[2] = _mm256_add_epi32(w[2], step[2]);
     }
 }
+#endif
+
+static TriangleBlockFn select_triangle_block(void)
+{
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return triangle_block_avx2;
+    if (features & CPU_SSE2)
+        return triangle_block_sse2;
+#endif
+    return triangle_block_scalar;
+}
+
+static const TriangleBlockFn triangle_block = select_triangle_block();
+
+/**
+ * @brief Widens the span of a row by [x0, x1)
+ *
+ */
+static inline void triangle_extend(int32_t *start, int32_t *end, int32_t x0, int32_t x1)
+{
+    if (x0 < *start)
+        *start = x0;
+    if (x1 > *end)
+        *end = x1;
+}
+
+void fill_triangle(Pixmap *pixmap, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_TRIANGLE);
+    const Rect *clip = &pixmap->clip;
+    int32_t min_x = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
+    int32_t min_y = y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2);
+    int32_t max_x = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+    int32_t max_y = y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2);
+    if (clip_bounds(clip, min_x, min_y, max_x, max_y) == CLIP_REJECT)
+        return;
+
+    // Huge triangles would overflow the 32-bit edge functions, the scan converter handles them exactly
+    if ((int64_t)max_x - min_x >= TRIANGLE_MAX_SIZE || (int64_t)max_y - min_y >= TRIANGLE_MAX_SIZE)
+    {
+        Point points[3] = {{x0, y0}, {x1, y1}, {x2, y2}};
+        fill_polygon(pixmap, points, 3, FILL_NON_ZERO, color);
+        return;
+    }
+
+    // Vertices relative to the bounding box, oriented so that the inside is positive
+    int32_t vx[3] = {x0 - min_x, x1 - min_x, x2 - min_x};
+    int32_t vy[3] = {y0 - min_y, y1 - min_y, y2 - min_y};
+    int64_t area = (int64_t)(vx[1] - vx[0]) * (vy[2] - vy[0]) - (int64_t)(vy[1] - vy[0]) * (vx[2] - vx[0]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        swapi(&vx[1], &vx[2]);
+        swapi(&vy[1], &vy[2]);
+    }
+
+    // E(x, y) = a * (x - xi) + b * (y - yi), evaluated at the bounding box origin
+    int32_t a[3], b[3], origin[3];
+    for (int32_t i = 0; i < 3; i++)
+    {
+        int32_t j = (i + 1) % 3;
+        a[i] = -(vy[j] - vy[i]);
+        b[i] = vx[j] - vx[i];
+        origin[i] = -a[i] * vx[i] - b[i] * vy[i];
+
+        // Top-left rule: pixel centers on an edge only count for left edges and horizontal top edges
+        bool top_left = a[i] > 0 || (a[i] == 0 && b[i] > 0);
+        if (!top_left)
+            origin[i] -= 1;
+    }
+
+    // Blocks are aligned to the pixmap, so their rows start on 32-byte boundaries
+    int32_t cx0 = min_x > clip->x0 ? min_x : clip->x0;
+    int32_t cy0 = min_y > clip->y0 ? min_y : clip->y0;
+    int32_t cx1 = max_x < clip->x1 - 1 ? max_x : clip->x1 - 1;
+    int32_t cy1 = max_y < clip->y1 - 1 ? max_y : clip->y1 - 1;
+    int32_t bx0 = cx0 & ~(TRIANGLE_BLOCK - 1);
+    int32_t by0 = cy0 & ~(TRIANGLE_BLOCK - 1);
+
+    for (int32_t by = by0; by <= cy1; by += TRIANGLE_BLOCK)
+    {
+        // Every row of a triangle is one contiguous run, so the runs of a strip of blocks are merged
+        int32_t start[TRIANGLE_BLOCK], end[TRIANGLE_BLOCK];
+        for (int32_t i = 0; i < TRIANGLE_BLOCK; i++)
+            start[i] = INT32_MAX, end[i] = INT32_MIN;
+
+        int32_t row0 = by < cy0 ? cy0 : by;
+        int32_t row1 = by + TRIANGLE_BLOCK - 1 > cy1 ? cy1 : by + TRIANGLE_BLOCK - 1;
 
-#pragma endregion Circle
\ No newline at end of file
+        for (int32_t bx = bx0; bx <= cx1; bx += TRIANGLE_BLOCK)
+        {
+            int32_t e[3];
+            bool reject = false, accept = true;
+            for (int32_t i = 0; i < 3 && !reject; i++)
+            {
+                e[i] = origin[i] + a[i] * (bx - min_x) + b[i] * (by - min_y);
+                int32_t corner_max = e[i] + (a[i] > 0 ? a[i] : 0) * (TRIANGLE_BLOCK - 1) + (b[i] > 0 ? b[i] : 0) * (TRIANGLE_BLOCK - 1);
+                int32_t corner_min = e[i] + (a[i] < 0 ? a[i] : 0) * (TRIANGLE_BLOCK - 1) + (b[i] < 0 ? b[i] : 0) * (TRIANGLE_BLOCK - 1);
+                reject = corner_max < 0;
+                accept = accept && corner_min >= 0;
+            }
+            if (reject)
+                continue;
+
+            int32_t col0 = bx < cx0 ? cx0 : bx;
+            int32_t col1 = bx + TRIANGLE_BLOCK - 1 > cx1 ? cx1 : bx + TRIANGLE_BLOCK - 1;
+            if (accept)
+            {
+                for (int32_t y = row0; y <= row1; y++)
+                    triangle_extend(&start[y - by], &end[y - by], col0, col1 + 1);
+                continue;
+            }
+
+            uint8_t masks[TRIANGLE_BLOCK];
+            triangle_block(e, a, b, masks);
+            uint32_t columns = (0xFFu << (col0 - bx)) & (0xFFu >> (bx + TRIANGLE_BLOCK - 1 - col1));
+            for (int32_t y = row0; y <= row1; y++)
+            {
+                uint32_t mask = masks[y - by] & columns;
+                if (mask != 0)
+                    triangle_extend(&start[y - by], &end[y - by], bx + (int32_t)bit_lowest(mask), bx + (int32_t)bit_highest(mask) + 1);
+            }
+        }
+
+        for (int32_t y = row0; y <= row1; y++)
+            if (start[y - by] < end[y - by])
+                span_store(pixmap, start[y - by], end[y - by], y, color);
+    }
+}
+#pragma endregion Triangle
@@ -0,0 +1,394 @@
+/**
+ * @file scan.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include "scan.h"
+
+#include <rmath.h>
+
+#include <stdlib.h>
+
+enum
+{
+    SCAN_LOCAL_EDGES = 64, // Polygons with up to this many edges need no allocation
+};
+
+/**
+ * @brief An edge stepped one row at a time with exact integer arithmetic
+ *
+ * The crossing with the current row lies at x + rem / den pixels, so the first
+ * pixel center at or right of it is x + (rem > 0).
+ */
+typedef struct ScanEdge
+{
+    int64_t x;        // Integer part of the crossing
+    int64_t rem;      // Fractional part in units of 1 / den, in [0, den)
+    int64_t den;      // 256 * dy
+    int64_t step;     // floor(dx / dy), integer part of the advance per row
+    int64_t step_rem; // Fractional part of the advance in units of 1 / den
+    int64_t y0, y1;   // First row and one past the last row the edge covers
+    int32_t winding;  // +1 for edges pointing down, -1 for edges pointing up
+} ScanEdge;
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    if ((a % b) != 0 && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+/**
+ * @brief Returns the first row whose center lies at or below a subpixel y-coordinate
+ *
+ */
+static int64_t scan_row(int64_t y)
+{
+    return floor_div(y + SCAN_SUBPIXEL_ONE - 1, SCAN_SUBPIXEL_ONE);
+}
+
+/**
+ * @brief Sets up an edge and positions it on a row
+ *
+ * A row belongs to the edge if its center lies in [top.y, bottom.y), which
+ * makes horizontal edges cover no row at all.
+ *
+ * @param edge Edge to set up
+ * @param top Upper end point
+ * @param bottom Lower end point
+ * @param row Row to start on, rows above the edge start on its first row
+ * @param winding Winding direction of the edge
+ * @return false if the edge covers no row
+ */
+static bool edge_setup(ScanEdge *edge, ScanPoint top, ScanPoint bottom, int64_t row, int32_t winding)
+{
+    edge->y0 = scan_row(top.y);
+    edge->y1 = scan_row(bottom.y);
+    edge->winding = winding;
+    if (edge->y0 >= edge->y1)
+        return false;
+    if (row < edge->y0)
+        row = edge->y0;
+
+    int64_t dx = bottom.x - top.x;
+    int64_t dy = bottom.y - top.y;
+    edge->den = dy * SCAN_SUBPIXEL_ONE;
+    edge->step = floor_div(dx, dy);
+    edge->step_rem = (dx - edge->step * dy) * SCAN_SUBPIXEL_ONE;
+
+    // Crossing at the row center: top.x / 256 + t * dx / (256 * dy), with t in [0, dy)
+    int64_t a = floor_div(top.x, SCAN_SUBPIXEL_ONE);
+    int64_t b = top.x - a * SCAN_SUBPIXEL_ONE;
+    uint64_t t = (uint64_t)(row * SCAN_SUBPIXEL_ONE - top.y);
+    uint64_t r;
+    int64_t q = (int64_t)mul_div_u64(t, (uint64_t)(dx < 0 ? -dx : dx), 0, (uint64_t)edge->den, &r);
+    if (dx >= 0)
+    {
+        edge->x = a + q;
+        edge->rem = (int64_t)r + b * dy;
+        if (edge->rem >= edge->den)
+        {
+            edge->x++;
+            edge->rem -= edge->den;
+        }
+    }
+    else
+    {
+        edge->x = a - q;
+        edge->rem = b * dy - (int64_t)r;
+        if (edge->rem < 0)
+        {
+            edge->x--;
+            edge->rem += edge->den;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the first pixel whose center lies at or right of the crossing
+ *
+ */
+static inline int64_t edge_pixel(const ScanEdge *edge)
+{
+    return edge->x + (edge->rem > 0);
+}
+
+static inline void edge_advance(ScanEdge *edge)
+{
+    edge->x += edge->step;
+    edge->rem += edge->step_rem;
+    if (edge->rem >= edge->den)
+    {
+        edge->x++;
+        edge->rem -= edge->den;
+    }
+}
+
+/**
+ * @brief Clips the span [x0, x1) horizontally and hands it on
+ *
+ */
+static inline void scan_emit(const Rect *clip, int64_t x0, int64_t x1, int64_t y, ScanSpanFn emit, void *context)
+{
+    if (x0 < clip->x0)
+        x0 = clip->x0;
+    if (x1 > clip->x1)
+        x1 = clip->x1;
+    if (x0 < x1)
+        emit(context, (int32_t)x0, (int32_t)x1, (int32_t)y);
+}
+
+#pragma region Convex
+/**
+ * @brief Checks whether a contour is convex and winds around its interior once
+ *
+ * All turns must go the same way and the direction along y may only change
+ * twice, which rules out stars whose turns all agree. Repeated vertices and
+ * collinear vertices are allowed.
+ */
+static bool scan_is_convex(const ScanPoint *points, size_t count)
+{
+    // Start from the last edge of non-zero length and the last vertical direction, so the checks wrap around
+    int64_t last_dx = 0, last_dy = 0;
+    int32_t last_y = 0;
+    for (size_t i = count; i-- > 0;)
+    {
+        int64_t dx = points[(i + 1) % count].x - points[i].x;
+        int64_t dy = points[(i + 1) % count].y - points[i].y;
+        if (last_dx == 0 && last_dy == 0)
+            last_dx = dx, last_dy = dy;
+        if (dy != 0)
+        {
+            last_y = dy > 0 ? 1 : -1;
+            break;
+        }
+    }
+
+    int32_t turn = 0;
+    int32_t y_changes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        int64_t dx = points[(i + 1) % count].x - points[i].x;
+        int64_t dy = points[(i + 1) % count].y - points[i].y;
+        if (dx == 0 && dy == 0)
+            continue;
+
+        int32_t cross = mul_compare_i64(last_dx, dy, last_dy, dx);
+        if (cross != 0)
+        {
+            if (turn != 0 && cross != turn)
+                return false;
+            turn = cross;
+        }
+        if (dy != 0)
+        {
+            int32_t y = dy > 0 ? 1 : -1;
+            y_changes += y != last_y;
+            last_y = y;
+        }
+        last_dx = dx, last_dy = dy;
+    }
+    return turn != 0 && y_changes <= 2;
+}
+
+/**
+ * @brief One side of a convex polygon, walked from the top vertex to the bottom vertex
+ *
+ */
+typedef struct ScanChain
+{
+    ScanEdge edge;
+    size_t vertex;    // Upper end of the current edge
+    int32_t direction; // +1 or -1 through the vertex array
+} ScanChain;
+
+/**
+ * @brief Moves a chain on until its edge covers a row
+ *
+ * @return false if the chain ended before the row
+ */
+static bool chain_seek(ScanChain *chain, const ScanPoint *points, size_t count, int64_t row)
+{
+    for (size_t steps = 0; steps < count; steps++)
+    {
+        if (chain->edge.y1 > row)
+            return true;
+        size_t next = (chain->vertex + count + chain->direction) % count;
+        if (points[next].y > points[chain->vertex].y)
+            edge_setup(&chain->edge, points[chain->vertex], points[next], row, 1);
+        chain->vertex = next;
+    }
+    return chain->edge.y1 > row;
+}
+
+/**
+ * @brief Fills a convex contour by walking its left and right side together
+ *
+ * Each row lies between exactly one edge of either side, so no edge table,
+ * sorting or winding count is needed.
+ */
+static void scan_convex(const Rect *clip, const ScanPoint *points, size_t count, ScanSpanFn emit, void *context)
+{
+    size_t top = 0, bottom = 0;
+    for (size_t i = 1; i < count; i++)
+    {
+        if (points[i].y < points[top].y)
+            top = i;
+        if (points[i].y > points[bottom].y)
+            bottom = i;
+    }
+
+    int64_t row = scan_row(points[top].y);
+    int64_t end = scan_row(points[bottom].y);
+    if (row < clip->y0)
+        row = clip->y0;
+    if (end > clip->y1)
+        end = clip->y1;
+    if (row >= end)
+        return;
+
+    ScanChain chains[2];
+    for (int32_t i = 0; i < 2; i++)
+    {
+        chains[i].vertex = top;
+        chains[i].direction = i == 0 ? 1 : -1;
+        chains[i].edge.y1 = INT64_MIN; // Forces the first seek to set up an edge
+        if (!chain_seek(&chains[i], points, count, row))
+            return;
+    }
+
+    for (; row < end; row++)
+    {
+        if (!chain_seek(&chains[0], points, count, row) || !chain_seek(&chains[1], points, count, row))
+            return;
+        int64_t a = edge_pixel(&chains[0].edge);
+        int64_t b = edge_pixel(&chains[1].edge);
+        if (a < b)
+            scan_emit(clip, a, b, row, emit, context);
+        else
+            scan_emit(clip, b, a, row, emit, context);
+        edge_advance(&chains[0].edge);
+        edge_advance(&chains[1].edge);
+    }
+}
+#pragma endregion Convex
+
+#pragma region Edge table
+static int compare_edges(const void *a, const void *b)
+{
+    const ScanEdge *ea = (const ScanEdge *)a;
+    const ScanEdge *eb = (const ScanEdge *)b;
+    return ea->y0 < eb->y0 ? -1 : (ea->y0 > eb->y0 ? 1 : 0);
+}
+
+bool scan_polygon(const Rect *clip, const ScanPoint *points, const size_t *ends, size_t contours, FillRule rule,
+                  ScanSpanFn emit, void *context)
+{
+    if (clip->x0 >= clip->x1 || clip->y0 >= clip->y1)
+        return true;
+
+    if (contours == 1 && ends[0] >= 3 && scan_is_convex(points, ends[0]))
+    {
+        scan_convex(clip, points, ends[0], emit, context);
+        return true;
+    }
+
+    size_t count = contours > 0 ? ends[contours - 1] : 0;
+    ScanEdge local_edges[SCAN_LOCAL_EDGES];
+    ScanEdge *local_active[SCAN_LOCAL_EDGES];
+    ScanEdge *edges = local_edges;
+    ScanEdge **active = local_active;
+    if (count > SCAN_LOCAL_EDGES)
+    {
+        edges = (ScanEdge *)malloc(count * sizeof(ScanEdge));
+        active = (ScanEdge **)malloc(count * sizeof(ScanEdge *));
+        if (edges == NULL || active == NULL)
+        {
+            free(edges);
+            free(active);
+            return false;
+        }
+    }
+
+    // Edge table: every edge that covers a visible row, positioned on its first visible row
+    size_t edge_count = 0;
+    size_t begin = 0;
+    for (size_t c = 0; c < contours; begin = ends[c], c++)
+    {
+        size_t size = ends[c] - begin;
+        for (size_t i = 0; size >= 2 && i < size; i++)
+        {
+            ScanPoint p = points[begin + i];
+            ScanPoint q = points[begin + (i + 1) % size];
+            if (p.y == q.y)
+                continue;
+
+            ScanEdge *edge = &edges[edge_count];
+            bool down = p.y < q.y;
+            if (!edge_setup(edge, down ? p : q, down ? q : p, clip->y0, down ? 1 : -1))
+                continue;
+            if (edge->y1 <= clip->y0 || edge->y0 >= clip->y1)
+                continue;
+            if (edge->y1 > clip->y1)
+                edge->y1 = clip->y1;
+            if (edge->y0 < clip->y0)
+                edge->y0 = clip->y0;
+            edge_count++;
+        }
+    }
+    qsort(edges, edge_count, sizeof(ScanEdge), compare_edges);
+
+    size_t next = 0;
+    size_t active_count = 0;
+    int64_t row = edge_count > 0 ? edges[0].y0 : 0;
+    while (next < edge_count || active_count > 0)
+    {
+        if (active_count == 0 && edges[next].y0 > row)
+            row = edges[next].y0; // Skip rows without edges
+
+        // Add the edges starting here and drop those that ended
+        while (next < edge_count && edges[next].y0 == row)
+            active[active_count++] = &edges[next++];
+        size_t kept = 0;
+        for (size_t i = 0; i < active_count; i++)
+            if (active[i]->y1 > row)
+                active[kept++] = active[i];
+        active_count = kept;
+
+        // Crossings move little from row to row, so insertion sort is close to linear
+        for (size_t i = 1; i < active_count; i++)
+        {
+            ScanEdge *edge = active[i];
+            int64_t x = edge_pixel(edge);
+            size_t j = i;
+            for (; j > 0 && edge_pixel(active[j - 1]) > x; j--)
+                active[j] = active[j - 1];
+            active[j] = edge;
+        }
+
+        int32_t winding = 0;
+        for (size_t i = 0; i + 1 < active_count; i++)
+        {
+            winding += rule == FILL_NON_ZERO ? active[i]->winding : 1;
+            bool inside = rule == FILL_NON_ZERO ? winding != 0 : (winding & 1) != 0;
+            if (inside)
+                scan_emit(clip, edge_pixel(active[i]), edge_pixel(active[i + 1]), row, emit, context);
+        }
+
+        for (size_t i = 0; i < active_count; i++)
+            edge_advance(active[i]);
+        row++;
+    }
+
+    if (edges != local_edges)
+    {
+        free(edges);
+        free(active);
+    }
+    return true;
+}
+#pragma endregion Edge table
@@ -0,0 +1,62 @@
+/**
+ * @file scan.h
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Scanline conversion of polygons with subpixel vertices
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Shared by the polygon fills and every primitive that is turned into a
+ * polygon first, such as thick lines.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pixmap.h>
+#include <polygon.h>
+
+/**
+ * @brief Fixed-point precision of `ScanPoint` coordinates
+ *
+ */
+enum
+{
+    SCAN_SUBPIXEL_BITS = 8,
+    SCAN_SUBPIXEL_ONE = 1 << SCAN_SUBPIXEL_BITS,
+};
+
+/**
+ * @brief A vertex in 1/256 pixel units, (0, 0) is the center of pixel (0, 0)
+ *
+ * Coordinates must stay within +-2^40 so that the edge arithmetic cannot overflow.
+ */
+typedef struct ScanPoint
+{
+    int64_t x, y;
+} ScanPoint;
+
+/**
+ * @brief Receives one span [x0, x1) on row y, already clipped
+ *
+ */
+typedef void (*ScanSpanFn)(void *context, int32_t x0, int32_t x1, int32_t y);
+
+/**
+ * @brief Converts a polygon with one or more contours into spans
+ *
+ * Pixel centers inside the polygon are covered, following the top-left rule
+ * described for `fill_polygon`. Rows are emitted from top to bottom and the
+ * spans of a row from left to right without overlapping.
+ *
+ * @param clip Rectangle the spans are clipped against
+ * @param points Vertices of all contours one after another
+ * @param ends Index one past the last vertex of every contour
+ * @param contours Number of contours
+ * @param rule Fill rule applied across all contours
+ * @param emit Called for every span
+ * @param context Passed to `emit`
+ * @return false if memory for the edges could not be allocated
+ */
+bool scan_polygon(const Rect *clip, const ScanPoint *points, const size_t *ends, size_t contours, FillRule rule,
+                  ScanSpanFn emit, void *context);
@@ -0,0 +1,941 @@
+/**
+ * @file scene.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <circle.h>
+#include <defs.h>
+#include <fill.h>
+#include <line.h>
+#include <point.h>
+#include <polygon.h>
+#include <scene.h>
+#include <span.h>
+#include <text.h>
+#include <triangle.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief Sizes of the binary format
+ *
+ */
+enum
+{
+    SCENE_HEADER_WORDS = 8,
+    SCENE_VERSION = 1,
+    SCENE_BATCH_MAX = 1 << 24,  // Primitives per batch record, keeps record lengths far below 2^32 words
+    SCENE_POINTS_MAX = 1 << 20, // Points of one polygon in a text scene
+};
+
+struct Scene
+{
+    int32_t width, height;
+    const uint32_t *words; // Records
+    size_t count;          // Number of words in `words`
+    uint32_t *owned;       // Words built by the parser, or the file on systems without mmap
+    void *map;             // Mapping of a binary file, NULL otherwise
+    size_t map_size;
+};
+
+/**
+ * @brief Formats an error into the caller's buffer, if there is one
+ *
+ */
+static void scene_error(char *message, size_t message_size, const char *format, ...)
+{
+    if (message == NULL || message_size == 0)
+        return;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, message_size, format, args);
+    va_end(args);
+}
+
+#pragma region Words
+/**
+ * @brief A growable array of 32-bit words
+ *
+ */
+typedef struct Words
+{
+    uint32_t *data;
+    size_t size;
+    size_t capacity;
+    bool failed; // An allocation failed, later pushes are ignored
+} Words;
+
+static bool words_reserve(Words *words, size_t count)
+{
+    if (words->failed)
+        return false;
+    if (words->size + count <= words->capacity)
+        return true;
+    size_t capacity = words->capacity > 0 ? words->capacity : 1024;
+    while (capacity < words->size + count)
+        capacity *= 2;
+    uint32_t *data = (uint32_t *)realloc(words->data, capacity * sizeof(uint32_t));
+    if (data == NULL)
+    {
+        words->failed = true;
+        return false;
+    }
+    words->data = data;
+    words->capacity = capacity;
+    return true;
+}
+
+static inline void words_push(Words *words, uint32_t value)
+{
+    if (words->size < words->capacity || words_reserve(words, 1))
+        words->data[words->size++] = value;
+}
+
+static void words_append(Words *words, const uint32_t *values, size_t count)
+{
+    if (count == 0 || !words_reserve(words, count))
+        return;
+    memcpy(words->data + words->size, values, count * sizeof(uint32_t));
+    words->size += count;
+}
+#pragma endregion Words
+
+#pragma region Records
+/**
+ * @brief Returns the number of words a record of `op` with `count` primitives takes, 0 for unknown records
+ *
+ * @param op Opcode
+ * @param count Primitives or points of batch and polygon records, ignored by the others
+ */
+static uint64_t record_words(uint32_t op, uint64_t count)
+{
+    switch ((SceneOp)op)
+    {
+    case SCENE_CLEAR:
+    case SCENE_BLEND:
+        return 3;
+    case SCENE_CLIP:
+        return 6;
+    case SCENE_RESET_CLIP:
+        return 2;
+    case SCENE_POINTS:
+    case SCENE_POLYGON:
+        return 4 + 2 * count;
+    case SCENE_LINES:
+        return 5 + 4 * count;
+    case SCENE_CIRCLES:
+    case SCENE_FILL_CIRCLES:
+        return 4 + 3 * count;
+    case SCENE_RECTS:
+        return 4 + 4 * count;
+    case SCENE_TRIANGLES:
+        return 4 + 6 * count;
+    case SCENE_FILL_POLYGON:
+        return 5 + 2 * count;
+    case SCENE_FLOOD:
+        return 5;
+    case SCENE_BOUNDARY:
+        return 6;
+    case SCENE_TEXT:
+        break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the index of the count word of a batch or polygon record, 0 for the others
+ *
+ */
+static uint32_t record_count_index(uint32_t op)
+{
+    switch ((SceneOp)op)
+    {
+    case SCENE_POINTS:
+    case SCENE_CIRCLES:
+    case SCENE_FILL_CIRCLES:
+    case SCENE_RECTS:
+    case SCENE_TRIANGLES:
+    case SCENE_POLYGON:
+        return 3;
+    case SCENE_LINES:
+    case SCENE_FILL_POLYGON:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Checks that every record of a scene lies inside it and has the length its contents need
+ *
+ * Rendering relies on this and does not check anything. The cost depends on
+ * the number of records, not on the primitives batched inside them.
+ */
+static bool records_check(const uint32_t *words, size_t count, char *message, size_t message_size)
+{
+    for (size_t at = 0; at < count;)
+    {
+        const uint32_t *record = words + at;
+        if (count - at < 2 || record[1] < 2 || record[1] > count - at)
+        {
+            scene_error(message, message_size, "record at word %zu exceeds the scene", at);
+            return false;
+        }
+
+        uint32_t op = record[0], length = record[1];
+        bool valid;
+        if (op == SCENE_TEXT)
+        {
+            // x y size color, then the text whose last byte is its terminating NUL
+            valid = length >= 7 && ((const uint8_t *)(record + length))[-1] == 0;
+        }
+        else
+        {
+            uint32_t index = record_count_index(op);
+            valid = (index == 0 || length > index) && record_words(op, index > 0 ? record[index] : 0) == length;
+            if (op == SCENE_BLEND)
+                valid = valid && record[2] <= BLEND_MULTIPLY;
+            if (op == SCENE_FILL_POLYGON)
+                valid = valid && record[3] <= FILL_NON_ZERO;
+        }
+        if (!valid)
+        {
+            scene_error(message, message_size, "invalid record of type %u at word %zu", op, at);
+            return false;
+        }
+        at += length;
+    }
+    return true;
+}
+#pragma endregion Records
+
+#pragma region Text Format
+/**
+ * @brief Parser state of a text scene, collecting consecutive primitives of the same kind into one batch
+ *
+ */
+typedef struct Parser
+{
+    Words out;
+    uint32_t batch_op;     // Opcode of the open batch, 0 if none
+    uint32_t batch_key[2]; // Color and thickness the batch was opened with
+    uint32_t batch_size;   // Primitives in the open batch
+    Words columns[6];
+    Words points;          // Points of the current polygon
+    int32_t width, height;
+    size_t line;
+    char *message;
+    size_t message_size;
+} Parser;
+
+/**
+ * @brief A line of text being split into tokens
+ *
+ */
+typedef struct Cursor
+{
+    const char *at;
+    const char *end;
+} Cursor;
+
+static bool parser_fail(Parser *parser, const char *what)
+{
+    scene_error(parser->message, parser->message_size, "line %zu: %s", parser->line, what);
+    return false;
+}
+
+static void cursor_skip(Cursor *cursor)
+{
+    while (cursor->at < cursor->end && (*cursor->at == ' ' || *cursor->at == '\t' || *cursor->at == '\r'))
+        cursor->at++;
+}
+
+/**
+ * @brief Returns the next token of the line
+ *
+ * @return false at the end of the line
+ */
+static bool cursor_token(Cursor *cursor, const char **token, size_t *length)
+{
+    cursor_skip(cursor);
+    if (cursor->at == cursor->end)
+        return false;
+    *token = cursor->at;
+    while (cursor->at < cursor->end && *cursor->at != ' ' && *cursor->at != '\t' && *cursor->at != '\r')
+        cursor->at++;
+    *length = (size_t)(cursor->at - *token);
+    return true;
+}
+
+static bool token_is(const char *token, size_t length, const char *word)
+{
+    return strlen(word) == length && memcmp(token, word, length) == 0;
+}
+
+static bool cursor_int(Cursor *cursor, int32_t *value)
+{
+    const char *token;
+    size_t length;
+    if (!cursor_token(cursor, &token, &length))
+        return false;
+
+    size_t i = token[0] == '-' || token[0] == '+' ? 1 : 0;
+    if (i == length)
+        return false;
+    int64_t magnitude = 0;
+    for (; i < length; i++)
+    {
+        if (token[i] < '0' || token[i] > '9')
+            return false;
+        magnitude = magnitude * 10 + (token[i] - '0');
+        if (magnitude > (int64_t)INT32_MAX + 1)
+            return false;
+    }
+    int64_t result = token[0] == '-' ? -magnitude : magnitude;
+    if (result > INT32_MAX)
+        return false;
+    *value = (int32_t)result;
+    return true;
+}
+
+static bool cursor_color(Cursor *cursor, uint32_t *color)
+{
+    static const struct
+    {
+        const char *name;
+        uint32_t color;
+    } names[] = {{"black", BLACK}, {"white", WHITE}, {"red", RED}, {"green", GREEN}, {"blue", BLUE}};
+
+    const char *token;
+    size_t length;
+    if (!cursor_token(cursor, &token, &length))
+        return false;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        if (token_is(token, length, names[i].name))
+        {
+            *color = names[i].color;
+            return true;
+        }
+
+    if (token[0] != '#' || (length != 7 && length != 9))
+        return false;
+    uint32_t value = 0;
+    for (size_t i = 1; i < length; i++)
+    {
+        char c = token[i];
+        uint32_t digit = c >= '0' && c <= '9' ? (uint32_t)(c - '0')
+                         : c >= 'a' && c <= 'f' ? (uint32_t)(c - 'a' + 10)
+                         : c >= 'A' && c <= 'F' ? (uint32_t)(c - 'A' + 10)
+                                                : 16u;
+        if (digit == 16)
+            return false;
+        value = value << 4 | digit;
+    }
+    *color = length == 7 ? value << 8 | 0xFF : value;
+    return true;
+}
+
+/**
+ * @brief Parses a quoted string with the escapes \", \\ and \n into `out`, NUL-terminated and padded to whole words
+ *
+ */
+static bool cursor_string(Cursor *cursor, Words *out)
+{
+    cursor_skip(cursor);
+    if (cursor->at == cursor->end || *cursor->at != '"')
+        return false;
+    cursor->at++;
+
+    uint32_t word = 0, used = 0;
+    for (;;)
+    {
+        if (cursor->at == cursor->end)
+            return false;
+        char c = *cursor->at++;
+        if (c == '"')
+            break;
+        if (c == '\\')
+        {
+            if (cursor->at == cursor->end)
+                return false;
+            c = *cursor->at++;
+            c = c == 'n' ? '\n' : c;
+        }
+        if (c == '\0')
+            return false;
+        // Bytes are packed in memory order, which the format fixes to little-endian
+        word |= (uint32_t)(uint8_t)c << (8 * used);
+        if (++used == 4)
+        {
+            words_push(out, word);
+            word = 0;
+            used = 0;
+        }
+    }
+    words_push(out, word); // Holds the terminating NUL, and the padding
+    return true;
+}
+
+static bool cursor_end(Cursor *cursor)
+{
+    cursor_skip(cursor);
+    return cursor->at == cursor->end;
+}
+
+/**
+ * @brief Writes the open batch as one record
+ *
+ */
+static void parser_flush(Parser *parser)
+{
+    if (parser->batch_op == 0)
+        return;
+    Words *out = &parser->out;
+    uint32_t op = parser->batch_op;
+    words_push(out, op);
+    words_push(out, (uint32_t)record_words(op, parser->batch_size));
+    words_push(out, parser->batch_key[0]);
+    if (op == SCENE_LINES)
+        words_push(out, parser->batch_key[1]);
+    words_push(out, parser->batch_size);
+    for (size_t k = 0; k < 6; k++)
+    {
+        words_append(out, parser->columns[k].data, parser->columns[k].size);
+        parser->columns[k].size = 0;
+    }
+    parser->batch_op = 0;
+    parser->batch_size = 0;
+}
+
+/**
+ * @brief Adds a primitive to the open batch, opening a new one if its kind or color differ
+ *
+ * Triangles keep all six coordinates in the first column, the other batches
+ * one column per value.
+ */
+static void parser_batch(Parser *parser, uint32_t op, uint32_t color, uint32_t thickness, const int32_t *values, size_t count)
+{
+    if (parser->batch_op != op || parser->batch_key[0] != color || parser->batch_key[1] != thickness ||
+        parser->batch_size == SCENE_BATCH_MAX)
+    {
+        parser_flush(parser);
+        parser->batch_op = op;
+        parser->batch_key[0] = color;
+        parser->batch_key[1] = thickness;
+    }
+    for (size_t k = 0; k < count; k++)
+        words_push(&parser->columns[op == SCENE_TRIANGLES ? 0 : k], (uint32_t)values[k]);
+    parser->batch_size++;
+}
+
+/**
+ * @brief Writes a record of fixed length
+ *
+ */
+static void parser_record(Parser *parser, uint32_t op, const uint32_t *values, size_t count)
+{
+    parser_flush(parser);
+    words_push(&parser->out, op);
+    words_push(&parser->out, (uint32_t)(2 + count));
+    words_append(&parser->out, values, count);
+}
+
+/**
+ * @brief Parses the points of a polygon until the end of the line
+ *
+ */
+static bool parser_points(Parser *parser, Cursor *cursor)
+{
+    parser->points.size = 0;
+    int32_t x, y;
+    while (!cursor_end(cursor))
+    {
+        if (!cursor_int(cursor, &x) || !cursor_int(cursor, &y))
+            return parser_fail(parser, "expected x y pairs");
+        if (parser->points.size >= 2 * SCENE_POINTS_MAX)
+            return parser_fail(parser, "too many points");
+        words_push(&parser->points, (uint32_t)x);
+        words_push(&parser->points, (uint32_t)y);
+    }
+    return true;
+}
+
+/**
+ * @brief Parses one command line
+ *
+ */
+static bool parser_line(Parser *parser, Cursor *cursor)
+{
+    const char *name;
+    size_t length;
+    if (!cursor_token(cursor, &name, &length) || name[0] == '#')
+        return true; // Empty or comment
+
+    bool sized = parser->width > 0;
+    if (token_is(name, length, "size"))
+    {
+        if (sized)
+            return parser_fail(parser, "size given twice");
+        int32_t width, height;
+        if (!cursor_int(cursor, &width) || !cursor_int(cursor, &height) || width <= 0 || height <= 0 || !cursor_end(cursor))
+            return parser_fail(parser, "expected size width height");
+        parser->width = width;
+        parser->height = height;
+        return true;
+    }
+    if (!sized)
+        return parser_fail(parser, "the scene must start with size");
+
+    int32_t v[6];
+    uint32_t color, boundary;
+    if (token_is(name, length, "line"))
+    {
+        if (!cursor_int(cursor, &v[0]) || !cursor_int(cursor, &v[1]) || !cursor_int(cursor, &v[2]) ||
+            !cursor_int(cursor, &v[3]) || !cursor_color(cursor, &color))
+            return parser_fail(parser, "expected line x0 y0 x1 y1 color [thickness]");
+        int32_t thickness = 1;
+        if (!cursor_end(cursor) && (!cursor_int(cursor, &thickness) || !cursor_end(cursor)))
+            return parser_fail(parser, "expected line x0 y0 x1 y1 color [thickness]");
+        parser_batch(parser, SCENE_LINES, color, (uint32_t)(thickness > 1 ? thickness : 1), v, 4);
+        return true;
+    }
+
+    static const struct
+    {
+        const char *name;
+        SceneOp op;
+        size_t values; // Integers before the color
+        const char *usage;
+    } batches[] = {
+        {"point", SCENE_POINTS, 2, "expected point x y color"},
+        {"circle", SCENE_CIRCLES, 3, "expected circle cx cy r color"},
+        {"fill_circle", SCENE_FILL_CIRCLES, 3, "expected fill_circle cx cy r color"},
+        {"rect", SCENE_RECTS, 4, "expected rect x y width height color"},
+        {"triangle", SCENE_TRIANGLES, 6, "expected triangle x0 y0 x1 y1 x2 y2 color"},
+    };
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+    {
+        if (!token_is(name, length, batches[i].name))
+            continue;
+        bool ok = true;
+        for (size_t k = 0; k < batches[i].values && ok; k++)
+            ok = cursor_int(cursor, &v[k]);
+        if (!ok || !cursor_color(cursor, &color) || !cursor_end(cursor))
+            return parser_fail(parser, batches[i].usage);
+        parser_batch(parser, batches[i].op, color, 0, v, batches[i].values);
+        return true;
+    }
+
+    if (token_is(name, length, "clear"))
+    {
+        if (!cursor_color(cursor, &color) || !cursor_end(cursor))
+            return parser_fail(parser, "expected clear color");
+        parser_record(parser, SCENE_CLEAR, &color, 1);
+    }
+    else if (token_is(name, length, "blend"))
+    {
+        static const char *modes[] = {"none", "over", "add", "multiply"};
+        const char *mode;
+        size_t mode_length;
+        uint32_t index = 4;
+        if (cursor_token(cursor, &mode, &mode_length))
+            for (uint32_t m = 0; m < 4; m++)
+                index = token_is(mode, mode_length, modes[m]) ? m : index;
+        if (index == 4 || !cursor_end(cursor))
+            return parser_fail(parser, "expected blend none|over|add|multiply");
+        parser_record(parser, SCENE_BLEND, &index, 1);
+    }
+    else if (token_is(name, length, "clip"))
+    {
+        Cursor peek = *cursor;
+        const char *word;
+        size_t word_length;
+        if (cursor_token(&peek, &word, &word_length) && token_is(word, word_length, "reset") && cursor_end(&peek))
+            parser_record(parser, SCENE_RESET_CLIP, NULL, 0);
+        else if (cursor_int(cursor, &v[0]) && cursor_int(cursor, &v[1]) && cursor_int(cursor, &v[2]) &&
+                 cursor_int(cursor, &v[3]) && cursor_end(cursor))
+            parser_record(parser, SCENE_CLIP, (const uint32_t *)v, 4);
+        else
+            return parser_fail(parser, "expected clip x y width height or clip reset");
+    }
+    else if (token_is(name, length, "polygon") || token_is(name, length, "fill_polygon"))
+    {
+        bool fill = name[0] == 'f';
+        uint32_t rule = FILL_EVEN_ODD;
+        if (fill)
+        {
+            const char *word;
+            size_t word_length;
+            if (!cursor_token(cursor, &word, &word_length) ||
+                (!token_is(word, word_length, "evenodd") && !token_is(word, word_length, "nonzero")))
+                return parser_fail(parser, "expected fill_polygon evenodd|nonzero color points");
+            rule = word[0] == 'n' ? FILL_NON_ZERO : FILL_EVEN_ODD;
+        }
+        if (!cursor_color(cursor, &color))
+            return parser_fail(parser, "expected a color");
+        if (!parser_points(parser, cursor))
+            return false;
+
+        uint32_t count = (uint32_t)(parser->points.size / 2);
+        parser_flush(parser);
+        uint32_t op = fill ? SCENE_FILL_POLYGON : SCENE_POLYGON;
+        words_push(&parser->out, op);
+        words_push(&parser->out, (uint32_t)record_words(op, count));
+        words_push(&parser->out, color);
+        if (fill)
+            words_push(&parser->out, rule);
+        words_push(&parser->out, count);
+        words_append(&parser->out, parser->points.data, parser->points.size);
+    }
+    else if (token_is(name, length, "text"))
+    {
+        if (!cursor_int(cursor, &v[0]) || !cursor_int(cursor, &v[1]) || !cursor_int(cursor, &v[2]) ||
+            !cursor_color(cursor, &color))
+            return parser_fail(parser, "expected text x y size color \"text\"");
+        parser_flush(parser);
+        size_t start = parser->out.size;
+        uint32_t head[6] = {SCENE_TEXT, 0, (uint32_t)v[0], (uint32_t)v[1], (uint32_t)v[2], color};
+        words_append(&parser->out, head, 6);
+        if (!cursor_string(cursor, &parser->out) || !cursor_end(cursor))
+            return parser_fail(parser, "expected a quoted string");
+        if (!parser->out.failed)
+            parser->out.data[start + 1] = (uint32_t)(parser->out.size - start);
+    }
+    else if (token_is(name, length, "flood"))
+    {
+        if (!cursor_int(cursor, &v[0]) || !cursor_int(cursor, &v[1]) || !cursor_color(cursor, &color) || !cursor_end(cursor))
+            return parser_fail(parser, "expected flood x y color");
+        uint32_t values[3] = {(uint32_t)v[0], (uint32_t)v[1], color};
+        parser_record(parser, SCENE_FLOOD, values, 3);
+    }
+    else if (token_is(name, length, "boundary"))
+    {
+        if (!cursor_int(cursor, &v[0]) || !cursor_int(cursor, &v[1]) || !cursor_color(cursor, &boundary) ||
+            !cursor_color(cursor, &color) || !cursor_end(cursor))
+            return parser_fail(parser, "expected boundary x y boundary_color color");
+        uint32_t values[4] = {(uint32_t)v[0], (uint32_t)v[1], boundary, color};
+        parser_record(parser, SCENE_BOUNDARY, values, 4);
+    }
+    else
+    {
+        char what[64];
+        snprintf(what, sizeof(what), "unknown command '%.*s'", (int)(length < 32 ? length : 32), name);
+        return parser_fail(parser, what);
+    }
+    return true;
+}
+#pragma endregion Text Format
+
+Scene *scene_parse(const char *text, size_t size, char *message, size_t message_size)
+{
+    Parser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.message = message;
+    parser.message_size = message_size;
+
+    bool ok = true;
+    for (const char *at = text, *end = text + size; at < end && ok;)
+    {
+        const char *eol = (const char *)memchr(at, '\n', (size_t)(end - at));
+        eol = eol != NULL ? eol : end;
+        parser.line++;
+        Cursor cursor = {at, eol};
+        ok = parser_line(&parser, &cursor);
+        at = eol + 1;
+    }
+    if (ok && parser.width == 0)
+        ok = parser_fail(&parser, "the scene has no size");
+    parser_flush(&parser);
+    if (ok && parser.out.failed)
+    {
+        scene_error(message, message_size, "out of memory");
+        ok = false;
+    }
+
+    for (size_t k = 0; k < 6; k++)
+        free(parser.columns[k].data);
+    free(parser.points.data);
+    Scene *scene = ok ? (Scene *)calloc(1, sizeof(Scene)) : NULL;
+    if (scene == NULL)
+    {
+        free(parser.out.data);
+        return NULL;
+    }
+    scene->width = parser.width;
+    scene->height = parser.height;
+    scene->owned = parser.out.data;
+    scene->words = parser.out.data;
+    scene->count = parser.out.size;
+    return scene;
+}
+
+#pragma region Files
+/**
+ * @brief Makes the contents of a file available in memory, mapped where possible
+ *
+ * @param data Receives the contents
+ * @param size Receives the size in bytes
+ * @param map Receives the mapping to release, NULL if the contents were read into allocated memory
+ */
+static bool file_open(const char *path, const uint8_t **data, size_t *size, void **map)
+{
+    *map = NULL;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    *size = (size_t)info.st_size;
+    if (*size == 0)
+    {
+        close(fd);
+        *data = (const uint8_t *)"";
+        return true;
+    }
+    void *mapping = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+    *map = mapping;
+    *data = (const uint8_t *)mapping;
+    return true;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    // Words, so that a binary scene read this way is aligned like a mapping
+    uint32_t *buffer = length >= 0 ? (uint32_t *)malloc(((size_t)length / 4 + 1) * 4) : NULL;
+    bool ok = buffer != NULL && fread(buffer, 1, (size_t)length, file) == (size_t)length;
+    fclose(file);
+    if (!ok)
+    {
+        free(buffer);
+        return false;
+    }
+    *data = (const uint8_t *)buffer;
+    *size = (size_t)length;
+    return true;
+#endif
+}
+
+static void file_close(const uint8_t *data, size_t size, void *map)
+{
+#ifndef _WIN32
+    if (map != NULL)
+        munmap(map, size);
+    (void)data;
+#else
+    (void)size;
+    (void)map;
+    free((void *)data);
+#endif
+}
+#pragma endregion Files
+
+Scene *scene_load(const char *path, char *message, size_t message_size)
+{
+    const uint8_t *data;
+    size_t size;
+    void *map;
+    if (!file_open(path, &data, &size, &map))
+    {
+        scene_error(message, message_size, "cannot read %s", path);
+        return NULL;
+    }
+
+    if (size < 4 || memcmp(data, "RSCN", 4) != 0)
+    {
+        Scene *scene = scene_parse((const char *)data, size, message, message_size);
+        file_close(data, size, map);
+        return scene;
+    }
+
+    const uint16_t order = 1;
+    const uint32_t *header = (const uint32_t *)data;
+    uint64_t words = size >= SCENE_HEADER_WORDS * 4 ? (uint64_t)header[5] << 32 | header[4] : 0;
+    const char *problem = NULL;
+    if (*(const uint8_t *)&order != 1)
+        problem = "binary scenes need a little-endian system";
+    else if (size < SCENE_HEADER_WORDS * 4 || header[1] != SCENE_VERSION)
+        problem = "unsupported binary scene";
+    else if ((int32_t)header[2] <= 0 || (int32_t)header[3] <= 0 || words > (size - SCENE_HEADER_WORDS * 4) / 4)
+        problem = "corrupt binary scene header";
+    if (problem != NULL)
+    {
+        scene_error(message, message_size, "%s", problem);
+        file_close(data, size, map);
+        return NULL;
+    }
+
+    Scene *scene = (Scene *)calloc(1, sizeof(Scene));
+    if (scene == NULL || !records_check(header + SCENE_HEADER_WORDS, (size_t)words, message, message_size))
+    {
+        free(scene);
+        file_close(data, size, map);
+        return NULL;
+    }
+    scene->width = (int32_t)header[2];
+    scene->height = (int32_t)header[3];
+    scene->words = header + SCENE_HEADER_WORDS;
+    scene->count = (size_t)words;
+    scene->map = map;
+    scene->map_size = size;
+    scene->owned = map == NULL ? (uint32_t *)data : NULL;
+    return scene;
+}
+
+void scene_destroy(Scene *scene)
+{
+    if (scene == NULL)
+        return;
+    if (scene->map != NULL)
+        file_close(NULL, scene->map_size, scene->map);
+    free(scene->owned);
+    free(scene);
+}
+
+int32_t scene_width(const Scene *scene)
+{
+    return scene->width;
+}
+
+int32_t scene_height(const Scene *scene)
+{
+    return scene->height;
+}
+
+bool scene_render(const Scene *scene, Pixmap *pixmap)
+{
+    Font *font = NULL;
+    bool ok = true;
+    for (const uint32_t *record = scene->words, *end = scene->words + scene->count; record < end; record += record[1])
+    {
+        const int32_t *v = (const int32_t *)record + 2;
+        uint32_t color = record[2];
+        switch ((SceneOp)record[0])
+        {
+        case SCENE_CLEAR:
+            pixmap_clear(pixmap, color);
+            break;
+        case SCENE_BLEND:
+            pixmap_set_blend(pixmap, (BlendMode)record[2]);
+            break;
+        case SCENE_CLIP:
+            pixmap_set_clip(pixmap, v[0], v[1], v[2], v[3]);
+            break;
+        case SCENE_RESET_CLIP:
+            pixmap_reset_clip(pixmap);
+            break;
+        case SCENE_POINTS:
+        {
+            size_t count = record[3];
+            const int32_t *x = v + 2, *y = x + count;
+            for (size_t i = 0; i < count; i++)
+                draw_point(pixmap, x[i], y[i], color);
+            break;
+        }
+        case SCENE_LINES:
+        {
+            // The columns are drawn straight from the file
+            int32_t thickness = v[1];
+            size_t count = record[4];
+            const int32_t *x0 = v + 3, *y0 = x0 + count, *x1 = y0 + count, *y1 = x1 + count;
+            if (thickness <= 1)
+                draw_lines(pixmap, x0, y0, x1, y1, count, color);
+            else
+                for (size_t i = 0; i < count; i++)
+                    draw_line(pixmap, x0[i], y0[i], x1[i], y1[i], thickness, color);
+            break;
+        }
+        case SCENE_CIRCLES:
+        case SCENE_FILL_CIRCLES:
+        {
+            size_t count = record[3];
+            const int32_t *cx = v + 2, *cy = cx + count, *r = cy + count;
+            if (record[0] == SCENE_FILL_CIRCLES)
+                fill_circles(pixmap, cx, cy, r, count, color);
+            else
+                for (size_t i = 0; i < count; i++)
+                    draw_circle(pixmap, cx[i], cy[i], r[i], color);
+            break;
+        }
+        case SCENE_RECTS:
+        {
+            size_t count = record[3];
+            const int32_t *x = v + 2, *y = x + count, *w = y + count, *h = w + count;
+            for (size_t i = 0; i < count; i++)
+                fill_rect(pixmap, x[i], y[i], w[i], h[i], color);
+            break;
+        }
+        case SCENE_TRIANGLES:
+        {
+            const int32_t *t = v + 2;
+            for (size_t i = 0; i < record[3]; i++, t += 6)
+                fill_triangle(pixmap, t[0], t[1], t[2], t[3], t[4], t[5], color);
+            break;
+        }
+        case SCENE_POLYGON:
+            draw_polygon(pixmap, (const Point *)(v + 2), record[3], color);
+            break;
+        case SCENE_FILL_POLYGON:
+            fill_polygon(pixmap, (const Point *)(v + 3), record[4], (FillRule)record[3], color);
+            break;
+        case SCENE_TEXT:
+            if (font == NULL && (font = font_create()) == NULL)
+            {
+                ok = false;
+                break;
+            }
+            draw_text(pixmap, font, v[0], v[1], v[2], (const char *)(v + 4), (uint32_t)v[3]);
+            break;
+        case SCENE_FLOOD:
+            flood_fill(pixmap, v[0], v[1], record[4]);
+            break;
+        case SCENE_BOUNDARY:
+            boundary_fill(pixmap, v[0], v[1], record[4], record[5]);
+            break;
+        }
+    }
+    font_destroy(font);
+    return ok;
+}
+
+bool scene_save(const Scene *scene, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+
+    uint32_t header[SCENE_HEADER_WORDS] = {0};
+    memcpy(header, "RSCN", 4);
+    header[1] = SCENE_VERSION;
+    header[2] = (uint32_t)scene->width;
+    header[3] = (uint32_t)scene->height;
+    header[4] = (uint32_t)((uint64_t)scene->count & 0xFFFFFFFFu);
+    header[5] = (uint32_t)((uint64_t)scene->count >> 32);
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(scene->words, sizeof(uint32_t), scene->count, file) == scene->count;
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
@@ -0,0 +1,467 @@
+/**
+ * @file span.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <span.h>
+
+#include "cpu.h"
+#include "raster.h"
+
+#include <string.h>
+
+#pragma region Kernels
+static void span_fill_scalar(uint32_t *dst, size_t count, uint32_t color)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = color;
+}
+
+#if RENDERER_X86
+/**
+ * @brief Fills scalar pixels until `dst` is aligned to `alignment` bytes
+ *
+ * @return Number of pixels written
+ */
+static inline size_t span_fill_head(uint32_t *dst, size_t count, uint32_t color, size_t alignment)
+{
+    size_t head = (alignment - ((uintptr_t)dst & (alignment - 1))) / sizeof(uint32_t);
+    if ((uintptr_t)dst & (sizeof(uint32_t) - 1))
+        head = count; // Misaligned pixels, stay scalar
+    if (head > count)
+        head = count;
+    for (size_t i = 0; i < head; i++)
+        dst[i] = color;
+    return head;
+}
+
+TARGET("sse2") static void span_fill_sse2(uint32_t *dst, size_t count, uint32_t color)
+{
+    size_t i = span_fill_head(dst, count, color, 16);
+    __m128i value = _mm_set1_epi32((int)color);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm_store_si128((__m128i *)(dst + i), value);
+        _mm_store_si128((__m128i *)(dst + i + 4), value);
+    }
+    for (; i < count; i++)
+        dst[i] = color;
+}
+
+TARGET("sse2") static void span_stream_sse2(uint32_t *dst, size_t count, uint32_t color)
+{
+    size_t i = span_fill_head(dst, count, color, 16);
+    __m128i value = _mm_set1_epi32((int)color);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm_stream_si128((__m128i *)(dst + i), value);
+        _mm_stream_si128((__m128i *)(dst + i + 4), value);
+    }
+    _mm_sfence();
+    for (; i < count; i++)
+        dst[i] = color;
+}
+
+TARGET("avx2") static void span_fill_avx2(uint32_t *dst, size_t count, uint32_t color)
+{
+    size_t i = span_fill_head(dst, count, color, 32);
+    __m256i value = _mm256_set1_epi32((int)color);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm256_store_si256((__m256i *)(dst + i), value);
+        _mm256_store_si256((__m256i *)(dst + i + 8), value);
+    }
+    if (i < count)
+    {
+        // Masked store of the remaining 1-15 pixels
+        __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (; i < count; i += 8)
+        {
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(count - i)), lanes);
+            _mm256_maskstore_epi32((int *)(dst + i), mask, value);
+        }
+    }
+}
+
+TARGET("avx2") static void span_stream_avx2(uint32_t *dst, size_t count, uint32_t color)
+{
+    size_t i = span_fill_head(dst, count, color, 32);
+    __m256i value = _mm256_set1_epi32((int)color);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm256_stream_si256((__m256i *)(dst + i), value);
+        _mm256_stream_si256((__m256i *)(dst + i + 8), value);
+    }
+    _mm_sfence();
+    for (; i < count; i++)
+        dst[i] = color;
+}
+#endif
+
+static SpanKernel select_span_kernel(bool stream)
+{
+#if RENDERER_X86
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return stream ? span_stream_avx2 : span_fill_avx2;
+    if (features & CPU_SSE2)
+        return stream ? span_stream_sse2 : span_fill_sse2;
+#endif
+    return span_fill_scalar;
+}
+
+const SpanKernel span_kernel = select_span_kernel(false);
+const SpanKernel span_kernel_stream = select_span_kernel(true);
+#pragma endregion Kernels
+
+#pragma region Blend Kernels
+static void blend_over_scalar(uint32_t *dst, size_t count, uint32_t color)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = color_composite(BLEND_SRC_OVER, dst[i], color);
+}
+
+static void blend_add_scalar(uint32_t *dst, size_t count, uint32_t color)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = color_composite(BLEND_ADD, dst[i], color);
+}
+
+static void blend_multiply_scalar(uint32_t *dst, size_t count, uint32_t color)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = color_composite(BLEND_MULTIPLY, dst[i], color);
+}
+
+#if RENDERER_X86
+/*
+ * The vector kernels widen every channel to 16 bits, two pixels per 128-bit
+ * half. A pixel 0xRRGGBBAA occupies the lanes A, B, G, R, so its alpha sits in
+ * the lowest lane and is broadcast with one shuffle per half.
+ */
+
+TARGET("sse2") static inline __m128i div255_sse2(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+TARGET("sse2") static inline __m128i blend_over4_sse2(__m128i d, __m128i src, __m128i inv_alpha)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = div255_sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv_alpha));
+    __m128i hi = div255_sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv_alpha));
+    return _mm_adds_epu8(_mm_packus_epi16(lo, hi), src);
+}
+
+TARGET("sse2") static inline __m128i blend_multiply2_sse2(__m128i d, __m128i src, __m128i scale)
+{
+    // d * (s + 255 - sa) + s * (255 - da), per channel
+    __m128i da = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d, 0), 0);
+    __m128i x = _mm_mullo_epi16(d, scale);
+    x = _mm_add_epi16(x, _mm_mullo_epi16(src, _mm_sub_epi16(_mm_set1_epi16(255), da)));
+    return div255_sse2(x);
+}
+
+TARGET("sse2") static void blend_over_sse2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m128i src = _mm_set1_epi32((int)color);
+    __m128i inv_alpha = _mm_set1_epi16((short)(255 - (color & 0xFFu)));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i *p = (__m128i *)(dst + i);
+        _mm_storeu_si128(p, blend_over4_sse2(_mm_loadu_si128(p), src, inv_alpha));
+        _mm_storeu_si128(p + 1, blend_over4_sse2(_mm_loadu_si128(p + 1), src, inv_alpha));
+    }
+    blend_over_scalar(dst + i, count - i, color);
+}
+
+TARGET("sse2") static void blend_add_sse2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m128i src = _mm_set1_epi32((int)color);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i *p = (__m128i *)(dst + i);
+        _mm_storeu_si128(p, _mm_adds_epu8(_mm_loadu_si128(p), src));
+        _mm_storeu_si128(p + 1, _mm_adds_epu8(_mm_loadu_si128(p + 1), src));
+    }
+    blend_add_scalar(dst + i, count - i, color);
+}
+
+TARGET("sse2") static void blend_multiply_sse2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+    __m128i scale = _mm_add_epi16(src, _mm_set1_epi16((short)(255 - (color & 0xFFu))));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        for (size_t j = 0; j < 8; j += 4)
+        {
+            __m128i *p = (__m128i *)(dst + i + j);
+            __m128i d = _mm_loadu_si128(p);
+            __m128i lo = blend_multiply2_sse2(_mm_unpacklo_epi8(d, zero), src, scale);
+            __m128i hi = blend_multiply2_sse2(_mm_unpackhi_epi8(d, zero), src, scale);
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+    }
+    blend_multiply_scalar(dst + i, count - i, color);
+}
+
+TARGET("avx2") static inline __m256i div255_avx2(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+TARGET("avx2") static void blend_over_avx2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i src = _mm256_set1_epi32((int)color);
+    __m256i inv_alpha = _mm256_set1_epi16((short)(255 - (color & 0xFFu)));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i *p = (__m256i *)(dst + i);
+        __m256i d = _mm256_loadu_si256(p);
+        // Unpack and pack work within 128-bit halves, so the pixel order is preserved
+        __m256i lo = div255_avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv_alpha));
+        __m256i hi = div255_avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv_alpha));
+        _mm256_storeu_si256(p, _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), src));
+    }
+    blend_over_scalar(dst + i, count - i, color);
+}
+
+TARGET("avx2") static void blend_add_avx2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m256i src = _mm256_set1_epi32((int)color);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i *p = (__m256i *)(dst + i);
+        _mm256_storeu_si256(p, _mm256_adds_epu8(_mm256_loadu_si256(p), src));
+    }
+    blend_add_scalar(dst + i, count - i, color);
+}
+
+TARGET("avx2") static inline __m256i blend_multiply4_avx2(__m256i d, __m256i src, __m256i scale)
+{
+    __m256i da = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(d, 0), 0);
+    __m256i x = _mm256_mullo_epi16(d, scale);
+    x = _mm256_add_epi16(x, _mm256_mullo_epi16(src, _mm256_sub_epi16(_mm256_set1_epi16(255), da)));
+    return div255_avx2(x);
+}
+
+TARGET("avx2") static void blend_multiply_avx2(uint32_t *dst, size_t count, uint32_t color)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)color), zero);
+    __m256i scale = _mm256_add_epi16(src, _mm256_set1_epi16((short)(255 - (color & 0xFFu))));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i *p = (__m256i *)(dst + i);
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i lo = blend_multiply4_avx2(_mm256_unpacklo_epi8(d, zero), src, scale);
+        __m256i hi = blend_multiply4_avx2(_mm256_unpackhi_epi8(d, zero), src, scale);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    blend_multiply_scalar(dst + i, count - i, color);
+}
+#endif
+
+static SpanKernel select_blend_kernel(BlendMode mode)
+{
+    static const SpanKernel scalar[] = {span_fill_scalar, blend_over_scalar, blend_add_scalar, blend_multiply_scalar};
+#if RENDERER_X86
+    static const SpanKernel sse2[] = {span_fill_sse2, blend_over_sse2, blend_add_sse2, blend_multiply_sse2};
+    static const SpanKernel avx2[] = {span_fill_avx2, blend_over_avx2, blend_add_avx2, blend_multiply_avx2};
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return avx2[mode];
+    if (features & CPU_SSE2)
+        return sse2[mode];
+#endif
+    return scalar[mode];
+}
+
+const SpanKernel blend_kernels[BLEND_MULTIPLY + 1] = {
+    select_blend_kernel(BLEND_NONE),
+    select_blend_kernel(BLEND_SRC_OVER),
+    select_blend_kernel(BLEND_ADD),
+    select_blend_kernel(BLEND_MULTIPLY),
+};
+#pragma endregion Blend Kernels
+
+#pragma region Coverage Kernels
+template <BlendMode MODE>
+static void mask_blend_scalar(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color)
+{
+    BlendMode mode = MODE == BLEND_NONE ? BLEND_SRC_OVER : MODE;
+    for (size_t i = 0; i < count; i++)
+        if (coverage[i] != 0)
+            dst[i] = color_composite(mode, dst[i], color_scale(color, coverage[i]));
+}
+
+#if RENDERER_X86
+/*
+ * The coverage kernels spread every coverage byte over the four bytes of a
+ * pixel, so that it widens into the same 16-bit lanes as the destination and
+ * scales all channels of the color at once. Groups of 8 uncovered pixels,
+ * common between glyphs, are skipped without touching the destination.
+ */
+
+template <BlendMode MODE>
+TARGET("sse2") static inline __m128i mask_blend2_sse2(__m128i d, __m128i color, __m128i coverage)
+{
+    __m128i s = div255_sse2(_mm_mullo_epi16(color, coverage));
+    __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0), 0);
+    if (MODE == BLEND_ADD)
+        return _mm_add_epi16(d, s);
+    if (MODE == BLEND_MULTIPLY)
+        return blend_multiply2_sse2(d, s, _mm_sub_epi16(_mm_add_epi16(s, _mm_set1_epi16(255)), sa));
+    return _mm_add_epi16(s, div255_sse2(_mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), sa))));
+}
+
+template <BlendMode MODE>
+TARGET("sse2") static void mask_blend_sse2(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i c = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i cov = _mm_loadl_epi64((const __m128i *)(coverage + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(cov, zero)) == 0xFFFF)
+            continue;
+        cov = _mm_unpacklo_epi8(cov, cov);
+        __m128i spread[2] = {_mm_unpacklo_epi16(cov, cov), _mm_unpackhi_epi16(cov, cov)};
+        for (size_t j = 0; j < 2; j++)
+        {
+            __m128i *p = (__m128i *)(dst + i + 4 * j);
+            __m128i d = _mm_loadu_si128(p);
+            __m128i lo = mask_blend2_sse2<MODE>(_mm_unpacklo_epi8(d, zero), c, _mm_unpacklo_epi8(spread[j], zero));
+            __m128i hi = mask_blend2_sse2<MODE>(_mm_unpackhi_epi8(d, zero), c, _mm_unpackhi_epi8(spread[j], zero));
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+    }
+    mask_blend_scalar<MODE>(dst + i, coverage + i, count - i, color);
+}
+
+template <BlendMode MODE>
+TARGET("avx2") static inline __m256i mask_blend4_avx2(__m256i d, __m256i color, __m256i coverage)
+{
+    __m256i s = div255_avx2(_mm256_mullo_epi16(color, coverage));
+    __m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0), 0);
+    if (MODE == BLEND_ADD)
+        return _mm256_add_epi16(d, s);
+    if (MODE == BLEND_MULTIPLY)
+        return blend_multiply4_avx2(d, s, _mm256_sub_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(255)), sa));
+    return _mm256_add_epi16(s, div255_avx2(_mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), sa))));
+}
+
+template <BlendMode MODE>
+TARGET("avx2") static void mask_blend_avx2(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i c = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)color), zero);
+    // Both 128-bit halves hold all 8 coverage bytes, the low half spreads 0-3, the high half 4-7
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                            4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint64_t bytes;
+        memcpy(&bytes, coverage + i, sizeof(bytes));
+        if (bytes == 0)
+            continue;
+        __m256i cov = _mm256_shuffle_epi8(_mm256_set1_epi64x((long long)bytes), spread);
+        __m256i *p = (__m256i *)(dst + i);
+        __m256i d = _mm256_loadu_si256(p);
+        __m256i lo = mask_blend4_avx2<MODE>(_mm256_unpacklo_epi8(d, zero), c, _mm256_unpacklo_epi8(cov, zero));
+        __m256i hi = mask_blend4_avx2<MODE>(_mm256_unpackhi_epi8(d, zero), c, _mm256_unpackhi_epi8(cov, zero));
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    mask_blend_scalar<MODE>(dst + i, coverage + i, count - i, color);
+}
+#endif
+
+static MaskKernel select_mask_kernel(BlendMode mode)
+{
+    static const MaskKernel scalar[] = {mask_blend_scalar<BLEND_SRC_OVER>, mask_blend_scalar<BLEND_SRC_OVER>,
+                                        mask_blend_scalar<BLEND_ADD>, mask_blend_scalar<BLEND_MULTIPLY>};
+#if RENDERER_X86
+    static const MaskKernel sse2[] = {mask_blend_sse2<BLEND_SRC_OVER>, mask_blend_sse2<BLEND_SRC_OVER>,
+                                      mask_blend_sse2<BLEND_ADD>, mask_blend_sse2<BLEND_MULTIPLY>};
+    static const MaskKernel avx2[] = {mask_blend_avx2<BLEND_SRC_OVER>, mask_blend_avx2<BLEND_SRC_OVER>,
+                                      mask_blend_avx2<BLEND_ADD>, mask_blend_avx2<BLEND_MULTIPLY>};
+    uint32_t features = cpu_features();
+    if (features & CPU_AVX2)
+        return avx2[mode];
+    if (features & CPU_SSE2)
+        return sse2[mode];
+#endif
+    return scalar[mode];
+}
+
+const MaskKernel mask_kernels[BLEND_MULTIPLY + 1] = {
+    select_mask_kernel(BLEND_NONE),
+    select_mask_kernel(BLEND_SRC_OVER),
+    select_mask_kernel(BLEND_ADD),
+    select_mask_kernel(BLEND_MULTIPLY),
+};
+#pragma endregion Coverage Kernels
+
+void fill_span(Pixmap *pixmap, int32_t x0, int32_t x1, int32_t y, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_RECT);
+    if (x0 > x1)
+    {
+        int32_t temp = x0;
+        x0 = x1;
+        x1 = temp;
+    }
+
+    const Rect *clip = &pixmap->clip;
+    if (y < clip->y0 || y >= clip->y1)
+        return;
+    if (x0 < clip->x0)
+        x0 = clip->x0;
+    if (x1 > clip->x1)
+        x1 = clip->x1;
+    if (x0 >= x1)
+        return;
+
+    span_store(pixmap, x0, x1, y, color);
+}
+
+void fill_rect(Pixmap *pixmap, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_RECT);
+    if (width <= 0 || height <= 0)
+        return;
+
+    // 64-bit ends so that huge rectangles cannot overflow
+    const Rect *clip = &pixmap->clip;
+    int64_t x0 = x < clip->x0 ? clip->x0 : x;
+    int64_t y0 = y < clip->y0 ? clip->y0 : y;
+    int64_t x1 = (int64_t)x + width;
+    int64_t y1 = (int64_t)y + height;
+    if (x1 > clip->x1)
+        x1 = clip->x1;
+    if (y1 > clip->y1)
+        y1 = clip->y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int32_t row = (int32_t)y0; row < (int32_t)y1; row++)
+        span_store(pixmap, (int32_t)x0, (int32_t)x1, row, color);
+}
@@ -0,0 +1,312 @@
+/**
+ * @file stats.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <stats.h>
+
+#include "probe.h"
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const primitive_names[STAT_PRIMITIVE_COUNT] = {
+    "clear", "point", "line", "circle", "disc", "rect", "polygon", "triangle", "fill", "text",
+};
+
+bool stats_enabled(void)
+{
+    return RENDERER_STATS != 0;
+}
+
+const char *stats_primitive_name(StatPrimitive primitive)
+{
+    return (unsigned)primitive < STAT_PRIMITIVE_COUNT ? primitive_names[primitive] : "unknown";
+}
+
+#if RENDERER_STATS
+    #include <atomic>
+    #include <chrono>
+    #include <mutex>
+    #include <vector>
+
+enum
+{
+    STATS_MAX_EVENTS = 1 << 20, // Trace events kept before further ones are dropped
+    STATS_COUNTERS = 5,         // Fields of PrimitiveStats
+};
+
+/**
+ * @brief A complete trace event, times in nanoseconds since `stats_epoch`
+ *
+ */
+typedef struct TraceEvent
+{
+    const char *name;
+    uint64_t begin;
+    uint64_t duration;
+    uint32_t thread;
+} TraceEvent;
+
+/**
+ * @brief Per-pixel write counts of the watched pixmap
+ *
+ */
+typedef struct Heatmap
+{
+    const uint32_t *pixels; // Storage of the watched pixmap, shared by copies of its Pixmap
+    int32_t width, height;
+    uint16_t *counts; // width * height counts, saturating
+} Heatmap;
+
+static const std::chrono::steady_clock::time_point stats_epoch = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> totals[STAT_PRIMITIVE_COUNT][STATS_COUNTERS];
+static std::atomic<uint64_t> dropped;
+static std::atomic<uint32_t> next_thread;
+static std::mutex events_mutex;
+static std::vector<TraceEvent> events;
+static Heatmap heatmap;
+
+/**
+ * @brief The primitive a thread is currently inside and what it did so far
+ *
+ */
+typedef struct ProbeState
+{
+    uint32_t depth;
+    uint32_t parts; // Nesting of PROBE_PART scopes
+    StatPrimitive primitive;
+    PrimitiveStats local;
+    uint64_t begin;
+    uint32_t thread;
+} ProbeState;
+
+static thread_local ProbeState probe = {0, 0, STAT_CLEAR, {}, 0, next_thread++};
+
+uint64_t probe_now(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stats_epoch).count();
+}
+
+void probe_event(const char *name, uint64_t begin)
+{
+    uint64_t end = probe_now();
+    std::lock_guard<std::mutex> lock(events_mutex);
+    if (events.size() >= STATS_MAX_EVENTS)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    events.push_back(TraceEvent{name, begin, end - begin, probe.thread});
+}
+
+void probe_enter(StatPrimitive primitive)
+{
+    if (probe.depth++ > 0)
+        return;
+    probe.primitive = primitive;
+    probe.local = PrimitiveStats{};
+    probe.begin = probe_now();
+}
+
+void probe_leave(void)
+{
+    if (--probe.depth > 0)
+        return;
+
+    uint64_t end = probe_now();
+    const PrimitiveStats *local = &probe.local;
+    std::atomic<uint64_t> *counters = totals[probe.primitive];
+    counters[1].fetch_add(local->written, std::memory_order_relaxed);
+    counters[2].fetch_add(local->rejected, std::memory_order_relaxed);
+    counters[3].fetch_add(local->overdrawn, std::memory_order_relaxed);
+    counters[4].fetch_add(end - probe.begin, std::memory_order_relaxed);
+    if (probe.parts > 0)
+        return;
+    counters[0].fetch_add(1, std::memory_order_relaxed);
+    probe_event(primitive_names[probe.primitive], probe.begin);
+}
+
+void probe_part_enter(void)
+{
+    probe.parts++;
+}
+
+void probe_part_leave(void)
+{
+    probe.parts--;
+}
+
+void probe_calls(StatPrimitive primitive, uint64_t calls)
+{
+    totals[primitive][0].fetch_add(calls, std::memory_order_relaxed);
+}
+
+void probe_write(const Pixmap *pixmap, int32_t x, int32_t y, size_t count)
+{
+    probe.local.written += count;
+    if (pixmap->pixels != heatmap.pixels)
+        return;
+
+    // Tiles of a parallel replay write disjoint pixels, so the counts need no synchronization
+    uint16_t *counts = heatmap.counts + (size_t)y * (size_t)heatmap.width + (size_t)x;
+    for (size_t i = 0; i < count; i++)
+    {
+        probe.local.overdrawn += counts[i] > 0;
+        counts[i] += counts[i] < UINT16_MAX;
+    }
+}
+
+void probe_reject(size_t count)
+{
+    probe.local.rejected += count;
+}
+
+void probe_clear(const Pixmap *pixmap, const Rect *area)
+{
+    // Clears may include the row padding, which is neither counted nor has counts
+    Rect all = {0, 0, pixmap->width, pixmap->height};
+    if (area == NULL)
+        area = &all;
+    int32_t x1 = area->x1 < pixmap->width ? area->x1 : pixmap->width;
+    if (area->x0 >= x1)
+        return;
+    probe.local.written += (uint64_t)(x1 - area->x0) * (uint64_t)(area->y1 - area->y0);
+    if (pixmap->pixels != heatmap.pixels)
+        return;
+
+    for (int32_t y = area->y0; y < area->y1; y++)
+        memset(heatmap.counts + (size_t)y * (size_t)heatmap.width + (size_t)area->x0, 0,
+               (size_t)(x1 - area->x0) * sizeof(uint16_t));
+}
+
+void stats_reset(void)
+{
+    for (size_t i = 0; i < STAT_PRIMITIVE_COUNT; i++)
+        for (size_t j = 0; j < STATS_COUNTERS; j++)
+            totals[i][j].store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(events_mutex);
+    events.clear();
+}
+
+void stats_snapshot(RenderStats *stats)
+{
+    for (size_t i = 0; i < STAT_PRIMITIVE_COUNT; i++)
+    {
+        PrimitiveStats *out = &stats->primitives[i];
+        out->calls = totals[i][0].load(std::memory_order_relaxed);
+        out->written = totals[i][1].load(std::memory_order_relaxed);
+        out->rejected = totals[i][2].load(std::memory_order_relaxed);
+        out->overdrawn = totals[i][3].load(std::memory_order_relaxed);
+        out->time_ns = totals[i][4].load(std::memory_order_relaxed);
+    }
+    stats->dropped = dropped.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(events_mutex);
+    stats->events = events.size();
+}
+
+bool stats_export_trace(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+
+    RenderStats stats;
+    stats_snapshot(&stats);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const TraceEvent *event = &events[i];
+            const char *category = "rasterize";
+            if (strcmp(event->name, "clear") == 0 || strcmp(event->name, "export") == 0 || strcmp(event->name, "replay") == 0)
+                category = event->name;
+            // Timestamps are in microseconds
+            fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u},\n",
+                    event->name, category, (double)event->begin / 1e3, (double)event->duration / 1e3, event->thread);
+        }
+    }
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Renderer\"}}\n],\n");
+
+    fprintf(file, "\"otherData\":{\"dropped_events\":%llu", (unsigned long long)stats.dropped);
+    for (size_t i = 0; i < STAT_PRIMITIVE_COUNT; i++)
+    {
+        const PrimitiveStats *p = &stats.primitives[i];
+        fprintf(file, ",\"%s\":{\"calls\":%llu,\"written\":%llu,\"rejected\":%llu,\"overdrawn\":%llu,\"time_ns\":%llu}",
+                primitive_names[i], (unsigned long long)p->calls, (unsigned long long)p->written,
+                (unsigned long long)p->rejected, (unsigned long long)p->overdrawn, (unsigned long long)p->time_ns);
+    }
+    fprintf(file, "}}\n");
+    return fclose(file) == 0;
+}
+
+bool stats_heatmap_attach(const Pixmap *pixmap)
+{
+    free(heatmap.counts);
+    heatmap = Heatmap{};
+    if (pixmap == NULL)
+        return true;
+
+    heatmap.counts = (uint16_t *)calloc((size_t)pixmap->width * (size_t)pixmap->height, sizeof(uint16_t));
+    if (heatmap.counts == NULL)
+        return false;
+    heatmap.pixels = pixmap->pixels;
+    heatmap.width = pixmap->width;
+    heatmap.height = pixmap->height;
+    return true;
+}
+
+bool stats_heatmap_render(Pixmap *target)
+{
+    if (heatmap.counts == NULL || target->width != heatmap.width || target->height != heatmap.height)
+        return false;
+
+    // Black for pixels never written, then from blue over green and yellow to red for 8 writes and more
+    static const uint32_t ramp[9] = {0x000000FF, 0x0000FFFF, 0x0080FFFF, 0x00FFFFFF, 0x00FF00FF,
+                                     0x80FF00FF, 0xFFFF00FF, 0xFF8000FF, 0xFF0000FF};
+    for (int32_t y = 0; y < heatmap.height; y++)
+    {
+        const uint16_t *counts = heatmap.counts + (size_t)y * (size_t)heatmap.width;
+        dirty_mark(target, 0, heatmap.width, y);
+        for (int32_t x = 0; x < heatmap.width; x++)
+            *pixmap_pixel(target, x, y) = ramp[counts[x] < 8 ? counts[x] : 8];
+    }
+    return true;
+}
+#else
+void stats_reset(void)
+{
+}
+
+void stats_snapshot(RenderStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+bool stats_export_trace(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+bool stats_heatmap_attach(const Pixmap *pixmap)
+{
+    (void)pixmap;
+    return false;
+}
+
+bool stats_heatmap_render(Pixmap *target)
+{
+    (void)target;
+    return false;
+}
+#endif
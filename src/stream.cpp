@@ -0,0 +1,318 @@
+/**
+ * @file stream.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <export.h>
+#include <stream.h>
+
+#include "probe.h"
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+    #include <io.h>
+    #define write_fd _write
+    #define open_fd _open
+    #define close_fd _close
+    #define OPEN_FLAGS (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+    #define OPEN_MODE (_S_IREAD | _S_IWRITE)
+#else
+    #include <unistd.h>
+    #define write_fd write
+    #define open_fd open
+    #define close_fd close
+    #define OPEN_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+    #define OPEN_MODE 0644
+#endif
+
+struct FrameStream
+{
+    int fd;
+    bool owns_fd; // Opened by `frame_stream_open_file`, closed with the stream
+    StreamFormat format;
+    int32_t width, height, fps;
+
+    Pixmap **frames;   // All depth + 1 pixmaps
+    Pixmap **idle;     // Pixmaps free for rendering, a stack
+    size_t idle_count;
+    Pixmap **queue;    // Submitted frames waiting for the writer, a ring of `depth + 1` entries
+    size_t depth;
+    size_t head, queued;
+    uint8_t *planes;   // "FRAME\n" and the Y4M planes of one frame, used by the writer only
+
+    std::mutex mutex;
+    std::condition_variable submitted; // A frame was queued or the stream is closing
+    std::condition_variable released;  // A pixmap became idle
+    bool closing;
+    bool failed;
+    std::thread writer;
+};
+
+static const char y4m_frame[] = "FRAME\n";
+
+#pragma region Output
+/**
+ * @brief Writes all bytes to the descriptor, resuming after partial writes and interruptions
+ *
+ */
+static bool write_all(int fd, const uint8_t *data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t chunk = size < (1u << 30) ? size : (1u << 30);
+        long written = (long)write_fd(fd, data, (unsigned)chunk);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+static size_t y4m_plane_bytes(const FrameStream *stream)
+{
+    size_t chroma = (size_t)((stream->width + 1) / 2) * (size_t)((stream->height + 1) / 2);
+    return (size_t)stream->width * (size_t)stream->height + 2 * chroma;
+}
+
+/**
+ * @brief Converts a row of pixels to BT.601 studio range luma
+ *
+ */
+static void y4m_luma(uint8_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t r = src[i] >> 24, g = (src[i] >> 16) & 0xFF, b = (src[i] >> 8) & 0xFF;
+        dst[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+}
+
+/**
+ * @brief Converts two rows of pixels to one row of each chroma plane
+ *
+ * Each chroma sample takes the average color of a 2x2 block. The bias keeps
+ * the sums positive, so they can be shifted without rounding towards minus
+ * infinity.
+ */
+static void y4m_chroma(uint8_t *cb, uint8_t *cr, const uint32_t *top, const uint32_t *bottom, int32_t width)
+{
+    for (int32_t x = 0; x < width; x += 2)
+    {
+        int32_t right = x + 1 < width ? x + 1 : x;
+        uint32_t block[4] = {top[x], top[right], bottom[x], bottom[right]};
+        int32_t r = 0, g = 0, b = 0;
+        for (uint32_t pixel : block)
+        {
+            r += (int32_t)(pixel >> 24);
+            g += (int32_t)((pixel >> 16) & 0xFF);
+            b += (int32_t)((pixel >> 8) & 0xFF);
+        }
+        cb[x / 2] = (uint8_t)((112 * b - 38 * r - 74 * g + (128 << 10) + 512) >> 10);
+        cr[x / 2] = (uint8_t)((112 * r - 94 * g - 18 * b + (128 << 10) + 512) >> 10);
+    }
+}
+
+/**
+ * @brief Converts and writes one frame, on the writer thread
+ *
+ */
+static bool stream_write(FrameStream *stream, const Pixmap *frame)
+{
+    PROBE_TIMER("stream_frame");
+    if (stream->format == STREAM_RGBA)
+        return pixmap_export_fd(frame, stream->fd, IMAGE_RGBA);
+
+    int32_t width = stream->width, height = stream->height;
+    size_t chroma_width = (size_t)((width + 1) / 2);
+    size_t chroma_size = chroma_width * (size_t)((height + 1) / 2);
+    uint8_t *luma = stream->planes + sizeof(y4m_frame) - 1;
+    uint8_t *cb = luma + (size_t)width * (size_t)height;
+    uint8_t *cr = cb + chroma_size;
+    for (int32_t y = 0; y < height; y += 2)
+    {
+        const uint32_t *top = pixmap_row(frame, y);
+        const uint32_t *bottom = y + 1 < height ? pixmap_row(frame, y + 1) : top;
+        y4m_luma(luma + (size_t)y * (size_t)width, top, (size_t)width);
+        if (y + 1 < height)
+            y4m_luma(luma + (size_t)(y + 1) * (size_t)width, bottom, (size_t)width);
+        y4m_chroma(cb + (size_t)(y / 2) * chroma_width, cr + (size_t)(y / 2) * chroma_width, top, bottom, width);
+    }
+    return write_all(stream->fd, stream->planes, sizeof(y4m_frame) - 1 + y4m_plane_bytes(stream));
+}
+
+/**
+ * @brief Writes queued frames in order until the stream closes and the queue is empty
+ *
+ * Frames queued after a failed write are dropped, but still returned to the
+ * idle pixmaps so the renderer never waits forever.
+ */
+static void stream_thread(FrameStream *stream)
+{
+    if (stream->format == STREAM_Y4M)
+    {
+        char header[96];
+        int size = snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", stream->width,
+                            stream->height, stream->fps);
+        if (!write_all(stream->fd, (const uint8_t *)header, (size_t)size))
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            stream->failed = true;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    for (;;)
+    {
+        stream->submitted.wait(lock, [stream] { return stream->queued > 0 || stream->closing; });
+        if (stream->queued == 0)
+            break;
+
+        Pixmap *frame = stream->queue[stream->head];
+        stream->head = (stream->head + 1) % (stream->depth + 1);
+        stream->queued--;
+        bool skip = stream->failed;
+        lock.unlock();
+        bool ok = skip || stream_write(stream, frame);
+        lock.lock();
+
+        stream->failed |= !ok;
+        stream->idle[stream->idle_count++] = frame;
+        stream->released.notify_one();
+    }
+}
+#pragma endregion Output
+
+/**
+ * @brief Releases the pixmaps and buffers of a stream whose thread is not running
+ *
+ */
+static void stream_free(FrameStream *stream)
+{
+    if (stream->frames != NULL)
+        for (size_t i = 0; i <= stream->depth; i++)
+            pixmap_destroy(stream->frames[i]);
+    free(stream->frames);
+    free(stream->idle);
+    free(stream->queue);
+    free(stream->planes);
+    delete stream;
+}
+
+FrameStream *frame_stream_open_fd(int fd, int32_t width, int32_t height, StreamFormat format, int32_t fps, int32_t depth)
+{
+    if (fd < 0 || width <= 0 || height <= 0 || depth <= 0 || (format == STREAM_Y4M && fps <= 0))
+        return NULL;
+    if (format != STREAM_Y4M && format != STREAM_RGBA)
+        return NULL;
+
+    FrameStream *stream = new (std::nothrow) FrameStream();
+    if (stream == NULL)
+        return NULL;
+    stream->fd = fd;
+    stream->format = format;
+    stream->width = width;
+    stream->height = height;
+    stream->fps = fps;
+    stream->depth = (size_t)depth;
+
+    stream->frames = (Pixmap **)calloc(stream->depth + 1, sizeof(Pixmap *));
+    stream->idle = (Pixmap **)calloc(stream->depth + 1, sizeof(Pixmap *));
+    stream->queue = (Pixmap **)calloc(stream->depth + 1, sizeof(Pixmap *));
+    if (format == STREAM_Y4M)
+        stream->planes = (uint8_t *)malloc(sizeof(y4m_frame) - 1 + y4m_plane_bytes(stream));
+    bool ok = stream->frames != NULL && stream->idle != NULL && stream->queue != NULL &&
+              (format != STREAM_Y4M || stream->planes != NULL);
+    for (size_t i = 0; ok && i <= stream->depth; i++)
+    {
+        stream->frames[i] = pixmap_create(width, height);
+        stream->idle[stream->idle_count++] = stream->frames[i];
+        ok = stream->frames[i] != NULL;
+    }
+    if (!ok)
+    {
+        stream_free(stream);
+        return NULL;
+    }
+    if (format == STREAM_Y4M)
+        memcpy(stream->planes, y4m_frame, sizeof(y4m_frame) - 1);
+
+    try
+    {
+        stream->writer = std::thread(stream_thread, stream);
+    }
+    catch (...)
+    {
+        stream_free(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+FrameStream *frame_stream_open_file(const char *path, int32_t width, int32_t height, StreamFormat format, int32_t fps,
+                                    int32_t depth)
+{
+    int fd = open_fd(path, OPEN_FLAGS, OPEN_MODE);
+    if (fd < 0)
+        return NULL;
+
+    FrameStream *stream = frame_stream_open_fd(fd, width, height, format, fps, depth);
+    if (stream == NULL)
+    {
+        close_fd(fd);
+        return NULL;
+    }
+    stream->owns_fd = true;
+    return stream;
+}
+
+Pixmap *frame_stream_begin(FrameStream *stream)
+{
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    stream->released.wait(lock, [stream] { return stream->idle_count > 0; });
+    return stream->idle[--stream->idle_count];
+}
+
+bool frame_stream_submit(FrameStream *stream, Pixmap *frame)
+{
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    // Until the writer wakes up, all depth + 1 pixmaps may be queued at once, the ring has a slot for each
+    stream->queue[(stream->head + stream->queued) % (stream->depth + 1)] = frame;
+    stream->queued++;
+    stream->submitted.notify_one();
+    return !stream->failed;
+}
+
+bool frame_stream_close(FrameStream *stream)
+{
+    if (stream == NULL)
+        return true;
+
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->closing = true;
+        stream->submitted.notify_one();
+    }
+    stream->writer.join();
+
+    bool ok = !stream->failed;
+    if (stream->owns_fd && close_fd(stream->fd) != 0)
+        ok = false;
+    stream_free(stream);
+    return ok;
+}
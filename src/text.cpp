@@ -0,0 +1,843 @@
+/**
+ * @file text.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @version 0.1
+ * @date 2026-10-16
+ */
+
+#include <text.h>
+
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mutex>
+#include <new>
+
+/**
+ * @brief Limits of the fonts, the glyph cache and the text composition
+ *
+ */
+enum
+{
+    FONT_GLYPHS = 256,          // Code points with glyphs, ASCII and Latin-1
+    FONT_MAX_SIZE = 1024,       // Largest line height text can be drawn at
+    FONT_CACHE_ENTRIES = 1024,  // Resampled glyphs kept at most
+    FONT_CACHE_BITS = 11,       // Hash buckets of the cache as a power of two
+    FONT_CACHE_BYTES = 1 << 20, // Coverage bytes of resampled glyphs kept at most
+    TEXT_BAND_BYTES = 1 << 14,  // Coverage composed at once on the stack
+    TEXT_BAND_ROWS = 64,        // Rows composed at once
+};
+
+/**
+ * @brief Layout of the built-in font
+ *
+ */
+enum
+{
+    BUILTIN_FIRST = 32,  // First code point, the space
+    BUILTIN_COUNT = 95,  // Glyphs up to '~'
+    BUILTIN_WIDTH = 5,   // Bitmap width, bit 4 of a row is the leftmost pixel
+    BUILTIN_ROWS = 9,    // Bitmap height, 7 rows down to the baseline and 2 for descenders
+    BUILTIN_TOP = 1,     // Offset of the bitmap from the top of the line
+    BUILTIN_ADVANCE = 6, // Distance between two characters
+    BUILTIN_HEIGHT = 10, // Line height
+};
+
+/**
+ * @brief A glyph bitmap and where it goes relative to the pen
+ *
+ * The pen sits at the left edge of the character on the top of the line.
+ */
+typedef struct Glyph
+{
+    int32_t x, y;            // Offset of the bitmap from the pen, y pointing down
+    int32_t width, height;   // Size of the bitmap, may be 0 for blanks
+    int32_t advance;         // Distance to the pen of the next character
+    const uint8_t *coverage; // width * height bytes, row by row
+} Glyph;
+
+/**
+ * @brief A resampled glyph in the cache
+ *
+ * Entries are chained into hash buckets and into a list from the most to the
+ * least recently used one, both by index.
+ */
+typedef struct CacheEntry
+{
+    uint32_t key;     // Code point | size << 8
+    int32_t next;     // Next entry of the same bucket or the next unused one, -1 at the end
+    int32_t newer;    // Entry used next more recently, -1 for the newest
+    int32_t older;    // Entry used next less recently, -1 for the oldest
+    Glyph glyph;
+    uint8_t *storage; // Owned coverage of the glyph
+} CacheEntry;
+
+struct Font
+{
+    int32_t height;  // Line height at the native size
+    uint8_t missing; // Code point drawn for those without a glyph
+    bool present[FONT_GLYPHS];
+    Glyph glyphs[FONT_GLYPHS]; // Native glyphs, their coverage points into the atlas
+    uint8_t *atlas;            // Coverage of every native glyph, one after another
+
+    int32_t metrics_size;       // Line height `metrics` were computed for, 0 if none
+    Glyph metrics[FONT_GLYPHS]; // Boxes and advances of every glyph at `metrics_size`, without coverage
+
+    std::mutex mutex; // Guards the cache
+    CacheEntry entries[FONT_CACHE_ENTRIES];
+    int32_t buckets[1 << FONT_CACHE_BITS]; // First entry of every bucket, -1 if empty
+    int32_t unused;                      // First unused entry, chained through `next`
+    int32_t newest, oldest;
+    size_t bytes; // Coverage held by the cache
+};
+
+/**
+ * @brief The built-in font, 9 rows of 5 pixels per glyph from ' ' to '~'
+ *
+ */
+static const uint8_t builtin_glyphs[BUILTIN_COUNT][BUILTIN_ROWS] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00}, // '!'
+    {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00, 0x00}, // '#'
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04, 0x00, 0x00}, // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00}, // '%'
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D, 0x00, 0x00}, // '&'
+    {0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '\''
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00}, // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00}, // ')'
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, 0x00, 0x00}, // '*'
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08, 0x00, 0x00}, // ','
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00}, // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00}, // '/'
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, 0x00, 0x00}, // '0'
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // '1'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00}, // '2'
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x00, 0x00}, // '3'
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, 0x00, 0x00}, // '4'
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, 0x00, 0x00}, // '5'
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, 0x00, 0x00}, // '6'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00}, // '7'
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00, 0x00}, // '8'
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, 0x00, 0x00}, // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00}, // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08, 0x00, 0x00}, // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00}, // '<'
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00}, // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00}, // '>'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00}, // '?'
+    {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E, 0x00, 0x00}, // '@'
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'A'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, 0x00, 0x00}, // 'B'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, 0x00, 0x00}, // 'C'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, 0x00, 0x00}, // 'D'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, 0x00, 0x00}, // 'E'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'F'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, 0x00, 0x00}, // 'G'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'H'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, 0x00, 0x00}, // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00}, // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, 0x00, 0x00}, // 'L'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00}, // 'N'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'O'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'P'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, 0x00, 0x00}, // 'Q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, 0x00, 0x00}, // 'R'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, 0x00, 0x00}, // 'S'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00}, // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00}, // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00, 0x00}, // 'W'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00, 0x00}, // 'X'
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x00, 0x00}, // 'Y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, 0x00, 0x00}, // 'Z'
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E, 0x00, 0x00}, // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00}, // '\\'
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E, 0x00, 0x00}, // ']'
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00}, // '_'
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00, 0x00}, // 'a'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E, 0x00, 0x00}, // 'b'
+    {0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x00, 0x00}, // 'c'
+    {0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F, 0x00, 0x00}, // 'd'
+    {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00, 0x00}, // 'e'
+    {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08, 0x00, 0x00}, // 'f'
+    {0x00, 0x00, 0x0F, 0x11, 0x11, 0x13, 0x0D, 0x01, 0x0E}, // 'g'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'h'
+    {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'i'
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'j'
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00}, // 'k'
+    {0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'l'
+    {0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11, 0x00, 0x00}, // 'm'
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'n'
+    {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'o'
+    {0x00, 0x00, 0x1E, 0x11, 0x11, 0x19, 0x16, 0x10, 0x10}, // 'p'
+    {0x00, 0x00, 0x0F, 0x11, 0x11, 0x13, 0x0D, 0x01, 0x01}, // 'q'
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'r'
+    {0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E, 0x00, 0x00}, // 's'
+    {0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00}, // 't'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00, 0x00}, // 'u'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00}, // 'v'
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00, 0x00}, // 'w'
+    {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00, 0x00}, // 'x'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x01, 0x0E}, // 'y'
+    {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00}, // 'z'
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00}, // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00}, // '|'
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00}, // '}'
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00}, // '~'
+};
+
+#pragma region Font
+/**
+ * @brief Creates an empty font with an empty cache
+ *
+ */
+static Font *font_alloc(int32_t height)
+{
+    Font *font = new (std::nothrow) Font();
+    if (font == NULL)
+        return NULL;
+    font->height = height;
+    font->missing = '?';
+    font->newest = font->oldest = -1;
+    for (int32_t i = 0; i < (1 << FONT_CACHE_BITS); i++)
+        font->buckets[i] = -1;
+    for (int32_t i = 0; i < FONT_CACHE_ENTRIES; i++)
+        font->entries[i].next = i + 1 < FONT_CACHE_ENTRIES ? i + 1 : -1;
+    return font;
+}
+
+/**
+ * @brief Bakes the atlas from glyphs whose coverage points into temporary storage
+ *
+ * @return false if the atlas could not be allocated
+ */
+static bool font_bake(Font *font)
+{
+    size_t size = 0;
+    for (int32_t i = 0; i < FONT_GLYPHS; i++)
+        size += (size_t)font->glyphs[i].width * (size_t)font->glyphs[i].height;
+
+    font->atlas = (uint8_t *)malloc(size > 0 ? size : 1);
+    if (font->atlas == NULL)
+        return false;
+
+    size_t offset = 0;
+    for (int32_t i = 0; i < FONT_GLYPHS; i++)
+    {
+        Glyph *glyph = &font->glyphs[i];
+        size_t bytes = (size_t)glyph->width * (size_t)glyph->height;
+        if (bytes > 0)
+            memcpy(font->atlas + offset, glyph->coverage, bytes);
+        glyph->coverage = font->atlas + offset;
+        offset += bytes;
+    }
+    if (!font->present[font->missing])
+        for (int32_t i = 0; i < FONT_GLYPHS; i++)
+            if (font->present[i])
+            {
+                font->missing = (uint8_t)i;
+                break;
+            }
+    return true;
+}
+
+Font *font_create(void)
+{
+    Font *font = font_alloc(BUILTIN_HEIGHT);
+    if (font == NULL)
+        return NULL;
+
+    // Expand the bits into coverage, the glyphs point into it until the atlas is baked
+    static uint8_t coverage[BUILTIN_COUNT][BUILTIN_ROWS * BUILTIN_WIDTH];
+    for (int32_t i = 0; i < BUILTIN_COUNT; i++)
+    {
+        for (int32_t row = 0; row < BUILTIN_ROWS; row++)
+            for (int32_t column = 0; column < BUILTIN_WIDTH; column++)
+                coverage[i][row * BUILTIN_WIDTH + column] = (builtin_glyphs[i][row] >> (BUILTIN_WIDTH - 1 - column)) & 1 ? 255 : 0;
+
+        font->present[BUILTIN_FIRST + i] = true;
+        font->glyphs[BUILTIN_FIRST + i] = Glyph{0, BUILTIN_TOP, BUILTIN_WIDTH, BUILTIN_ROWS, BUILTIN_ADVANCE, coverage[i]};
+    }
+
+    if (!font_bake(font))
+    {
+        delete font;
+        return NULL;
+    }
+    return font;
+}
+
+/**
+ * @brief Glyph being read from a BDF file
+ *
+ */
+typedef struct BdfGlyph
+{
+    int32_t encoding;
+    int32_t advance;
+    int32_t width, height, x, y; // BBX, y is the offset of the bottom row above the baseline
+} BdfGlyph;
+
+/**
+ * @brief Reads a hexadecimal BITMAP row into coverage
+ *
+ * @return false if the row has too few digits
+ */
+static bool bdf_row(const char *line, uint8_t *coverage, int32_t width)
+{
+    for (int32_t x = 0; x < width; x += 4)
+    {
+        char c = line[x / 4];
+        int32_t nibble;
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'A' && c <= 'F')
+            nibble = c - 'A' + 10;
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else
+            return false;
+        for (int32_t bit = 0; bit < 4 && x + bit < width; bit++)
+            coverage[x + bit] = (nibble >> (3 - bit)) & 1 ? 255 : 0;
+    }
+    return true;
+}
+
+Font *font_load_bdf(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return NULL;
+
+    Font *font = font_alloc(0);
+    uint8_t *storage[FONT_GLYPHS] = {};
+    int32_t ascent = 0, descent = 0, box_height = 0, box_y = 0, missing = -1;
+    bool valid = font != NULL, started = false;
+    char line[1024];
+    BdfGlyph glyph = {};
+    while (valid && fgets(line, sizeof(line), file) != NULL)
+    {
+        int32_t a, b, c, d;
+        if (!started && sscanf(line, "STARTFONT %d", &a) == 1)
+            started = true;
+        else if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &a, &b, &c, &d) == 4)
+            box_height = b, box_y = d;
+        else if (sscanf(line, "FONT_ASCENT %d", &a) == 1)
+            ascent = a;
+        else if (sscanf(line, "FONT_DESCENT %d", &a) == 1)
+            descent = a;
+        else if (sscanf(line, "DEFAULT_CHAR %d", &a) == 1)
+            missing = a;
+        else if (strncmp(line, "STARTCHAR", 9) == 0)
+            glyph = BdfGlyph{-1, 0, 0, 0, 0, 0};
+        else if (sscanf(line, "ENCODING %d", &a) == 1)
+            glyph.encoding = a;
+        else if (sscanf(line, "DWIDTH %d", &a) == 1)
+            glyph.advance = a;
+        else if (sscanf(line, "BBX %d %d %d %d", &a, &b, &c, &d) == 4)
+            glyph.width = a, glyph.height = b, glyph.x = c, glyph.y = d;
+        else if (strncmp(line, "BITMAP", 6) == 0)
+        {
+            if (ascent == 0 && descent == 0)
+                ascent = box_height + box_y, descent = -box_y;
+            // Boxes are bounded like the line height, so that scaling them cannot overflow
+            bool keep = glyph.encoding >= 0 && glyph.encoding < FONT_GLYPHS && glyph.width >= 0 && glyph.height >= 0 &&
+                        glyph.width <= FONT_MAX_SIZE && glyph.height <= FONT_MAX_SIZE && glyph.x >= -FONT_MAX_SIZE &&
+                        glyph.x <= FONT_MAX_SIZE && glyph.y >= -FONT_MAX_SIZE && glyph.y <= FONT_MAX_SIZE;
+            uint8_t *coverage = NULL;
+            if (keep)
+            {
+                free(storage[glyph.encoding]);
+                coverage = (uint8_t *)calloc((size_t)glyph.width * (size_t)glyph.height + 1, 1);
+                storage[glyph.encoding] = coverage;
+                valid = coverage != NULL;
+            }
+            for (int32_t row = 0; valid && row < glyph.height; row++)
+                valid = fgets(line, sizeof(line), file) != NULL && (!keep || bdf_row(line, coverage + (size_t)row * (size_t)glyph.width, glyph.width));
+            if (valid && keep)
+            {
+                font->present[glyph.encoding] = true;
+                font->glyphs[glyph.encoding] = Glyph{glyph.x, ascent - glyph.y - glyph.height, glyph.width, glyph.height, glyph.advance, coverage};
+            }
+        }
+    }
+    fclose(file);
+
+    if (valid)
+    {
+        font->height = ascent + descent;
+        if (missing >= 0 && missing < FONT_GLYPHS && font->present[missing])
+            font->missing = (uint8_t)missing;
+        valid = started && font->height > 0 && font->height <= FONT_MAX_SIZE && font_bake(font);
+    }
+    for (int32_t i = 0; i < FONT_GLYPHS; i++)
+        free(storage[i]);
+    if (!valid)
+    {
+        font_destroy(font);
+        return NULL;
+    }
+    return font;
+}
+
+void font_destroy(Font *font)
+{
+    if (font == NULL)
+        return;
+    for (int32_t i = 0; i < FONT_CACHE_ENTRIES; i++)
+        free(font->entries[i].storage);
+    free(font->atlas);
+    delete font;
+}
+
+int32_t font_height(const Font *font)
+{
+    return font->height;
+}
+#pragma endregion Font
+
+#pragma region Glyph Cache
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * @brief Returns the index of the glyph drawn for a code point
+ *
+ */
+static inline uint32_t font_index(const Font *font, uint32_t code)
+{
+    return code < FONT_GLYPHS && font->present[code] ? code : font->missing;
+}
+
+/**
+ * @brief Returns the glyph of a code point, or the default glyph
+ *
+ */
+static const Glyph *font_glyph(const Font *font, uint32_t code)
+{
+    return &font->glyphs[font_index(font, code)];
+}
+
+/**
+ * @brief Computes the bitmap box and advance of a glyph at another line height
+ *
+ * The bitmap covers every pixel the scaled native bitmap touches. The coverage
+ * pointer is left NULL.
+ */
+static Glyph glyph_scale(const Font *font, const Glyph *glyph, int32_t size)
+{
+    int64_t h = font->height;
+    Glyph scaled = {};
+    int64_t x0 = floor_div((int64_t)glyph->x * size, h);
+    int64_t y0 = floor_div((int64_t)glyph->y * size, h);
+    int64_t x1 = -floor_div(-((int64_t)glyph->x + glyph->width) * size, h);
+    int64_t y1 = -floor_div(-((int64_t)glyph->y + glyph->height) * size, h);
+    scaled.x = (int32_t)x0;
+    scaled.y = (int32_t)y0;
+    scaled.width = glyph->width > 0 && glyph->height > 0 ? (int32_t)(x1 - x0) : 0;
+    scaled.height = scaled.width > 0 ? (int32_t)(y1 - y0) : 0;
+    scaled.advance = (int32_t)floor_div((int64_t)glyph->advance * size * 2 + h, 2 * h);
+    return scaled;
+}
+
+/**
+ * @brief Overlap of native pixel `i` and scaled pixel `t` along one axis, in 1 / (size * height) pixels
+ *
+ * Native pixel i covers [i * size, (i + 1) * size) and scaled pixel t covers
+ * [t * height, (t + 1) * height) in these units.
+ */
+static inline int64_t glyph_overlap(int64_t i, int64_t t, int64_t size, int64_t height)
+{
+    int64_t lo = i * size > t * height ? i * size : t * height;
+    int64_t hi = (i + 1) * size < (t + 1) * height ? (i + 1) * size : (t + 1) * height;
+    return hi > lo ? hi - lo : 0;
+}
+
+/**
+ * @brief Range of native pixels overlapping scaled pixel `t`, relative to the bitmap start `origin`
+ *
+ */
+static inline void glyph_sources(int64_t t, int64_t origin, int32_t count, int64_t size, int64_t height, int32_t *first, int32_t *last)
+{
+    int64_t lo = floor_div(t * height, size) - origin;
+    int64_t hi = floor_div((t + 1) * height - 1, size) - origin;
+    *first = (int32_t)(lo > 0 ? lo : 0);
+    *last = (int32_t)(hi < count - 1 ? hi : count - 1);
+}
+
+/**
+ * @brief Coverage of one pixel of a scaled glyph, the box-filtered average of the native coverage
+ *
+ * @param tx Column relative to the pen
+ * @param ty Row relative to the pen
+ */
+static uint8_t glyph_sample(const Font *font, const Glyph *glyph, int32_t size, int64_t tx, int64_t ty)
+{
+    int64_t h = font->height;
+    int32_t i0, i1, j0, j1;
+    glyph_sources(tx, glyph->x, glyph->width, size, h, &i0, &i1);
+    glyph_sources(ty, glyph->y, glyph->height, size, h, &j0, &j1);
+    int64_t sum = 0;
+    for (int32_t j = j0; j <= j1; j++)
+    {
+        int64_t wy = glyph_overlap(glyph->y + j, ty, size, h);
+        const uint8_t *row = glyph->coverage + (size_t)j * (size_t)glyph->width;
+        for (int32_t i = i0; i <= i1; i++)
+            sum += wy * glyph_overlap(glyph->x + i, tx, size, h) * row[i];
+    }
+    return (uint8_t)((sum + h * h / 2) / (h * h));
+}
+
+/**
+ * @brief Resamples a native glyph into `scaled->width * scaled->height` bytes
+ *
+ */
+static void glyph_resample(const Font *font, const Glyph *glyph, int32_t size, const Glyph *scaled, uint8_t *coverage)
+{
+    for (int32_t y = 0; y < scaled->height; y++)
+        for (int32_t x = 0; x < scaled->width; x++)
+            coverage[(size_t)y * (size_t)scaled->width + (size_t)x] = glyph_sample(font, glyph, size, scaled->x + x, scaled->y + y);
+}
+
+/**
+ * @brief Returns the bucket of a key, the top bits of a multiplicative hash
+ *
+ */
+static inline uint32_t cache_hash(uint32_t key)
+{
+    return (key * 0x9E3779B1u) >> (32 - FONT_CACHE_BITS);
+}
+
+static void cache_unlink(Font *font, int32_t index)
+{
+    CacheEntry *entry = &font->entries[index];
+    if (entry->newer >= 0)
+        font->entries[entry->newer].older = entry->older;
+    else
+        font->newest = entry->older;
+    if (entry->older >= 0)
+        font->entries[entry->older].newer = entry->newer;
+    else
+        font->oldest = entry->newer;
+}
+
+static void cache_push(Font *font, int32_t index)
+{
+    CacheEntry *entry = &font->entries[index];
+    entry->newer = -1;
+    entry->older = font->newest;
+    if (font->newest >= 0)
+        font->entries[font->newest].newer = index;
+    else
+        font->oldest = index;
+    font->newest = index;
+}
+
+/**
+ * @brief Removes the least recently used glyph and returns its entry to the unused ones
+ *
+ */
+static void cache_evict(Font *font)
+{
+    int32_t index = font->oldest;
+    CacheEntry *entry = &font->entries[index];
+    int32_t *link = &font->buckets[cache_hash(entry->key)];
+    while (*link != index)
+        link = &font->entries[*link].next;
+    *link = entry->next;
+
+    cache_unlink(font, index);
+    font->bytes -= (size_t)entry->glyph.width * (size_t)entry->glyph.height;
+    free(entry->storage);
+    entry->storage = NULL;
+    entry->next = font->unused;
+    font->unused = index;
+}
+
+/**
+ * @brief Computes the boxes of all glyphs at a line height unless they are already known
+ *
+ * Scaling a box takes several divisions, which would otherwise be repeated for
+ * every character. Must be called with the font locked.
+ */
+static void font_metrics(Font *font, int32_t size)
+{
+    if (font->metrics_size == size)
+        return;
+    for (int32_t i = 0; i < FONT_GLYPHS; i++)
+        if (font->present[i])
+            font->metrics[i] = glyph_scale(font, &font->glyphs[i], size);
+    font->metrics_size = size;
+}
+
+/**
+ * @brief Returns a glyph at the given line height, from the atlas, the cache or freshly resampled
+ *
+ * The glyph stays valid until the next lookup. Must be called with the font
+ * locked and its metrics computed for `size`.
+ *
+ * @return The glyph, or NULL if a resampled glyph is larger than the whole cache or could not be allocated
+ */
+static const Glyph *cache_lookup(Font *font, uint32_t code, int32_t size)
+{
+    code = font_index(font, code);
+    const Glyph *native = &font->glyphs[code];
+    if (size == font->height)
+        return native;
+
+    uint32_t key = code | (uint32_t)size << 8;
+    int32_t *bucket = &font->buckets[cache_hash(key)];
+    for (int32_t index = *bucket; index >= 0; index = font->entries[index].next)
+    {
+        CacheEntry *entry = &font->entries[index];
+        if (entry->key == key)
+        {
+            cache_unlink(font, index);
+            cache_push(font, index);
+            return &entry->glyph;
+        }
+    }
+
+    Glyph scaled = font->metrics[code];
+    // Glyphs far larger than the line height would otherwise evict everything and allocate without bound
+    if (scaled.height > 0 && scaled.width > FONT_CACHE_BYTES / scaled.height)
+        return NULL;
+    size_t bytes = (size_t)scaled.width * (size_t)scaled.height;
+    while (font->oldest >= 0 && (font->bytes + bytes > FONT_CACHE_BYTES || font->unused < 0))
+        cache_evict(font);
+
+    uint8_t *storage = (uint8_t *)malloc(bytes > 0 ? bytes : 1);
+    if (storage == NULL)
+        return NULL;
+    glyph_resample(font, native, size, &scaled, storage);
+    scaled.coverage = storage;
+
+    int32_t index = font->unused;
+    CacheEntry *entry = &font->entries[index];
+    font->unused = entry->next;
+    entry->key = key;
+    entry->glyph = scaled;
+    entry->storage = storage;
+    entry->next = *bucket;
+    *bucket = index;
+    cache_push(font, index);
+    font->bytes += bytes;
+    return &entry->glyph;
+}
+#pragma endregion Glyph Cache
+
+#pragma region Text
+/**
+ * @brief Decodes the next UTF-8 code point and advances the cursor
+ *
+ * Malformed sequences decode to U+FFFD one byte at a time.
+ */
+static uint32_t text_next(const char **cursor, const char *end)
+{
+    const uint8_t *p = (const uint8_t *)*cursor;
+    uint32_t lead = p[0];
+    int32_t length = lead < 0x80 ? 1 : lead >= 0xC2 && lead < 0xE0 ? 2 : lead >= 0xE0 && lead < 0xF0 ? 3 : lead >= 0xF0 && lead < 0xF5 ? 4 : 0;
+    if (length == 1 || length == 0 || end - *cursor < length)
+    {
+        *cursor += 1;
+        return length == 1 ? lead : 0xFFFD;
+    }
+
+    uint32_t code = lead & (0x7Fu >> length);
+    for (int32_t i = 1; i < length; i++)
+    {
+        if ((p[i] & 0xC0) != 0x80)
+        {
+            *cursor += 1;
+            return 0xFFFD;
+        }
+        code = code << 6 | (p[i] & 0x3Fu);
+    }
+    *cursor += length;
+    return code;
+}
+
+/**
+ * @brief Returns the end of the line starting at `text`
+ *
+ */
+static const char *text_line_end(const char *text)
+{
+    while (*text != '\0' && *text != '\n')
+        text++;
+    return text;
+}
+
+int32_t text_width(const Font *font, int32_t size, const char *text)
+{
+    int64_t widest = 0;
+    for (;;)
+    {
+        const char *end = text_line_end(text);
+        int64_t width = 0;
+        while (text < end)
+            width += glyph_scale(font, font_glyph(font, text_next(&text, end)), size).advance;
+        widest = width > widest ? width : widest;
+        if (*end == '\0')
+            break;
+        text = end + 1;
+    }
+    return (int32_t)(widest < INT32_MAX ? widest : INT32_MAX);
+}
+
+/**
+ * @brief Draws one line of text through a coverage band
+ *
+ * The visible part of the line is composed in strips of up to TEXT_BAND_ROWS
+ * rows: every glyph overlapping a strip is copied into the band, keeping the
+ * larger coverage where glyphs overlap, then each row of the strip is blended
+ * with one coverage kernel call over the columns the glyphs touched.
+ */
+static void text_line(Pixmap *pixmap, Font *font, int64_t x, int64_t y, int32_t size, const char *text, const char *end, uint32_t color)
+{
+    // Bounds from the metrics alone, which need no resampling
+    int64_t x0 = INT64_MAX, y0 = INT64_MAX, x1 = INT64_MIN, y1 = INT64_MIN;
+    int64_t pen = x;
+    for (const char *cursor = text; cursor < end;)
+    {
+        const Glyph *box = &font->metrics[font_index(font, text_next(&cursor, end))];
+        if (box->width > 0)
+        {
+            x0 = pen + box->x < x0 ? pen + box->x : x0;
+            x1 = pen + box->x + box->width > x1 ? pen + box->x + box->width : x1;
+            y0 = y + box->y < y0 ? y + box->y : y0;
+            y1 = y + box->y + box->height > y1 ? y + box->y + box->height : y1;
+        }
+        pen += box->advance;
+    }
+
+    const Rect *clip = &pixmap->clip;
+    x0 = x0 > clip->x0 ? x0 : clip->x0;
+    y0 = y0 > clip->y0 ? y0 : clip->y0;
+    x1 = x1 < clip->x1 ? x1 : clip->x1;
+    y1 = y1 < clip->y1 ? y1 : clip->y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    int32_t width = (int32_t)(x1 - x0);
+    int32_t rows = TEXT_BAND_BYTES / width;
+    rows = rows < 1 ? 1 : (rows > TEXT_BAND_ROWS ? TEXT_BAND_ROWS : rows);
+    uint8_t local[TEXT_BAND_BYTES];
+    uint8_t *band = width <= TEXT_BAND_BYTES ? local : (uint8_t *)malloc((size_t)width);
+    if (band == NULL)
+        return;
+
+    int32_t lo[TEXT_BAND_ROWS], hi[TEXT_BAND_ROWS]; // Columns touched per row of the strip
+    for (int32_t top = (int32_t)y0; top < y1; top += rows)
+    {
+        int32_t count = y1 - top < rows ? (int32_t)(y1 - top) : rows;
+        memset(band, 0, (size_t)width * (size_t)count);
+        for (int32_t r = 0; r < count; r++)
+            lo[r] = width, hi[r] = 0;
+
+        pen = x;
+        for (const char *cursor = text; cursor < end;)
+        {
+            uint32_t code = text_next(&cursor, end);
+            const Glyph *box = &font->metrics[font_index(font, code)];
+            int64_t gx = pen + box->x, gy = y + box->y;
+            pen += box->advance;
+            int64_t cx0 = gx > x0 ? gx : x0, cx1 = gx + box->width < x1 ? gx + box->width : x1;
+            int64_t cy0 = gy > top ? gy : top, cy1 = gy + box->height < top + count ? gy + box->height : top + count;
+            if (box->width == 0 || cx0 >= cx1 || cy0 >= cy1)
+                continue;
+
+            const Glyph *glyph = cache_lookup(font, code, size);
+            if (glyph == NULL)
+                continue;
+            for (int64_t row = cy0; row < cy1; row++)
+            {
+                const uint8_t *src = glyph->coverage + (size_t)(row - gy) * (size_t)glyph->width + (size_t)(cx0 - gx);
+                uint8_t *dst = band + (size_t)(row - top) * (size_t)width + (size_t)(cx0 - x0);
+                for (int64_t i = 0; i < cx1 - cx0; i++)
+                    dst[i] = src[i] > dst[i] ? src[i] : dst[i];
+                int32_t r = (int32_t)(row - top);
+                lo[r] = (int32_t)(cx0 - x0) < lo[r] ? (int32_t)(cx0 - x0) : lo[r];
+                hi[r] = (int32_t)(cx1 - x0) > hi[r] ? (int32_t)(cx1 - x0) : hi[r];
+            }
+        }
+
+        for (int32_t r = 0; r < count; r++)
+        {
+            if (lo[r] >= hi[r])
+                continue;
+            int32_t left = (int32_t)x0 + lo[r];
+            mask_store(pixmap, left, (int32_t)x0 + hi[r], top + r, band + (size_t)r * (size_t)width + lo[r], color);
+        }
+    }
+
+    if (band != local)
+        free(band);
+}
+
+void draw_text(Pixmap *pixmap, Font *font, int32_t x, int32_t y, int32_t size, const char *text, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_TEXT);
+    if (size <= 0 || size > FONT_MAX_SIZE)
+        return;
+    color = color_premultiply(color);
+    if (color == 0) // Transparent black leaves every mode unchanged
+        return;
+
+    std::lock_guard<std::mutex> lock(font->mutex);
+    font_metrics(font, size);
+    for (int64_t top = y;; top += size)
+    {
+        const char *end = text_line_end(text);
+        text_line(pixmap, font, x, top, size, text, end, color);
+        if (*end == '\0')
+            break;
+        text = end + 1;
+    }
+}
+
+void draw_text_naive(Pixmap *pixmap, const Font *font, int32_t x, int32_t y, int32_t size, const char *text, uint32_t color)
+{
+    PROBE_PRIMITIVE(STAT_TEXT);
+    if (size <= 0 || size > FONT_MAX_SIZE)
+        return;
+
+    const Rect *clip = &pixmap->clip;
+    for (int64_t top = y;; top += size)
+    {
+        const char *end = text_line_end(text);
+        int64_t pen = x;
+        while (text < end)
+        {
+            const Glyph *glyph = font_glyph(font, text_next(&text, end));
+            Glyph box = glyph_scale(font, glyph, size);
+            for (int64_t row = 0; row < box.height; row++)
+                for (int64_t column = 0; column < box.width; column++)
+                {
+                    int64_t px = pen + box.x + column, py = top + box.y + row;
+                    if (px < clip->x0 || px >= clip->x1 || py < clip->y0 || py >= clip->y1)
+                        continue;
+                    uint8_t coverage = glyph_sample(font, glyph, size, box.x + column, box.y + row);
+                    if (coverage > 0)
+                        pixel_blend(pixmap, (int32_t)px, (int32_t)py, color, coverage);
+                }
+            pen += box.advance;
+        }
+        if (*end == '\0')
+            break;
+        text = end + 1;
+    }
+}
+#pragma endregion Text
@@ -2,7 +2,12 @@
 
 int main(void)
 {
-    pixmap_clear(WHITE);
-    fill_circle(200, 200, 100, BLUE);
-    pixmap_export();
-}
+    Pixmap *pixmap = pixmap_create(WIDTH, HEIGHT);
+    if (pixmap == NULL)
+        return 1;
+
+    pixmap_clear(pixmap, WHITE);
+    fill_circle(pixmap, 200, 200, 100, BLUE);
+    pixmap_export(pixmap);
+    pixmap_destroy(pixmap);
+}
\ No newline at end of file
@@ -0,0 +1,704 @@
+/**
+ * @file tests.cpp
+ * @author Radu-D. Chira (github.com/RaduCh04)
+ * @brief Checks that equivalent ways of drawing produce the same results
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * Usage: RendererTests
+ *
+ * Each check compares ways of drawing that must agree, such as a serial and a
+ * parallel replay of one command list. The inputs come from fixed seeds, so
+ * every run checks the same cases. Prints each failed check and exits with 1
+ * if there was any.
+ */
+
+#include <renderer.h>
+
+#include <stdio.h>
+
+/**
+ * @brief Number of randomized cases of each check
+ *
+ */
+enum
+{
+    TEST_REPLAY_CASES = 40,
+    TEST_AA_CASES = 40,
+    TEST_SHARED_CASES = 10,
+    TEST_SHARED_REPLAYS = 8, // Concurrent replays of one list
+    TEST_STREAM_FRAMES = 2000,
+};
+
+static const PixmapLayout layouts[] = {LAYOUT_LINEAR, LAYOUT_TILED8, LAYOUT_TILED16, LAYOUT_MORTON8, LAYOUT_MORTON16};
+static const char *const layout_names[] = {"linear", "tiled8", "tiled16", "morton8", "morton16"};
+
+static int failures = 0;
+
+/**
+ * @brief Deterministic pseudo-random numbers, the same on every platform
+ *
+ */
+static uint32_t random_next(uint64_t *state)
+{
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+    return (uint32_t)(*state >> 33);
+}
+
+/**
+ * @brief Returns a number in [lo, hi)
+ *
+ */
+static int32_t random_range(uint64_t *state, int32_t lo, int32_t hi)
+{
+    return lo + (int32_t)(random_next(state) % (uint32_t)(hi - lo));
+}
+
+/**
+ * @brief Returns a color that is opaque three times out of four
+ *
+ */
+static uint32_t random_color(uint64_t *state)
+{
+    uint32_t color = random_next(state);
+    return random_next(state) % 4 != 0 ? color | 0xFFu : color;
+}
+
+/**
+ * @brief Reports a failed check
+ *
+ */
+static void fail(const char *check, int test_case, const char *detail)
+{
+    fprintf(stderr, "FAIL %s case %d: %s\n", check, test_case, detail);
+    failures++;
+}
+
+/**
+ * @brief Returns the number of pixels that differ between two pixmaps of the same size
+ *
+ */
+static size_t pixmap_diff(const Pixmap *a, const Pixmap *b)
+{
+    size_t differ = 0;
+    for (int32_t y = 0; y < a->height; y++)
+        for (int32_t x = 0; x < a->width; x++)
+            differ += pixmap_get_pixel(a, x, y) != pixmap_get_pixel(b, x, y);
+    return differ;
+}
+
+/**
+ * @brief A random command list together with its serial replay into a linear pixmap
+ *
+ */
+typedef struct ReplayCase
+{
+    int32_t width, height;
+    Rect clip;
+    BlendMode blend;
+    CmdList *list;
+    Pixmap *reference;
+} ReplayCase;
+
+/**
+ * @brief Records a random mix of every command type, mostly overlapping fills
+ *
+ */
+static void record_commands(CmdList *list, uint64_t *state, int32_t width, int32_t height)
+{
+    int32_t count = random_range(state, 0, 600);
+    for (int32_t i = 0; i < count; i++)
+    {
+        uint32_t color = random_color(state);
+        int32_t x = random_range(state, -100, width + 100);
+        int32_t y = random_range(state, -100, height + 100);
+        int32_t r = random_range(state, -2, 120);
+        switch (random_range(state, 0, 16))
+        {
+        case 0:
+            if (random_range(state, 0, 8) == 0)
+                cmdlist_clear(list, color);
+            break;
+        case 1:
+            cmdlist_draw_point(list, x, y, color);
+            break;
+        case 2:
+        case 3:
+            cmdlist_draw_line(list, x, y, random_range(state, -100, width + 100), random_range(state, -100, height + 100), color);
+            break;
+        case 4:
+            cmdlist_draw_circle(list, x, y, r, color);
+            break;
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+        case 9:
+            cmdlist_fill_circle(list, x, y, r / 2, color);
+            break;
+        default:
+            cmdlist_fill_rect(list, x, y, r, random_range(state, -2, 150), color);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Prepares a pixmap for a replay of the case, with its background, clip rectangle and blend mode
+ *
+ */
+static void replay_case_target(const ReplayCase *replay, Pixmap *pixmap)
+{
+    const Rect *clip = &replay->clip;
+    pixmap_clear(pixmap, 0x10203040);
+    pixmap_set_clip(pixmap, clip->x0, clip->y0, clip->x1 - clip->x0, clip->y1 - clip->y0);
+    pixmap_set_blend(pixmap, replay->blend);
+}
+
+/**
+ * @brief Creates a random case, every third one clipped
+ *
+ * @return false if the allocation failed
+ */
+static bool replay_case_create(ReplayCase *replay, uint64_t *state, int test_case)
+{
+    replay->width = random_range(state, 1, 400);
+    replay->height = random_range(state, 1, 300);
+    replay->clip = Rect{0, 0, replay->width, replay->height};
+    if (test_case % 3 == 0)
+    {
+        Rect *clip = &replay->clip;
+        clip->x0 = random_range(state, 0, replay->width);
+        clip->y0 = random_range(state, 0, replay->height);
+        clip->x1 = clip->x0 + random_range(state, 0, replay->width - clip->x0 + 1);
+        clip->y1 = clip->y0 + random_range(state, 0, replay->height - clip->y0 + 1);
+    }
+    replay->blend = (BlendMode)random_range(state, 0, 4);
+
+    replay->list = cmdlist_create();
+    replay->reference = pixmap_create(replay->width, replay->height);
+    if (replay->list == NULL || replay->reference == NULL)
+    {
+        cmdlist_destroy(replay->list);
+        pixmap_destroy(replay->reference);
+        return false;
+    }
+    record_commands(replay->list, state, replay->width, replay->height);
+    replay_case_target(replay, replay->reference);
+    cmdlist_replay(replay->list, replay->reference, NULL);
+    return true;
+}
+
+static void replay_case_destroy(ReplayCase *replay)
+{
+    cmdlist_destroy(replay->list);
+    pixmap_destroy(replay->reference);
+}
+
+/**
+ * @brief Compares a replay with the serial replay of its case and reports the difference
+ *
+ */
+static void replay_case_compare(const ReplayCase *replay, const Pixmap *pixmap, const char *check, int test_case,
+                                const char *what)
+{
+    size_t differ = pixmap_diff(replay->reference, pixmap);
+    if (differ != 0)
+    {
+        char detail[128];
+        snprintf(detail, sizeof(detail), "%s differs in %zu pixels", what, differ);
+        fail(check, test_case, detail);
+    }
+}
+
+/**
+ * @brief Checks that a parallel replay draws the same pixels as a serial one
+ *
+ */
+static void test_replay_parallel(RenderPool *pool)
+{
+    uint64_t state = 1;
+    for (int test_case = 0; test_case < TEST_REPLAY_CASES; test_case++)
+    {
+        ReplayCase replay;
+        if (!replay_case_create(&replay, &state, test_case))
+        {
+            fail("replay_parallel", test_case, "allocation failed");
+            continue;
+        }
+        Pixmap *pixmap = pixmap_create(replay.width, replay.height);
+        CmdBins *bins = cmdlist_bins_create();
+        if (pixmap != NULL && bins != NULL)
+        {
+            // Temporary bins, then the same bins built once and reused
+            for (int pass = 0; pass < 3; pass++)
+            {
+                replay_case_target(&replay, pixmap);
+                cmdlist_replay_parallel(replay.list, pixmap, pool, pass == 0 ? NULL : bins);
+                replay_case_compare(&replay, pixmap, "replay_parallel", test_case, "parallel replay");
+            }
+        }
+        else
+            fail("replay_parallel", test_case, "allocation failed");
+        cmdlist_bins_destroy(bins);
+        pixmap_destroy(pixmap);
+        replay_case_destroy(&replay);
+    }
+}
+
+/**
+ * @brief Checks that serial and parallel replays into tiled and Morton pixmaps match the linear layout
+ *
+ */
+static void test_replay_layouts(RenderPool *pool)
+{
+    uint64_t state = 3;
+    for (int test_case = 0; test_case < TEST_REPLAY_CASES; test_case++)
+    {
+        ReplayCase replay;
+        if (!replay_case_create(&replay, &state, test_case))
+        {
+            fail("replay_layouts", test_case, "allocation failed");
+            continue;
+        }
+        CmdBins *bins = cmdlist_bins_create();
+        for (size_t layout = 1; layout < sizeof(layouts) / sizeof(layouts[0]); layout++)
+            for (int parallel = 0; parallel < 2; parallel++)
+            {
+                Pixmap *pixmap = pixmap_create_layout(replay.width, replay.height, layouts[layout]);
+                if (pixmap == NULL)
+                {
+                    fail("replay_layouts", test_case, "allocation failed");
+                    continue;
+                }
+                replay_case_target(&replay, pixmap);
+                if (parallel)
+                    cmdlist_replay_parallel(replay.list, pixmap, pool, bins);
+                else
+                    cmdlist_replay(replay.list, pixmap, bins);
+
+                char what[64];
+                snprintf(what, sizeof(what), "%s replay into %s", parallel ? "parallel" : "serial", layout_names[layout]);
+                replay_case_compare(&replay, pixmap, "replay_layouts", test_case, what);
+                pixmap_destroy(pixmap);
+            }
+        cmdlist_bins_destroy(bins);
+        replay_case_destroy(&replay);
+    }
+}
+
+/**
+ * @brief Shared state of `test_replay_shared`
+ *
+ */
+typedef struct SharedReplay
+{
+    const CmdList *list;
+    Pixmap **pixmaps;
+    CmdBins **bins;
+} SharedReplay;
+
+static void shared_replay_task(void *context, size_t index, int32_t worker)
+{
+    (void)worker;
+    const SharedReplay *shared = (const SharedReplay *)context;
+    cmdlist_replay(shared->list, shared->pixmaps[index], shared->bins[index]);
+}
+
+/**
+ * @brief Checks that one list replayed from many threads at once, and bins reused after the list changed,
+ * draw the same pixels as a serial replay
+ *
+ */
+static void test_replay_shared(RenderPool *pool)
+{
+    uint64_t state = 5;
+    for (int test_case = 0; test_case < TEST_SHARED_CASES; test_case++)
+    {
+        ReplayCase replay;
+        if (!replay_case_create(&replay, &state, test_case))
+        {
+            fail("replay_shared", test_case, "allocation failed");
+            continue;
+        }
+        Pixmap *pixmaps[TEST_SHARED_REPLAYS] = {};
+        CmdBins *bins[TEST_SHARED_REPLAYS] = {};
+        bool ready = true;
+        for (size_t i = 0; i < TEST_SHARED_REPLAYS; i++)
+        {
+            pixmaps[i] = pixmap_create(replay.width, replay.height);
+            bins[i] = cmdlist_bins_create();
+            ready = ready && pixmaps[i] != NULL && bins[i] != NULL;
+        }
+        if (ready)
+        {
+            for (size_t i = 0; i < TEST_SHARED_REPLAYS; i++)
+                replay_case_target(&replay, pixmaps[i]);
+            SharedReplay shared = {replay.list, pixmaps, bins};
+            render_pool_run(pool, TEST_SHARED_REPLAYS, shared_replay_task, &shared);
+            for (size_t i = 0; i < TEST_SHARED_REPLAYS; i++)
+                replay_case_compare(&replay, pixmaps[i], "replay_shared", test_case, "concurrent replay");
+
+            // The bins now hold the old commands and must be rebuilt
+            record_commands(replay.list, &state, replay.width, replay.height);
+            replay_case_target(&replay, replay.reference);
+            cmdlist_replay(replay.list, replay.reference, NULL);
+            replay_case_target(&replay, pixmaps[0]);
+            cmdlist_replay(replay.list, pixmaps[0], bins[0]);
+            replay_case_compare(&replay, pixmaps[0], "replay_shared", test_case, "replay with stale bins");
+        }
+        else
+            fail("replay_shared", test_case, "allocation failed");
+        for (size_t i = 0; i < TEST_SHARED_REPLAYS; i++)
+        {
+            pixmap_destroy(pixmaps[i]);
+            cmdlist_bins_destroy(bins[i]);
+        }
+        replay_case_destroy(&replay);
+    }
+}
+
+/**
+ * @brief Draws the anti-aliased fills of one case
+ *
+ */
+static void draw_aa(Pixmap *pixmap, const Point *points, size_t count, FillRule rule, AASamples samples,
+                    const int32_t circle[3], uint32_t color)
+{
+    fill_polygon_aa(pixmap, points, count, rule, samples, color);
+    fill_circle_aa(pixmap, circle[0], circle[1], circle[2], samples, color ^ 0xFFFF0000u);
+}
+
+/**
+ * @brief Compares clipped anti-aliased fills with unclipped ones in every layout
+ *
+ * Inside the clip rectangle the pixels must match, outside it the background must be untouched.
+ */
+static void test_aa_clip(void)
+{
+    static const AASamples samples[] = {AA_SAMPLES_4, AA_SAMPLES_8, AA_SAMPLES_16};
+    uint64_t state = 2;
+    for (int test_case = 0; test_case < TEST_AA_CASES; test_case++)
+    {
+        int32_t width = random_range(&state, 1, 300);
+        int32_t height = random_range(&state, 1, 200);
+        Point points[12];
+        size_t count = (size_t)random_range(&state, 3, 13);
+        for (size_t i = 0; i < count; i++)
+            points[i] = Point{random_range(&state, -50, width + 50), random_range(&state, -50, height + 50)};
+        int32_t circle[3] = {random_range(&state, -20, width + 20), random_range(&state, -20, height + 20),
+                             random_range(&state, 0, 80)};
+        FillRule rule = random_range(&state, 0, 2) == 0 ? FILL_EVEN_ODD : FILL_NON_ZERO;
+        AASamples sample_count = samples[test_case % 3];
+        BlendMode blend = (BlendMode)random_range(&state, 0, 4);
+        uint32_t color = random_color(&state);
+        int32_t cx = random_range(&state, 0, width), cy = random_range(&state, 0, height);
+        int32_t cw = random_range(&state, 0, width - cx + 1), ch = random_range(&state, 0, height - cy + 1);
+
+        Pixmap *reference = pixmap_create(width, height);
+        if (reference == NULL)
+        {
+            fail("aa_clip", test_case, "allocation failed");
+            continue;
+        }
+        pixmap_clear(reference, 0x336699CC);
+        pixmap_set_blend(reference, blend);
+        draw_aa(reference, points, count, rule, sample_count, circle, color);
+
+        for (size_t layout = 0; layout < sizeof(layouts) / sizeof(layouts[0]); layout++)
+        {
+            Pixmap *pixmap = pixmap_create_layout(width, height, layouts[layout]);
+            if (pixmap == NULL)
+            {
+                fail("aa_clip", test_case, "allocation failed");
+                continue;
+            }
+            pixmap_clear(pixmap, 0x336699CC);
+            uint32_t background = pixmap_get_pixel(pixmap, 0, 0);
+            pixmap_set_blend(pixmap, blend);
+            pixmap_set_clip(pixmap, cx, cy, cw, ch);
+            draw_aa(pixmap, points, count, rule, sample_count, circle, color);
+
+            size_t differ = 0;
+            for (int32_t y = 0; y < height; y++)
+                for (int32_t x = 0; x < width; x++)
+                {
+                    bool inside = x >= cx && x < cx + cw && y >= cy && y < cy + ch;
+                    uint32_t expected = inside ? pixmap_get_pixel(reference, x, y) : background;
+                    differ += pixmap_get_pixel(pixmap, x, y) != expected;
+                }
+            if (differ != 0)
+            {
+                char detail[128];
+                snprintf(detail, sizeof(detail), "clipped fill into %s differs in %zu pixels", layout_names[layout], differ);
+                fail("aa_clip", test_case, detail);
+            }
+            pixmap_destroy(pixmap);
+        }
+        pixmap_destroy(reference);
+    }
+}
+
+/**
+ * @brief Checks that front-to-back replays into every layout match the serial replay
+ *
+ */
+static void test_replay_front_to_back(void)
+{
+    uint64_t state = 4;
+    for (int test_case = 0; test_case < TEST_REPLAY_CASES; test_case++)
+    {
+        ReplayCase replay;
+        if (!replay_case_create(&replay, &state, test_case))
+        {
+            fail("replay_front_to_back", test_case, "allocation failed");
+            continue;
+        }
+        for (size_t layout = 0; layout < sizeof(layouts) / sizeof(layouts[0]); layout++)
+        {
+            Pixmap *pixmap = pixmap_create_layout(replay.width, replay.height, layouts[layout]);
+            if (pixmap == NULL)
+            {
+                fail("replay_front_to_back", test_case, "allocation failed");
+                continue;
+            }
+            replay_case_target(&replay, pixmap);
+            cmdlist_replay_front_to_back(replay.list, pixmap, NULL);
+
+            char what[64];
+            snprintf(what, sizeof(what), "front-to-back replay into %s", layout_names[layout]);
+            replay_case_compare(&replay, pixmap, "replay_front_to_back", test_case, what);
+            pixmap_destroy(pixmap);
+        }
+        replay_case_destroy(&replay);
+    }
+}
+
+/**
+ * @brief Writes one BDF glyph whose bitmap is fully set
+ *
+ */
+static void write_bdf_glyph(FILE *file, int32_t encoding, int32_t advance, int32_t width, int32_t height, int32_t x)
+{
+    fprintf(file, "STARTCHAR c%d\nENCODING %d\nDWIDTH %d 0\nBBX %d %d %d 0\nBITMAP\n", encoding, encoding, advance,
+            width, height, x);
+    for (int32_t row = 0; row < height; row++)
+    {
+        for (int32_t digit = 0; digit < (width + 7) / 8 * 2; digit++)
+            fputc('F', file);
+        fputc('\n', file);
+    }
+    fprintf(file, "ENDCHAR\n");
+}
+
+/**
+ * @brief Checks that BDF glyphs far larger than the line height are bounded before anything is allocated
+ *
+ */
+static void test_bdf_bounds(void)
+{
+    const char *path = "tests_bounds.bdf";
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fail("bdf_bounds", 0, "could not write the font");
+        return;
+    }
+    fprintf(file, "STARTFONT 2.1\nFONT_ASCENT 1\nFONT_DESCENT 0\nCHARS 2\n");
+    write_bdf_glyph(file, 'A', 1, 64, 64, 0);         // 64 times the line height
+    write_bdf_glyph(file, 'B', 7, 1, 1, 2000000000); // Offset far outside any pixmap
+    fprintf(file, "ENDFONT\n");
+    fclose(file);
+
+    Font *font = font_load_bdf(path);
+    remove(path);
+    Pixmap *pixmap = pixmap_create(256, 256);
+    if (font == NULL || pixmap == NULL)
+    {
+        fail("bdf_bounds", 0, "allocation failed");
+        font_destroy(font);
+        pixmap_destroy(pixmap);
+        return;
+    }
+
+    // 'B' is skipped and drawn as the missing glyph 'A'
+    if (text_width(font, 1, "B") != 1)
+        fail("bdf_bounds", 1, "a glyph with an out of range offset is kept");
+
+    // At 1024 pixels 'A' would need 64K x 64K bytes of coverage, more than the whole cache
+    pixmap_clear(pixmap, BLACK);
+    uint32_t background = pixmap_get_pixel(pixmap, 0, 0);
+    draw_text(pixmap, font, 0, 0, 1024, "A", WHITE);
+    if (pixmap_get_pixel(pixmap, 0, 0) != background)
+        fail("bdf_bounds", 2, "a glyph larger than the cache is drawn");
+    draw_text(pixmap, font, 0, 0, 2, "A", WHITE);
+    if (pixmap_get_pixel(pixmap, 0, 0) == background)
+        fail("bdf_bounds", 3, "a glyph that fits the cache is not drawn");
+
+    pixmap_destroy(pixmap);
+    font_destroy(font);
+}
+
+/**
+ * @brief Checks that every frame of a stream is written once and in order, also when all pixmaps are queued
+ *
+ * Frames are submitted as fast as possible, so the queue regularly fills up
+ * before the writer thread takes the first frame.
+ */
+static void test_stream_order(void)
+{
+    const char *path = "tests_stream.rgba";
+    const int32_t width = 5, height = 3;
+    const size_t frame_bytes = (size_t)width * (size_t)height * 4;
+    for (int32_t depth = 1; depth <= 4; depth++)
+    {
+        FrameStream *stream = frame_stream_open_file(path, width, height, STREAM_RGBA, 0, depth);
+        if (stream == NULL)
+        {
+            fail("stream_order", depth, "could not open the stream");
+            continue;
+        }
+        for (int32_t i = 0; i < TEST_STREAM_FRAMES; i++)
+        {
+            Pixmap *frame = frame_stream_begin(stream);
+            pixmap_clear(frame, (uint32_t)(i & 0xFF) << 24 | (uint32_t)(i >> 8) << 16 | 0x5AFF);
+            frame_stream_submit(stream, frame);
+        }
+        if (!frame_stream_close(stream))
+            fail("stream_order", depth, "writing failed");
+
+        FILE *file = fopen(path, "rb");
+        uint8_t *data = (uint8_t *)malloc(frame_bytes * TEST_STREAM_FRAMES + 1);
+        size_t size = file != NULL && data != NULL ? fread(data, 1, frame_bytes * TEST_STREAM_FRAMES + 1, file) : 0;
+        if (size != frame_bytes * TEST_STREAM_FRAMES)
+            fail("stream_order", depth, "the output does not hold every frame exactly once");
+        else
+            for (int32_t i = 0; i < TEST_STREAM_FRAMES; i++)
+            {
+                const uint8_t expected[4] = {(uint8_t)i, (uint8_t)(i >> 8), 0x5A, 0xFF};
+                bool match = true;
+                for (size_t byte = 0; byte < frame_bytes; byte++)
+                    match = match && data[(size_t)i * frame_bytes + byte] == expected[byte % 4];
+                if (!match)
+                {
+                    char detail[128];
+                    snprintf(detail, sizeof(detail), "frame %d holds the pixels of another frame", i);
+                    fail("stream_order", depth, detail);
+                    break;
+                }
+            }
+        free(data);
+        if (file != NULL)
+            fclose(file);
+        remove(path);
+    }
+}
+
+/**
+ * @brief Checks that replays and parallel fills count one call per primitive, however they are split
+ *
+ * Only meaningful in builds with RENDERER_STATS, skipped otherwise.
+ */
+static void test_stats_calls(RenderPool *pool)
+{
+    if (!stats_enabled())
+        return;
+
+    CmdList *list = cmdlist_create();
+    Pixmap *pixmap = pixmap_create(1024, 1024);
+    if (list == NULL || pixmap == NULL)
+    {
+        fail("stats_calls", 0, "allocation failed");
+        cmdlist_destroy(list);
+        pixmap_destroy(pixmap);
+        return;
+    }
+    cmdlist_draw_point(list, 5, 5, WHITE); // Overwritten by the clear and never replayed
+    cmdlist_clear(list, BLACK);
+    cmdlist_fill_rect(list, 10, 10, 1000, 1000, RED);
+    cmdlist_draw_line(list, 0, 0, 1023, 1023, GREEN);
+    cmdlist_fill_circle(list, 512, 512, 400, BLUE);
+    cmdlist_fill_circle(list, 100, 900, 50, WHITE);
+
+    static const uint64_t expected[STAT_PRIMITIVE_COUNT] = {1, 0, 1, 0, 2, 1, 0, 0, 0, 0};
+    for (int mode = 0; mode < 3; mode++)
+    {
+        stats_reset();
+        if (mode == 0)
+            cmdlist_replay(list, pixmap, NULL);
+        else if (mode == 1)
+            cmdlist_replay_parallel(list, pixmap, pool, NULL);
+        else
+            cmdlist_replay_front_to_back(list, pixmap, NULL);
+
+        RenderStats stats;
+        stats_snapshot(&stats);
+        for (size_t i = 0; i < STAT_PRIMITIVE_COUNT; i++)
+            if (stats.primitives[i].calls != expected[i])
+            {
+                char detail[128];
+                snprintf(detail, sizeof(detail), "replay mode %d counts %llu %s calls instead of %llu", mode,
+                         (unsigned long long)stats.primitives[i].calls, stats_primitive_name((StatPrimitive)i),
+                         (unsigned long long)expected[i]);
+                fail("stats_calls", mode, detail);
+            }
+        if (stats.events != 1)
+            fail("stats_calls", mode, "a replay records more than its own trace event");
+    }
+
+    pixmap_clear(pixmap, BLACK);
+    stats_reset();
+    flood_fill_parallel(pixmap, pool, 0, 0, RED);
+    RenderStats stats;
+    stats_snapshot(&stats);
+    if (stats.primitives[STAT_FILL].calls != 1 || stats.events != 1)
+        fail("stats_calls", 3, "a parallel fill counts its bands as calls");
+    if (stats.primitives[STAT_FILL].written != 1024u * 1024u)
+        fail("stats_calls", 3, "a parallel fill does not count the pixels of every band");
+
+    // The heatmap replaces every pixel of its target, which the dirty tracking must see
+    Pixmap *heatmap = pixmap_create(1024, 1024);
+    if (heatmap != NULL && stats_heatmap_attach(pixmap) && pixmap_track_dirty(heatmap, true))
+    {
+        pixmap_dirty_reset(heatmap);
+        Rect rect;
+        if (!stats_heatmap_render(heatmap) || pixmap_dirty_rects(heatmap, &rect, 1) != 1 || rect.x0 != 0 ||
+            rect.y0 != 0 || rect.x1 != 1024 || rect.y1 != 1024)
+            fail("stats_calls", 4, "the heatmap render does not mark its target as changed");
+    }
+    else
+        fail("stats_calls", 4, "allocation failed");
+    stats_heatmap_attach(NULL);
+    pixmap_destroy(heatmap);
+
+    pixmap_destroy(pixmap);
+    cmdlist_destroy(list);
+}
+
+int main(void)
+{
+    RenderPool *pool = render_pool_create(4);
+    if (pool == NULL)
+    {
+        fprintf(stderr, "could not create the thread pool\n");
+        return 1;
+    }
+
+    test_replay_parallel(pool);
+    test_replay_layouts(pool);
+    test_replay_shared(pool);
+    test_aa_clip();
+    test_replay_front_to_back();
+    test_bdf_bounds();
+    test_stream_order();
+    test_stats_calls(pool);
+
+    render_pool_destroy(pool);
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}